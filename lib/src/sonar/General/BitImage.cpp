@@ -0,0 +1,248 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "BitImage.h"
+
+#include <algorithm>
+
+#include "sonar/SimdTools/BitOperations.h"
+
+using namespace std;
+
+namespace sonar {
+
+/// Mask of valid bits of the last word of row
+static uint64_t _lastWordMask(int width)
+{
+    return ((width & 63) == 0) ? ~uint64_t(0) : ((uint64_t(1) << (width & 63)) - 1);
+}
+
+BitImage::BitImage():
+    m_size(0, 0),
+    m_widthStep(0)
+{
+}
+
+BitImage::BitImage(const Size2i & size)
+{
+    create(size);
+}
+
+bool BitImage::isNull() const
+{
+    return m_data.empty();
+}
+
+Size2i BitImage::size() const
+{
+    return m_size;
+}
+
+int BitImage::width() const
+{
+    return m_size.x;
+}
+
+int BitImage::height() const
+{
+    return m_size.y;
+}
+
+int BitImage::widthStep() const
+{
+    return m_widthStep;
+}
+
+void BitImage::create(const Size2i & size)
+{
+    assert((size.x >= 0) && (size.y >= 0));
+    m_size = size;
+    m_widthStep = (size.x + 63) >> 6;
+    m_data.assign(static_cast<size_t>(m_widthStep) * static_cast<size_t>(size.y), 0);
+}
+
+void BitImage::fill(bool value)
+{
+    std::fill(m_data.begin(), m_data.end(), value ? ~uint64_t(0) : uint64_t(0));
+    if (!value || (m_widthStep == 0))
+        return;
+    uint64_t mask = _lastWordMask(m_size.x);
+    for (int y = 0; y < m_size.y; ++y)
+        row(y)[m_widthStep - 1] &= mask;
+}
+
+int64_t BitImage::countBits() const
+{
+    return simd::countBits_u64(m_data.data(), static_cast<int>(m_data.size()));
+}
+
+int BitImage::countBits(const Point2i & begin, const Size2i & size) const
+{
+    assert((begin.x >= 0) && (begin.y >= 0) && (size.x >= 0) && (size.y >= 0));
+    assert(((begin.x + size.x) <= m_size.x) && ((begin.y + size.y) <= m_size.y));
+    if ((size.x == 0) || (size.y == 0))
+        return 0;
+    const int beginWord = begin.x >> 6;
+    const int lastWord = (begin.x + size.x - 1) >> 6;
+    const uint64_t beginMask = ~uint64_t(0) << (begin.x & 63);
+    const uint64_t lastMask = ~uint64_t(0) >> (63 - ((begin.x + size.x - 1) & 63));
+    int count = 0;
+    for (int y = begin.y; y < begin.y + size.y; ++y)
+    {
+        const uint64_t * str = row(y);
+        if (beginWord == lastWord)
+        {
+            count += simd::countBits(str[beginWord] & beginMask & lastMask);
+            continue;
+        }
+        count += simd::countBits(str[beginWord] & beginMask) +
+                static_cast<int>(simd::countBits_u64(&str[beginWord + 1], lastWord - beginWord - 1)) +
+                simd::countBits(str[lastWord] & lastMask);
+    }
+    return count;
+}
+
+namespace image_utils {
+
+void packBits(BitImage & out, const ImageRef<uchar> & in, uchar threshold)
+{
+    if (out.size() != in.size())
+        out.create(in.size());
+    for (int y = 0; y < in.height(); ++y)
+        simd::packBits_u(out.row(y), in.pointer(0, y), in.width(), threshold);
+}
+
+void unpackBits(const Image<uchar> & out, const BitImage & in, uchar zero, uchar one)
+{
+    assert(out.size() == in.size());
+    for (int y = 0; y < in.height(); ++y)
+        simd::unpackBits_u(out.pointer(0, y), in.row(y), in.width(), zero, one);
+}
+
+static void _bitwise(BitImage & out, const BitImage & a, const BitImage & b, simd::BitOperation operation)
+{
+    assert(a.size() == b.size());
+    if (out.size() != a.size())
+        out.create(a.size());
+    if (a.height() > 0)
+        simd::bitwise_u64(out.row(0), a.row(0), b.row(0), a.widthStep() * a.height(), operation);
+}
+
+void bitAnd(BitImage & out, const BitImage & a, const BitImage & b)
+{
+    _bitwise(out, a, b, simd::BitOperation::And);
+}
+
+void bitOr(BitImage & out, const BitImage & a, const BitImage & b)
+{
+    _bitwise(out, a, b, simd::BitOperation::Or);
+}
+
+void bitXor(BitImage & out, const BitImage & a, const BitImage & b)
+{
+    _bitwise(out, a, b, simd::BitOperation::Xor);
+}
+
+void bitAndNot(BitImage & out, const BitImage & a, const BitImage & b)
+{
+    _bitwise(out, a, b, simd::BitOperation::AndNot);
+}
+
+void bitNot(BitImage & out, const BitImage & in)
+{
+    BitImage ones(in.size());
+    ones.fill(true);
+    // Bits after the end of rows stay zero
+    _bitwise(out, ones, in, simd::BitOperation::AndNot);
+}
+
+/// dst(x) |= src(x + shift) for shift >= 0, bits outside of src are zero.
+/// dst can be the same as src, words are processed in ascending order.
+static void _shiftOr(uint64_t * dst, int numberDstWords, const uint64_t * src, int numberSrcWords, int shift)
+{
+    assert(shift >= 0);
+    const int wordShift = shift >> 6, bitShift = shift & 63;
+    const int endWord = std::min(numberDstWords, numberSrcWords - wordShift);
+    for (int i = 0; i < endWord; ++i)
+    {
+        const int j = i + wordShift;
+        uint64_t word = src[j] >> bitShift;
+        if ((bitShift != 0) && ((j + 1) < numberSrcWords))
+            word |= src[j + 1] << (64 - bitShift);
+        dst[i] |= word;
+    }
+}
+
+void dilate(BitImage & out, const BitImage & in, int halfSize)
+{
+    assert(halfSize >= 0);
+    const int numberWords = in.widthStep();
+    const int height = in.height();
+    const int windowSize = halfSize * 2 + 1;
+    const uint64_t lastMask = _lastWordMask(in.width());
+    if ((numberWords == 0) || (height == 0))
+    {
+        out.create(in.size());
+        return;
+    }
+    // Rows of buffer are rows of image dilated by horizontal, halfSize rows of zeros are added above image,
+    // so row k of buffer is row (k - halfSize) of image
+    const int numberRows = height + halfSize;
+    vector<uint64_t> buffer(static_cast<size_t>(numberRows) * static_cast<size_t>(numberWords), 0);
+    // The same for columns: row is copied after paddingWords words of zeros
+    const int paddingWords = (halfSize + 63) >> 6;
+    const int numberAccumulatorWords = numberWords + paddingWords;
+    vector<uint64_t> accumulator(static_cast<size_t>(numberAccumulatorWords));
+    for (int y = 0; y < height; ++y)
+    {
+        // accumulator(x) is OR of accumulator(x ... x + covered - 1)
+        std::fill(accumulator.begin(), accumulator.begin() + paddingWords, 0);
+        std::copy(in.row(y), in.row(y) + numberWords, accumulator.begin() + paddingWords);
+        int covered = 1;
+        for (; (covered * 2) <= windowSize; covered *= 2)
+            _shiftOr(accumulator.data(), numberAccumulatorWords, accumulator.data(), numberAccumulatorWords, covered);
+        if (covered < windowSize)
+            _shiftOr(accumulator.data(), numberAccumulatorWords, accumulator.data(), numberAccumulatorWords,
+                     windowSize - covered);
+        uint64_t * bufferRow = &buffer[static_cast<size_t>((y + halfSize) * numberWords)];
+        _shiftOr(bufferRow, numberWords, accumulator.data(), numberAccumulatorWords, paddingWords * 64 - halfSize);
+        bufferRow[numberWords - 1] &= lastMask;
+    }
+    // The same doubling by vertical: row k of buffer becomes OR of rows k ... k + covered - 1
+    auto orRows = [&] (int shift) {
+        for (int k = 0; (k + shift) < numberRows; ++k)
+        {
+            uint64_t * bufferRow = &buffer[static_cast<size_t>(k * numberWords)];
+            simd::bitwise_u64(bufferRow, bufferRow, &bufferRow[shift * numberWords], numberWords,
+                              simd::BitOperation::Or);
+        }
+    };
+    int covered = 1;
+    for (; (covered * 2) <= windowSize; covered *= 2)
+        orRows(covered);
+    if (covered < windowSize)
+        orRows(windowSize - covered);
+    if (out.size() != in.size())
+        out.create(in.size());
+    for (int y = 0; y < height; ++y)
+    {
+        const uint64_t * bufferRow = &buffer[static_cast<size_t>(y * numberWords)];
+        std::copy(bufferRow, bufferRow + numberWords, out.row(y));
+    }
+}
+
+void erode(BitImage & out, const BitImage & in, int halfSize)
+{
+    // Erosion is dilation of inverted image, pixels outside image are zero for dilation
+    BitImage inverted;
+    bitNot(inverted, in);
+    dilate(out, inverted, halfSize);
+    bitNot(out, out);
+}
+
+} // namespace image_utils
+
+} // namespace sonar
@@ -0,0 +1,131 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_BITIMAGE_H
+#define SONAR_BITIMAGE_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "sonar/General/Point2.h"
+#include "sonar/General/Image.h"
+
+namespace sonar {
+
+/// Binary image with 1 bit per pixel, it is 8 times smaller than Image<uchar> with values 0 and 255.
+/// Rows are stored in 64 bits words: pixel x is bit (x & 63) of word (x >> 6) of row.
+/// Bits after the end of row are always zero, so words can be processed without masks.
+class BitImage
+{
+public:
+    BitImage();
+    explicit BitImage(const Size2i & size);
+
+    bool isNull() const;
+    Size2i size() const;
+    int width() const;
+    int height() const;
+    /// Number of words in row
+    int widthStep() const;
+
+    void create(const Size2i & size);
+    void fill(bool value);
+
+    inline bool get(int x, int y) const;
+    inline bool get(const Point2i & point) const;
+    inline void set(int x, int y, bool value);
+    inline void set(const Point2i & point, bool value);
+
+    inline const std::uint64_t * row(int y) const;
+    inline std::uint64_t * row(int y);
+
+    /// Number of set pixels
+    std::int64_t countBits() const;
+    /// Number of set pixels inside rectangle, rectangle must be inside image
+    int countBits(const Point2i & begin, const Size2i & size) const;
+
+    inline bool pointInImage(const Point2i & point) const;
+    inline bool pointInImage(int x, int y) const;
+
+private:
+    std::vector<std::uint64_t> m_data;
+    Size2i m_size;
+    int m_widthStep;
+};
+
+namespace image_utils {
+
+/// Packing of 8 bits image to binary image: pixel is set if in > threshold
+void packBits(BitImage & out, const ImageRef<uchar> & in, uchar threshold = 127);
+
+/// Unpacking of binary image to 8 bits image with values zero and one
+void unpackBits(const Image<uchar> & out, const BitImage & in, uchar zero = 0, uchar one = 255);
+
+// Logical operations by pixels, images must have the same size, out can be one of inputs
+void bitAnd(BitImage & out, const BitImage & a, const BitImage & b);
+void bitOr(BitImage & out, const BitImage & a, const BitImage & b);
+void bitXor(BitImage & out, const BitImage & a, const BitImage & b);
+/// out = a & ~b
+void bitAndNot(BitImage & out, const BitImage & a, const BitImage & b);
+void bitNot(BitImage & out, const BitImage & in);
+
+/// Morphology with square window (2 * halfSize + 1) x (2 * halfSize + 1), pixels outside image don't
+/// change result. Windows are built by doubling of shifts, so cost per word is O(log(halfSize)).
+void erode(BitImage & out, const BitImage & in, int halfSize);
+void dilate(BitImage & out, const BitImage & in, int halfSize);
+
+} // namespace image_utils
+
+inline bool BitImage::get(int x, int y) const
+{
+    assert(pointInImage(x, y));
+    return ((m_data[static_cast<std::size_t>(y * m_widthStep + (x >> 6))] >> (x & 63)) & 1) != 0;
+}
+
+inline bool BitImage::get(const Point2i & point) const
+{
+    return get(point.x, point.y);
+}
+
+inline void BitImage::set(int x, int y, bool value)
+{
+    assert(pointInImage(x, y));
+    std::uint64_t & word = m_data[static_cast<std::size_t>(y * m_widthStep + (x >> 6))];
+    const std::uint64_t bit = std::uint64_t(1) << (x & 63);
+    word = value ? (word | bit) : (word & ~bit);
+}
+
+inline void BitImage::set(const Point2i & point, bool value)
+{
+    set(point.x, point.y, value);
+}
+
+inline const std::uint64_t * BitImage::row(int y) const
+{
+    assert((y >= 0) && (y < m_size.y));
+    return &m_data[static_cast<std::size_t>(y * m_widthStep)];
+}
+
+inline std::uint64_t * BitImage::row(int y)
+{
+    assert((y >= 0) && (y < m_size.y));
+    return &m_data[static_cast<std::size_t>(y * m_widthStep)];
+}
+
+inline bool BitImage::pointInImage(const Point2i & point) const
+{
+    return pointInImage(point.x, point.y);
+}
+
+inline bool BitImage::pointInImage(int x, int y) const
+{
+    return ((x >= 0) && (y >= 0) && (x < m_size.x) && (y < m_size.y));
+}
+
+} // namespace sonar
+
+#endif // SONAR_BITIMAGE_H
@@ -0,0 +1,60 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_FLOAT16_H
+#define SONAR_FLOAT16_H
+
+#include <cstdint>
+
+#include "sonar/SimdTools/HalfConversion.h"
+
+namespace sonar {
+
+/// Half precision float (IEEE 754 binary16) for storage of images: half of memory and bandwidth of float.
+/// Arithmetic is done in floats, value is converted implicitly in both directions
+/// (with rounding to nearest even), so generic templates of images work with it as with float.
+/// Arrays of values are converted faster by simd::convertToHalf_f and simd::convertFromHalf_f.
+class float16
+{
+public:
+    float16() = default;
+    inline float16(float value);
+
+    inline operator float() const;
+
+    inline std::uint16_t bits() const;
+    inline static float16 fromBits(std::uint16_t bits);
+
+private:
+    std::uint16_t m_bits;
+};
+
+static_assert(sizeof(float16) == sizeof(std::uint16_t), "float16 must be stored as 16 bits");
+
+float16::float16(float value):
+    m_bits(simd::floatToHalf(value))
+{}
+
+float16::operator float() const
+{
+    return simd::halfToFloat(m_bits);
+}
+
+std::uint16_t float16::bits() const
+{
+    return m_bits;
+}
+
+float16 float16::fromBits(std::uint16_t bits)
+{
+    float16 value;
+    value.m_bits = bits;
+    return value;
+}
+
+} // namespace sonar
+
+#endif // SONAR_FLOAT16_H
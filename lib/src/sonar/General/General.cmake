@@ -2,15 +2,23 @@ add_definitions(-DMODULE_GENERAL)
 
 set(SONAR_SOURCES_FILES
     ${SONAR_SOURCES_FILES}
-    ${CMAKE_CURRENT_LIST_DIR}/Logger.cpp)
+    ${CMAKE_CURRENT_LIST_DIR}/BitImage.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/Logger.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/MappedImageFile.cpp)
 
 set(SONAR_HEADER_FILES
     ${SONAR_HEADER_FILES}
     ${CMAKE_CURRENT_LIST_DIR}/macros.h
     ${CMAKE_CURRENT_LIST_DIR}/Logger.h
+    ${CMAKE_CURRENT_LIST_DIR}/BitImage.h
+    ${CMAKE_CURRENT_LIST_DIR}/Float16.h
     ${CMAKE_CURRENT_LIST_DIR}/Image.h
     ${CMAKE_CURRENT_LIST_DIR}/ImagePyramid.h
+    ${CMAKE_CURRENT_LIST_DIR}/ImageBufferPool.h
     ${CMAKE_CURRENT_LIST_DIR}/ImageUtils.h
+    ${CMAKE_CURRENT_LIST_DIR}/MappedImageFile.h
+    ${CMAKE_CURRENT_LIST_DIR}/PlanarImage.h
+    ${CMAKE_CURRENT_LIST_DIR}/TiledImage.h
     ${CMAKE_CURRENT_LIST_DIR}/Point2.h
     ${CMAKE_CURRENT_LIST_DIR}/WLS.h
     ${CMAKE_CURRENT_LIST_DIR}/cast.h
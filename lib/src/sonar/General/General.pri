@@ -7,11 +7,17 @@ DEFINES += _USE_MATH_DEFINES
 
 DEFINES += MODULE_GENERAL
 HEADERS += \
+    $$PWD/BitImage.h \
+    $$PWD/Float16.h \
     $$PWD/Image.h \
     $$PWD/ImagePyramid.h \
+    $$PWD/ImageBufferPool.h \
     $$PWD/Logger.h \
     $$PWD/Point2.h \
     $$PWD/ImageUtils.h \
+    $$PWD/MappedImageFile.h \
+    $$PWD/PlanarImage.h \
+    $$PWD/TiledImage.h \
     $$PWD/WLS.h \
     $$PWD/cast.h \
     $$PWD/Paint.h \
@@ -19,4 +25,6 @@ HEADERS += \
     $$PWD/macros.h
 
 SOURCES += \
-    $$PWD/Logger.cpp
+    $$PWD/BitImage.cpp \
+    $$PWD/Logger.cpp \
+    $$PWD/MappedImageFile.cpp
@@ -15,9 +15,11 @@
 #include <functional>
 #include <cmath>
 #include <algorithm>
+#include <type_traits>
 
 #include "sonar/General/Point2.h"
 #include "sonar/General/cast.h"
+#include "sonar/ThreadsTools/WorkerPool.h"
 
 #if defined(QT_CORE_LIB)
 #include <qglobal.h>
@@ -100,6 +102,9 @@ class ConstImage;
 template <typename Type>
 class Image;
 
+template <typename Type>
+class ImageView;
+
 /// Базовый класс для Image и ConstImage, созданный чтобы можно было передавать по ссылке оба объекта
 /// Оба класса наследуются от них
 template <typename Type>
@@ -126,18 +131,32 @@ public:
     inline int widthStep() const;
     inline bool autoDeleting() const;
     inline int numberReferences() const;
+    inline ImageView<Type> view() const;
 
     inline Image<Type> copy() const;
 
-    void for_each(const std::function<void(const Point2i & pos, const Type & val)> & func) const;
+    // Function - callable object with signature void(const Point2i & pos, const Type & val)
+    template <typename Function>
+    void for_each(Function && func) const;
+
+    // ConvertFunction - callable object with signature ConvertType(const Point2i & pos, const Type & a)
+    template <typename ConvertType, typename ConvertFunction>
+    void convertTo(const Image<ConvertType> & out, ConvertFunction && convertFunction) const;
+
+    template <typename ConvertType, typename ConvertFunction>
+    Image<ConvertType> convert(ConvertFunction && convertFunction) const;
+
+    // Parallel versions split rows of image between the calling thread and workers of pool,
+    // so function must be safe for calling from several threads at once.
+    template <typename Function>
+    void parallel_for_each(WorkerPool & pool, Function && func) const;
 
-    template <typename ConvertType>
-    void convertTo(const Image<ConvertType> & out,
-                   const std::function<ConvertType(const Point2i & pos, const Type & a)> & convertFunction) const;
+    template <typename ConvertType, typename ConvertFunction>
+    void parallel_convertTo(WorkerPool & pool, const Image<ConvertType> & out,
+                            ConvertFunction && convertFunction) const;
 
-    template<typename ConvertType>
-    Image<ConvertType> convert(const std::function<ConvertType(const Point2i & pos,
-                                                               const Type & a)> & convertFunction) const;
+    template <typename ConvertType, typename ConvertFunction>
+    Image<ConvertType> parallel_convert(WorkerPool & pool, ConvertFunction && convertFunction) const;
 
     inline bool pointInImageWithBorder(const Point2i & point, int border) const;
     inline bool pointInImageWithBorder(int x, int y, int border) const;
@@ -153,6 +172,8 @@ private:
     Type * m_sourceData;
     Type * m_data;
     volatile std::atomic_int * m_count_references;
+    // Custom releasing of data instead of delete [] (mapped files, memory of other libraries and etc.)
+    std::function<void()> * m_deleter;
     Size2i m_size;
     int m_widthStep;
 
@@ -183,6 +204,8 @@ public:
     ConstImage(int width, int height, const Type * data, bool autoDeleting = true);
     ConstImage(const Size2i & size, const Type * data, int widthStep, bool autoDeleting = true);
     ConstImage(int width, int height, const Type * data, int widthStep, bool autoDeleting = true);
+    /// Data is shared by reference counter, and deleter is called when last reference is removed
+    ConstImage(const Size2i & size, const Type * data, int widthStep, const std::function<void()> & deleter);
     ~ConstImage();
     ConstImage & operator = (const ConstImage<Type> & image);
     ConstImage & operator = (ConstImage<Type> && image);
@@ -207,9 +230,16 @@ public:
     Image(int width, int height, Type * data, bool autoDeleting = true);
     Image(const Size2i & size, Type * data, int widthStep, bool autoDeleting = true);
     Image(int width, int height, Type * data, int widthStep, bool autoDeleting = true);
+    /// Data is shared by reference counter, and deleter is called when last reference is removed
+    Image(const Size2i & size, Type * data, int widthStep, const std::function<void()> & deleter);
     ~Image();
 
-    void for_each(const std::function<void(const Point2i & pos, Type & val)> & func) const;
+    // Function - callable object with signature void(const Point2i & pos, Type & val)
+    template <typename Function>
+    void for_each(Function && func) const;
+
+    template <typename Function>
+    void parallel_for_each(WorkerPool & pool, Function && func) const;
 
     operator ConstImage<Type>();
     Image<Type> & operator = (const Image<Type> & image);
@@ -227,6 +257,51 @@ public:
     void release();
 };
 
+/// Non-owning view of image data: pointer, size and width step only.
+/// View is trivially copyable and doesn't touch the reference counter, so it's cheap to pass into hot loops.
+/// The owner of data (Image, ConstImage or external buffer) must outlive the view.
+template <typename Type>
+class ImageView
+{
+public:
+    typedef Type TypeValue;
+
+    inline ImageView();
+    inline ImageView(const ImageRef<Type> & image);
+    inline ImageView(const ImageView<Type> & view, const Point2i & offset, const Size2i & size);
+    inline ImageView(const Size2i & size, const Type * data, int widthStep);
+    inline ImageView(int width, int height, const Type * data, int widthStep);
+
+    inline bool isNull() const;
+    inline bool isContinuous() const;
+    inline const Type * data() const;
+    inline const Type & operator () (int x, int y) const;
+    inline const Type & operator () (const Point2i & point) const;
+    inline const Type * pointer(int x, int y) const;
+    inline const Type * pointer(const Point2i & point) const;
+    inline int area() const;
+    inline Size2i size() const;
+    inline int width() const;
+    inline int height() const;
+    inline int widthStep() const;
+
+    inline bool pointInImageWithBorder(const Point2i & point, int border) const;
+    inline bool pointInImageWithBorder(int x, int y, int border) const;
+    inline bool pointInImage(const Point2i & point) const;
+    inline bool pointInImage(int x, int y) const;
+
+private:
+    const Type * m_data;
+    Size2i m_size;
+    int m_widthStep;
+};
+
+using ImageView_u = ImageView<uchar>;
+using ImageView_f = ImageView<float>;
+using ImageView_h = ImageView<float16>;
+
+static_assert(std::is_trivially_copyable<ImageView<uchar>>::value, "ImageView must be trivially copyable");
+
 } // namespace sonar
 
 #include "impl/Image_impl.hpp"
@@ -0,0 +1,69 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_IMAGEBUFFERPOOL_H
+#define SONAR_IMAGEBUFFERPOOL_H
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+#include "sonar/General/Point2.h"
+#include "sonar/General/Image.h"
+
+namespace sonar {
+
+/// Pool of image buffers with different sizes.
+/// Buffer is free when the pool holds the only reference to it, so buffers are returned to the pool
+/// automatically after destroying of all images which use them.
+/// Number of buffers is bounded: when it's exceeded, free buffers are removed in order of their last use,
+/// so buffers of sizes, which are not requested anymore (after change of resolution), don't stay forever.
+template <typename Type>
+class ImageBufferPool
+{
+public:
+    /// maxNumberBuffersPerSize - 2 or 3 is enough for double or triple buffering of frames,
+    /// maxNumberBuffers - limit of all buffers, it should cover all levels of pyramids, which use the pool.
+    explicit ImageBufferPool(int maxNumberBuffersPerSize = 3, int maxNumberBuffers = 24);
+
+    int maxNumberBuffersPerSize() const;
+    void setMaxNumberBuffersPerSize(int maxNumberBuffersPerSize);
+
+    int maxNumberBuffers() const;
+    void setMaxNumberBuffers(int maxNumberBuffers);
+
+    /// Free buffer with required size, new buffer is allocated if there are no free buffers.
+    /// Content of buffer is undefined.
+    Image<Type> acquire(const Size2i & size);
+
+    int numberBuffers() const;
+
+    /// Removes buffers from the pool, buffers which are used now aren't destroyed until they are released
+    void clear();
+
+private:
+    struct Entry
+    {
+        Image<Type> buffer;
+        std::uint64_t lastUse; // number of acquiring, when the buffer was taken last time
+    };
+
+    mutable std::mutex m_mutex;
+    int m_maxNumberBuffersPerSize;
+    int m_maxNumberBuffers;
+    std::uint64_t m_numberAcquires;
+    std::vector<Entry> m_entries;
+
+    /// Removes the least recently used free buffers while the limit is exceeded, buffers in use are kept
+    void _evict();
+};
+
+using ImageBufferPool_u = ImageBufferPool<uchar>;
+
+} // namespace sonar
+
+#include "impl/ImageBufferPool_impl.hpp"
+#endif // SONAR_IMAGEBUFFERPOOL_H
@@ -9,9 +9,14 @@
 
 #include <cassert>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <memory>
 
 #include "sonar/General/Image.h"
 #include "sonar/General/ImageUtils.h"
+#include "sonar/General/ImageBufferPool.h"
+#include "sonar/ThreadsTools/WorkerPool.h"
 
 namespace sonar {
 
@@ -19,36 +24,87 @@ namespace sonar {
 // SamplerType - структура, в которой храниться логика сэмплирования.
 // по умолчанию уровни будут усредняться с типом сумирования самого типа изображения,
 // но при работе с uchar, нпаример, лучше выбрать int (чтобы избежать переполнения)
+// Levels are built lazily on first request (get or view), every level is built at most once.
+// Requesting of levels from several threads is safe, rebuild and other non-const methods aren't.
 template < typename Type,
            typename SamplerType = image_utils::Sampler_avg<typename BaseElement<Type>::Type>>
 class ImagePyramid
 {
 public:
     ImagePyramid();
-    ImagePyramid(const ImageRef<Type> & image, int numberLevels);
+    ImagePyramid(const ImageRef<Type> & image, int numberLevels,
+                 const std::shared_ptr<ImageBufferPool<Type>> & bufferPool = nullptr);
+    ImagePyramid(const ImagePyramid & pyramid);
+    ImagePyramid(ImagePyramid && pyramid);
     ImagePyramid(const ImagePyramid & pyramid, int numberLevels);
 
+    ImagePyramid & operator = (const ImagePyramid & pyramid);
+    ImagePyramid & operator = (ImagePyramid && pyramid);
+
     int numberLevels() const;
     bool isNull() const;
 
     ConstImage<Type> get(int level = 0) const;
 
+    /// Non-owning view of level without touching of reference counters, the pyramid must outlive it.
+    ImageView<Type> view(int level = 0) const;
+
+    /// Builds all levels at once. Rows of levels are split into horizontal bands and every band is built
+    /// through all levels by own thread, so threads don't wait each other between levels.
+    void buildLevels(WorkerPool & workerPool) const;
+
     void clear();
 
+    /// Buffers of levels are taken from the pool on every rebuild, the pool gives back own buffer of level
+    /// if nobody else holds it. Without pool own buffers are reused if they are free and have the same size.
+    /// Copies of pyramid use the same pool.
+    std::shared_ptr<ImageBufferPool<Type>> bufferPool() const;
+    void setBufferPool(const std::shared_ptr<ImageBufferPool<Type>> & bufferPool);
+
+    /// Levels are built from image lazily, on the first request. Image with own data (Image, ConstImage
+    /// with reference counter) is shared, so it must not be changed while the pyramid uses it.
+    /// Data of image without own data (autoDeleting() is false, for example a frame of external buffer)
+    /// is copied, because the buffer can be reused before levels are built.
     void rebuild(const ImageRef<Type> & image);
     void rebuild(const ImageRef<Type> & image, int numberLevels);
     void rebuild(int numberLevels);
 
+    /// Pyramid of grayscale image for color image (Rgb_u or Rgba_u), levels 0, 1 and 2 are computed
+    /// in one pass over color data. Weights of luma and order of channels are the same as for
+    /// image_utils::convertToGrayscale (simd::ChannelOrder::Bgr for frames of OpenCV).
+    /// It's supported only for ImagePyramid_u.
+    template <typename ColorType>
+    void rebuildFromColor(const ImageRef<ColorType> & image, int numberLevels,
+                          simd::LumaStandard standard, simd::ChannelOrder order = simd::ChannelOrder::Rgb);
+
     ImagePyramid<Type, SamplerType> copy() const;
     ImagePyramid<Type, SamplerType> copy(int numberLevels) const;
 
 private:
     ConstImage<Type> m_level0;
-    std::vector<Image<Type>> m_levels;
+    // Buffers of levels are kept between rebuilds and reused if nobody else holds them
+    mutable std::vector<Image<Type>> m_levels;
+    mutable std::atomic_int m_numberBuiltLevels;
+    mutable std::mutex m_mutex;
+    std::shared_ptr<ImageBufferPool<Type>> m_bufferPool;
+
+    /// Shares image or copies it if data isn't owned by image
+    void _setLevel0(const ImageRef<Type> & image);
+    const ImageRef<Type> & _previousLevel(int index) const;
+    /// Buffer with required size for level with index (level - 1), content is undefined
+    Image<Type> & _prepareLevel(int index) const;
+    /// Builds levels from 1 to level inclusive
+    void _buildLevels(int level) const;
 };
 
 using ImagePyramid_u = ImagePyramid<uchar, image_utils::Sampler_avg<int>>;
 using ImagePyramid_f = ImagePyramid<float, image_utils::Sampler_avg<float>>;
+using ImagePyramidGauss_u = ImagePyramid<uchar, image_utils::Sampler_gauss5<int>>;
+using ImagePyramidGauss_f = ImagePyramid<float, image_utils::Sampler_gauss5<float>>;
+// Levels are stored in half precision or 16 bits, values are summed in float or int
+using ImagePyramid_h = ImagePyramid<float16, image_utils::Sampler_avg<float>>;
+using ImagePyramidGauss_h = ImagePyramid<float16, image_utils::Sampler_gauss5<float>>;
+using ImagePyramid_us = ImagePyramid<ushort, image_utils::Sampler_avg<int>>;
 
 } // namespace sonar
 
@@ -11,6 +11,9 @@
 #include <limits>
 #include <climits>
 #include <cassert>
+#include <type_traits>
+#include <vector>
+#include <algorithm>
 
 #include <Eigen/Eigen>
 
@@ -20,6 +23,19 @@
 #include "sonar/General/MathUtils.h"
 #include "sonar/General/Paint.h"
 
+#include "sonar/ThreadsTools/WorkerPool.h"
+
+#include "sonar/SimdTools/HalfSample.h"
+#include "sonar/SimdTools/GaussianBlur.h"
+#include "sonar/SimdTools/Gradients.h"
+#include "sonar/SimdTools/Grayscale.h"
+#include "sonar/SimdTools/HalfConversion.h"
+#include "sonar/SimdTools/Integral.h"
+#include "sonar/SimdTools/Interpolation.h"
+#include "sonar/SimdTools/Resize.h"
+#include "sonar/SimdTools/Threshold.h"
+#include "sonar/SimdTools/Warp.h"
+
 #if QT_MULTIMEDIA_LIB
 #include <QImage>
 #endif
@@ -29,8 +45,6 @@
 #include <opencv2/highgui.hpp>
 #endif
 
-///TODO moveCvMat and moveImage
-
 namespace sonar {
 
 namespace image_utils {
@@ -43,6 +57,15 @@ static QImage convertToQImage(const ImageRef<uchar> & image);
 #endif
 
 #if defined(OPENCV_LIB)
+// Zero-copy conversions: image and cv::Mat share pixels and hold reference counters of each other,
+// so data is released after destroying both of them.
+template <typename Type>
+static Image<Type> shareCvMat(const cv::Mat & image);
+
+template <typename Type>
+static cv::Mat shareToCvMat(const ImageRef<Type> & image);
+
+// Without copying the result shares data of cv::Mat (see shareCvMat)
 static Image<uchar> convertCvMat_u(cv::Mat image, bool copy = true);
 static Image<short> convertCvMat_short(cv::Mat image, bool copy = true);
 static Image<Rgb_u> convertCvMat_rgb_u(cv::Mat image, bool copy = true);
@@ -61,10 +84,30 @@ static cv::Mat convertToCvMat(const ImageRef<Rgb_f> & image);
 static cv::Mat convertToCvMat(const ImageRef<float> & image);
 #endif
 
+/// Resize by bilinear interpolation, 8 bits images are resized by resizeImage(out, in)
 template <typename Type>
 static Image<Type> resizeImage(const ImageRef<Type> & image, const Point2i & newSize);
 
-// conversion rgb image to grayscale image
+/// Resize of 8 bits image to size of out by SIMD: area averaging by dimensions which decrease and
+/// bilinear interpolation between centers of pixels by other dimensions.
+/// Tables of coefficients are cached for pairs of sizes, so they are computed once for stream of frames.
+static void resizeImage(const Image<uchar> & out, const ImageRef<uchar> & in);
+
+static void resizeImage(const Image<uchar> & out, const ImageRef<uchar> & in, WorkerPool & workerPool);
+
+/// Conversions to half precision and back by SIMD kernels (F16C, SSE2 or NEON),
+/// half precision images take half of memory of float images (levels of pyramids, caches of patches)
+static void convertToHalf(const Image<float16> & out, const ImageRef<float> & in);
+
+static void convertToHalf(const Image<float16> & out, const ImageRef<uchar> & in);
+
+static Image<float16> convertToHalf(const ImageRef<float> & image);
+
+static void convertToFloat(const Image<float> & out, const ImageRef<float16> & in);
+
+static Image<float> convertToFloat(const ImageRef<float16> & image);
+
+// conversion rgb image to grayscale image (luma of BT.601, 8 bits images are converted by SIMD)
 template <typename Type>
 static Image<Type> convertToGrayscale(const ImageRef<Rgb<Type>> & image);
 
@@ -77,14 +120,42 @@ static Image<Type> convertToGrayscale(const ImageRef<Rgba<Type>> & image);
 template <typename Type>
 static void convertToGrayscale(Image<Type> & out, const ImageRef<Rgba<Type>> & in);
 
+/// Luma of 8 bits color image with choice of weights and order of channels in memory
+/// (for example, simd::ChannelOrder::Bgr for frames of OpenCV). Weights are in fixed point, without divisions.
+static void convertToGrayscale(const Image<uchar> & out, const ImageRef<Rgb_u> & in,
+                               simd::LumaStandard standard, simd::ChannelOrder order = simd::ChannelOrder::Rgb);
+
+static void convertToGrayscale(const Image<uchar> & out, const ImageRef<Rgba_u> & in,
+                               simd::LumaStandard standard, simd::ChannelOrder order = simd::ChannelOrder::Rgb);
+
+// conversion rgb(a) image to grayscale image (same as convertToGrayscale) with computing of the next levels of pyramid
+// (averaging 2x2 as Sampler_avg<int>) in one pass over color image, outLevel1 and outLevel2 can be null
+template <typename ColorType>
+static void convertToGrayscaleWithLevels(const Image<uchar> & outGray,
+                                         const Image<uchar> * outLevel1, const Image<uchar> * outLevel2,
+                                         const ImageRef<ColorType> & in,
+                                         simd::LumaStandard standard,
+                                         simd::ChannelOrder order = simd::ChannelOrder::Rgb);
+
 // computing integral image
 template <typename SumType, typename Type>
 static Image<typename Cast<Type, SumType>::Type> computeIntegralImage(const ImageRef<Type> & image);
 
 template <typename SumType, typename Type>
-static void computeIntegralImage(Image<typename Cast<SumType, Type>::Type> & outIntegral,
+static void computeIntegralImage(Image<typename Cast<Type, SumType>::Type> & outIntegral,
                                  const ImageRef<Type> & inImage);
 
+/// Integral image and integral image of squares of 8 bits image in one pass (same size as input,
+/// out(x, y) is sum of pixels in(i, j) for i <= x, j <= y). outSquaredIntegral can be null image.
+/// Sum of 4K image fits in int.
+static void computeIntegralImages(const Image<int> & outIntegral, const Image<std::int64_t> & outSquaredIntegral,
+                                  const ImageRef<uchar> & in);
+
+/// Rows are split into bands between threads of pool: bands are integrated separately,
+/// then sums of all rows above band are added to band.
+static void computeIntegralImages(const Image<int> & outIntegral, const Image<std::int64_t> & outSquaredIntegral,
+                                  const ImageRef<uchar> & in, WorkerPool & workerPool);
+
 template <typename SumType>
 struct Sampler_avg
 {
@@ -99,6 +170,21 @@ struct Sampler_avg
                              const Type & v2_1, const Type & v2_2) const;
 };
 
+// Binomial filter 5x5 ([1 4 6 4 1] / 16 by both axes) with decimation for halfSample.
+// Unlike 2x2 averaging it doesn't alias, so levels of pyramids are better for tracking.
+// Image is blurred and decimated in one pass, uchar image with SumType = int uses SIMD kernel.
+template <typename SumType>
+struct Sampler_gauss5
+{
+    typedef SumType TypeSum;
+};
+
+template <typename SamplerType>
+struct IsSamplerGauss5: std::false_type {};
+
+template <typename SumType>
+struct IsSamplerGauss5<Sampler_gauss5<SumType>>: std::true_type {};
+
 template <typename _Ty = void>
 struct less
 {
@@ -142,6 +228,7 @@ struct Sampler_max
 };
 
 // generating image with half size of source
+// (uchar image with Sampler_avg<int> is processed by SIMD kernel selected for processor)
 static Image<uchar> halfSample(const ImageRef<uchar> & in);
 
 static void halfSample(Image<uchar> & out, const ImageRef<uchar> & in);
@@ -153,6 +240,11 @@ template <typename SamplerType, typename Type>
 static void halfSample(Image<Type> & out, const ImageRef<Type> & in);
 
 
+// computing of rows from beginRow to endRow (all rows if endRow < 0) of out image for Sampler_gauss5
+template <typename SumType, typename Type>
+static void halfSampleGauss5(const Image<Type> & out, const ImageRef<Type> & in,
+                             int beginRow = 0, int endRow = -1);
+
 // generating image with double size of source
 static Image<uchar> doubleSample(const ImageRef<uchar> & in);
 
@@ -172,17 +264,77 @@ inline static OutType interpolate(const ImageRef<Type> & image, FType x, FType y
 template <typename OutType, typename Type, typename FType>
 inline static OutType interpolate(const ImageRef<Type> & image, const Point2<FType> & point);
 
+/// Bilinear sampling of many points of 8 bits image by SIMD, results are equal to interpolate<float>(image, point).
+/// Points must be in [0, width - 1) x [0, height - 1).
+static void interpolatePoints(float * out, const ImageRef<uchar> & image, const Point2f * points, int numberPoints);
+
+static std::vector<float> interpolatePoints(const ImageRef<uchar> & image, const std::vector<Point2f> & points);
+
+/// Bilinear sampling of patches with top left corners at beginPoints, patches are stacked by vertical:
+/// patch i is rows [i * patchHeight, (i + 1) * patchHeight) of out and has width of out.
+/// Every patch must be inside image together with one column on the right and one row on the bottom.
+static void interpolatePatches(const Image<uchar> & out, int patchHeight,
+                               const ImageRef<uchar> & image, const std::vector<Point2f> & beginPoints);
+
+static void interpolatePatches(const Image<float> & out, int patchHeight,
+                               const ImageRef<uchar> & image, const std::vector<Point2f> & beginPoints);
+
 
 // operator sobel and
 static void sobel(Image<int> & out, const ImageRef<uchar> & in);
 
 static Image<int> sobel(const ImageRef<uchar> & in);
 
+/// Central differences without scaling: x = I(x + 1, y) - I(x - 1, y), y = I(x, y + 1) - I(x, y - 1).
+/// Pixels of border are zero.
+static void centralDifferences(const Image<Point2<short>> & out, const ImageRef<uchar> & in);
+
+static Image<Point2<short>> centralDifferences(const ImageRef<uchar> & in);
+
+/// Gradients by operator 3x3 (see simd::GradientOperator), dx and dy are computed together in one pass.
+/// Pixels of border are zero.
+static void gradients(const Image<Point2<short>> & out, const ImageRef<uchar> & in,
+                      simd::GradientOperator gradientOperator = simd::GradientOperator::Sobel);
+
+/// Planes of structure tensor dx * dx, dx * dy and dy * dy in one pass, gradients aren't stored.
+/// Planes must have the same width step. Pixels of border are zero.
+static void structureTensor(const Image<int> & outXX, const Image<int> & outXY, const Image<int> & outYY,
+                            const ImageRef<uchar> & in,
+                            simd::GradientOperator gradientOperator = simd::GradientOperator::Sobel);
+
+/// Erosion of binary image by its integral image (integral of image with values 0 and 1):
+/// out = 255 if window (2 * size + 1) x (2 * size + 1) has more than k * area of window set pixels, else 0.
+/// Pixels, which windows don't fit into image, are 0.
 static void erode(Image<uchar> & out, const ImageRef<int> & integral, int size, float k);
 
 static Image<uchar> erode(const ImageRef<int> & integral, int size, float k);
 
+/// Adaptive binarization by local mean of window (2 * halfSize + 1) x (2 * halfSize + 1):
+/// out = 255 if in > mean - delta, else 0 (inverse swaps 0 and 255, so dark objects become 255).
+/// Window is clamped by borders of image. Sums are taken from integral image (see computeIntegralImages),
+/// so cost per pixel doesn't depend on size of window.
+static void thresholdLocalMean(const Image<uchar> & out, const ImageRef<uchar> & in, const ImageRef<int> & integral,
+                               int halfSize, float delta = 0.0f, bool inverse = false);
+
+static void thresholdLocalMean(const Image<uchar> & out, const ImageRef<uchar> & in, const ImageRef<int> & integral,
+                               WorkerPool & workerPool, int halfSize, float delta = 0.0f, bool inverse = false);
+
+/// Adaptive binarization of Sauvola: out = 255 if in > mean * (1 + k * (deviation / r - 1)), else 0,
+/// where deviation is standard deviation of window. Needs integral image and integral image of squares.
+static void thresholdSauvola(const Image<uchar> & out, const ImageRef<uchar> & in,
+                             const ImageRef<int> & integral, const ImageRef<std::int64_t> & squaredIntegral,
+                             int halfSize, float k = 0.2f, float r = 128.0f, bool inverse = false);
+
+static void thresholdSauvola(const Image<uchar> & out, const ImageRef<uchar> & in,
+                             const ImageRef<int> & integral, const ImageRef<std::int64_t> & squaredIntegral,
+                             WorkerPool & workerPool, int halfSize, float k = 0.2f, float r = 128.0f,
+                             bool inverse = false);
+
 // fast gaussian blur
+// Versions for uchar use fixed point kernels (8 bits of fraction), which are computed once and cached,
+// and SIMD implementations. gaussianBlur for uchar does both passes together by strips of image,
+// in and out may be the same image for it (in is copied then).
+// In and out of gaussianBlurX and gaussianBlurY must not overlap.
 static void gaussianBlurX(Image<uchar> & out, const ImageRef<uchar> & in, int halfSizeBlur, float sigma);
 static void gaussianBlurY(Image<uchar> & out, const ImageRef<uchar> & in, int halfSizeBlur, float sigma);
 static void gaussianBlur(Image<uchar> & out, const ImageRef<uchar> & in, int halfSizeBlur, float sigma);
@@ -201,6 +353,22 @@ static int transform2x2(Image<T> & out, const ImageRef<S> & in,
                         const Point2<P> & out_origin, const Point2<P> & in_origin,
                         const Eigen::Matrix<P, 2, 2> & transfromMatrix, const T defaultValue = T());
 
+/// Affine warp of 8 bits image with bilinear sampling by SIMD: out(p) = in(transform * (p.x, p.y, 1)).
+/// Pixels, which are mapped outside of input image, are set to borderValue. Values are rounded.
+static void warpAffine(const Image<uchar> & out, const ImageRef<uchar> & in,
+                       const Eigen::Matrix<float, 2, 3> & transform, uchar borderValue = 0);
+
+static void warpAffine(const Image<uchar> & out, const ImageRef<uchar> & in,
+                       const Eigen::Matrix<float, 2, 3> & transform, WorkerPool & workerPool, uchar borderValue = 0);
+
+/// Perspective warp of 8 bits image with bilinear sampling by SIMD: out(p) = in(h(homography * (p.x, p.y, 1))),
+/// h(v) = (v.x / v.z, v.y / v.z). Pixels, which are mapped outside of input image or with v.z <= 0, are set to borderValue.
+static void warpPerspective(const Image<uchar> & out, const ImageRef<uchar> & in,
+                            const Eigen::Matrix3f & homography, uchar borderValue = 0);
+
+static void warpPerspective(const Image<uchar> & out, const ImageRef<uchar> & in,
+                            const Eigen::Matrix3f & homography, WorkerPool & workerPool, uchar borderValue = 0);
+
 template <typename Type>
 static void normalize(Image<Type> & inout);
 
@@ -0,0 +1,193 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "MappedImageFile.h"
+
+#include <cctype>
+#include <climits>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace sonar {
+
+MappedFile::MappedFile():
+    m_data(nullptr),
+    m_size(0)
+#if defined(_WIN32)
+    , m_fileHandle(nullptr),
+    m_mappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(_WIN32)
+    if (m_data != nullptr)
+        UnmapViewOfFile(m_data);
+    if (m_mappingHandle != nullptr)
+        CloseHandle(m_mappingHandle);
+    if (m_fileHandle != nullptr)
+        CloseHandle(m_fileHandle);
+#else
+    if (m_data != nullptr)
+        munmap(const_cast<uchar*>(m_data), m_size);
+#endif
+}
+
+shared_ptr<MappedFile> MappedFile::open(const string & filename)
+{
+    shared_ptr<MappedFile> file(new MappedFile());
+#if defined(_WIN32)
+    HANDLE fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return nullptr;
+    file->m_fileHandle = fileHandle;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || (fileSize.QuadPart <= 0))
+        return nullptr;
+    file->m_size = static_cast<size_t>(fileSize.QuadPart);
+    HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mappingHandle == nullptr)
+        return nullptr;
+    file->m_mappingHandle = mappingHandle;
+    void * data = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr)
+        return nullptr;
+    file->m_data = static_cast<const uchar*>(data);
+#else
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat fileStat;
+    if ((fstat(fd, &fileStat) != 0) || (fileStat.st_size <= 0))
+    {
+        close(fd);
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(fileStat.st_size);
+    void * data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after closing of descriptor
+    close(fd);
+    if (data == MAP_FAILED)
+        return nullptr;
+    file->m_data = static_cast<const uchar*>(data);
+    file->m_size = size;
+    // Images and frames are usually read from top to bottom
+    madvise(data, size, MADV_SEQUENTIAL);
+#endif
+    return file;
+}
+
+const uchar * MappedFile::data() const
+{
+    return m_data;
+}
+
+size_t MappedFile::size() const
+{
+    return m_size;
+}
+
+namespace image_utils {
+
+/// Reads next unsigned number of netpbm header, whitespaces and comments are skipped
+static bool _readPnmNumber(const uchar * data, size_t size, size_t & offset, int & value)
+{
+    for (;;)
+    {
+        if (offset >= size)
+            return false;
+        if (data[offset] == '#')
+        {
+            while ((offset < size) && (data[offset] != '\n') && (data[offset] != '\r'))
+                ++offset;
+        }
+        else if (isspace(data[offset]))
+        {
+            ++offset;
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (!isdigit(data[offset]))
+        return false;
+    long long number = 0;
+    while ((offset < size) && isdigit(data[offset]))
+    {
+        number = number * 10 + (data[offset] - '0');
+        if (number > INT_MAX)
+            return false;
+        ++offset;
+    }
+    value = static_cast<int>(number);
+    return true;
+}
+
+/// @return offset of pixel data or 0 if header is wrong
+static size_t _readPnmHeader(const MappedFile & file, char format, Size2i & size)
+{
+    const uchar * data = file.data();
+    size_t fileSize = file.size();
+    if ((fileSize < 2) || (data[0] != 'P') || (data[1] != format))
+        return 0;
+    size_t offset = 2;
+    int maxValue = 0;
+    if (!_readPnmNumber(data, fileSize, offset, size.x) ||
+            !_readPnmNumber(data, fileSize, offset, size.y) ||
+            !_readPnmNumber(data, fileSize, offset, maxValue))
+        return 0;
+    // Only 8 bits per channel are supported, 16 bits images have another order of bytes
+    if ((maxValue <= 0) || (maxValue > 255))
+        return 0;
+    // Single whitespace separates header and pixels
+    if ((offset >= fileSize) || !isspace(data[offset]))
+        return 0;
+    return offset + 1;
+}
+
+ConstImage<uchar> mapPgmFile(const string & filename)
+{
+    shared_ptr<MappedFile> file = MappedFile::open(filename);
+    if (!file)
+        return ConstImage<uchar>();
+    Size2i size;
+    size_t offset = _readPnmHeader(*file, '5', size);
+    if (offset == 0)
+        return ConstImage<uchar>();
+    return mapImage<uchar>(file, size, offset);
+}
+
+ConstImage<Rgb_u> mapPpmFile(const string & filename)
+{
+    shared_ptr<MappedFile> file = MappedFile::open(filename);
+    if (!file)
+        return ConstImage<Rgb_u>();
+    Size2i size;
+    size_t offset = _readPnmHeader(*file, '6', size);
+    if (offset == 0)
+        return ConstImage<Rgb_u>();
+    return mapImage<Rgb_u>(file, size, offset);
+}
+
+} // namespace image_utils
+
+} // namespace sonar
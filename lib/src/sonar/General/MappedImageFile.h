@@ -0,0 +1,96 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_MAPPEDIMAGEFILE_H
+#define SONAR_MAPPEDIMAGEFILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "sonar/General/Point2.h"
+#include "sonar/General/Image.h"
+
+namespace sonar {
+
+/// Read-only memory mapping of whole file.
+/// The mapping is released with the last shared pointer, images created from it hold own copy of pointer.
+class MappedFile
+{
+public:
+    ~MappedFile();
+
+    /// @return nullptr if file can't be opened or mapped
+    static std::shared_ptr<MappedFile> open(const std::string & filename);
+
+    const uchar * data() const;
+    std::size_t size() const;
+
+private:
+    MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator = (const MappedFile &) = delete;
+
+    const uchar * m_data;
+    std::size_t m_size;
+#if defined(_WIN32)
+    void * m_fileHandle;
+    void * m_mappingHandle;
+#endif
+};
+
+/// Sequence of raw frames with same size stored one by one after header of file
+/// (for example, output of "ffmpeg -f rawvideo"). Frames are not decoded and not copied,
+/// the pages of file are loaded by system only when they are read.
+/// Size of header must be aligned for Type, else object is null as for file, which can't be opened.
+template <typename Type>
+class MappedFrames
+{
+public:
+    MappedFrames();
+    MappedFrames(const std::string & filename, const Size2i & frameSize, std::size_t headerSize = 0);
+
+    bool isNull() const;
+    int numberFrames() const;
+    Size2i frameSize() const;
+
+    /// Frame holds the mapping, so it stays valid after destroying of this object
+    ConstImage<Type> frame(int index) const;
+
+private:
+    std::shared_ptr<MappedFile> m_file;
+    Size2i m_frameSize;
+    std::size_t m_headerSize;
+    int m_numberFrames;
+};
+
+namespace image_utils {
+
+/// Image which uses data of mapped file without copying and holds the mapping
+/// @return null image if the file is too small for image or offset isn't aligned for Type
+template <typename Type>
+ConstImage<Type> mapImage(const std::shared_ptr<MappedFile> & file, const Size2i & size,
+                          std::size_t offset = 0, int widthStep = -1);
+
+/// Open binary grayscale PGM image (P5 with 8 bits per pixel) as mapped file
+/// @return null image if file can't be opened or has unsupported format
+ConstImage<uchar> mapPgmFile(const std::string & filename);
+
+/// Open binary color PPM image (P6 with 8 bits per channel) as mapped file
+/// @return null image if file can't be opened or has unsupported format
+ConstImage<Rgb_u> mapPpmFile(const std::string & filename);
+
+/// Open file with raw pixels as mapped file
+/// @return null image if file can't be opened, is too small or offset isn't aligned for Type
+template <typename Type>
+ConstImage<Type> mapRawFile(const std::string & filename, const Size2i & size, std::size_t offset = 0);
+
+} // namespace image_utils
+
+} // namespace sonar
+
+#include "impl/MappedImageFile_impl.hpp"
+#endif // SONAR_MAPPEDIMAGEFILE_H
@@ -0,0 +1,111 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_PLANARIMAGE_H
+#define SONAR_PLANARIMAGE_H
+
+#include <cassert>
+#include <type_traits>
+
+#include "sonar/General/Point2.h"
+#include "sonar/General/Image.h"
+
+namespace sonar {
+
+class WorkerPool;
+
+/// Channels of pixel type known at compile time: type of channel and number of channels.
+/// Pixel is accessed as array of channels, so pixel type must not have padding.
+template <typename PixelType, typename Enable = void>
+struct ChannelTraits;
+
+template <typename Type>
+struct ChannelTraits<Type, typename std::enable_if<std::is_arithmetic<Type>::value>::type>
+{
+    using ChannelType = Type;
+    static constexpr int numberChannels = 1;
+};
+
+template <typename Type>
+struct ChannelTraits<Rgb<Type>>
+{
+    using ChannelType = Type;
+    static constexpr int numberChannels = 3;
+    static_assert(sizeof(Rgb<Type>) == sizeof(Type) * 3, "Rgb must not have padding");
+};
+
+template <typename Type>
+struct ChannelTraits<Rgba<Type>>
+{
+    using ChannelType = Type;
+    static constexpr int numberChannels = 4;
+    static_assert(sizeof(Rgba<Type>) == sizeof(Type) * 4, "Rgba must not have padding");
+};
+
+/// Multi-channel image stored by planes (structure of arrays): every channel is a separate image.
+/// Per-channel processing reads continuous values of one channel, so every plane can be passed
+/// to the same functions and SIMD kernels as gray image.
+/// Planes lie one under another in one buffer, plane is a shared sub-image of this buffer.
+/// Copies of planar image share data like copies of Image.
+template <typename PixelType>
+class PlanarImage
+{
+public:
+    using TypeValue = PixelType;
+    using ChannelType = typename ChannelTraits<PixelType>::ChannelType;
+
+    static constexpr int numberChannels = ChannelTraits<PixelType>::numberChannels;
+
+    PlanarImage();
+    explicit PlanarImage(const Size2i & size);
+    explicit PlanarImage(const ImageRef<PixelType> & image);
+
+    bool isNull() const;
+    Size2i size() const;
+    int width() const;
+    int height() const;
+
+    void create(const Size2i & size);
+
+    inline const Image<ChannelType> & plane(int channel) const;
+    template <int Channel>
+    inline const Image<ChannelType> & plane() const;
+
+    inline PixelType pixel(int x, int y) const;
+    inline PixelType pixel(const Point2i & point) const;
+    inline void setPixel(int x, int y, const PixelType & value) const;
+    inline void setPixel(const Point2i & point, const PixelType & value) const;
+
+    void fill(const PixelType & value) const;
+
+    /// Splitting of interleaved image into planes, image is created again if size is different.
+    /// 8 bits images with 3 or 4 channels are split by SIMD kernels.
+    void copyFrom(const ImageRef<PixelType> & image);
+    void copyFrom(const ImageRef<PixelType> & image, WorkerPool & workerPool);
+    /// Joining of planes into interleaved image with the same size
+    void copyTo(const Image<PixelType> & out) const;
+    void copyTo(const Image<PixelType> & out, WorkerPool & workerPool) const;
+    Image<PixelType> toImage() const;
+
+    inline bool pointInImage(const Point2i & point) const;
+    inline bool pointInImage(int x, int y) const;
+
+private:
+    Image<ChannelType> m_buffer;
+    Image<ChannelType> m_planes[numberChannels];
+
+    void _split(const ImageRef<PixelType> & image, int beginRow, int endRow) const;
+    void _join(const Image<PixelType> & out, int beginRow, int endRow) const;
+};
+
+using PlanarImage_u = PlanarImage<Rgb_u>;
+using PlanarImage_f = PlanarImage<Rgb_f>;
+using PlanarImageRgba_u = PlanarImage<Rgba_u>;
+
+} // namespace sonar
+
+#include "impl/PlanarImage_impl.hpp"
+#endif // SONAR_PLANARIMAGE_H
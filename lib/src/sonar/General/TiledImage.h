@@ -0,0 +1,84 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_TILEDIMAGE_H
+#define SONAR_TILEDIMAGE_H
+
+#include <cassert>
+#include <vector>
+
+#include "sonar/General/Point2.h"
+#include "sonar/General/Image.h"
+
+namespace sonar {
+
+/// Image stored by square tiles TileSize x TileSize, every tile is continuous in memory.
+/// Small windows (patches of optical flow, scores of corners) touch few tiles
+/// instead of separate cache line and, on big frames, separate page for every row.
+/// Tiles on the right and bottom edges are padded, padding is not used.
+template <typename Type, int TileSize = 8>
+class TiledImage
+{
+public:
+    static_assert((TileSize > 0) && ((TileSize & (TileSize - 1)) == 0), "Size of tile must be power of 2");
+
+    typedef Type TypeValue;
+
+    static constexpr int tileSize = TileSize;
+    static constexpr int tileArea = TileSize * TileSize;
+
+    TiledImage();
+    explicit TiledImage(const Size2i & size);
+    explicit TiledImage(const ImageView<Type> & image);
+
+    bool isNull() const;
+    Size2i size() const;
+    int width() const;
+    int height() const;
+    /// Number of tiles by horizontal and vertical
+    Size2i numberTiles() const;
+
+    void create(const Size2i & size);
+    void copyFrom(const ImageView<Type> & image);
+    void copyTo(const Image<Type> & out) const;
+    Image<Type> toImage() const;
+
+    inline const Type & operator () (int x, int y) const;
+    inline const Type & operator () (const Point2i & point) const;
+    inline Type & operator () (int x, int y);
+    inline Type & operator () (const Point2i & point);
+
+    /// Pointer to tile, tile is stored row by row with width step equal to TileSize
+    inline const Type * tile(int tileX, int tileY) const;
+    inline Type * tile(int tileX, int tileY);
+
+    /// Copying of window with begin point and size of out image into linear image.
+    /// Window is read tile by tile, window must be inside image.
+    void copyPatch(const Image<Type> & out, const Point2i & begin) const;
+
+    inline bool pointInImage(const Point2i & point) const;
+    inline bool pointInImage(int x, int y) const;
+
+private:
+    static constexpr int _log2(int value) { return (value <= 1) ? 0 : (1 + _log2(value >> 1)); }
+    static constexpr int tileShift = _log2(TileSize);
+    static constexpr int tileMask = TileSize - 1;
+
+    std::vector<Type> m_data;
+    Size2i m_size;
+    Size2i m_numberTiles;
+
+    inline int _index(int x, int y) const;
+};
+
+using TiledImage_u = TiledImage<uchar>;
+using TiledImage_f = TiledImage<float>;
+using TiledImage_h = TiledImage<float16>;
+
+} // namespace sonar
+
+#include "impl/TiledImage_impl.hpp"
+#endif // SONAR_TILEDIMAGE_H
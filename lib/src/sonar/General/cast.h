@@ -9,6 +9,8 @@
 
 #include <vector>
 
+#include "sonar/General/Float16.h"
+
 #if defined(OPENCV_LIB)
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
@@ -127,6 +129,9 @@ inline static CastType cast(float value);
 template <typename CastType>
 inline static CastType cast(const double & value);
 
+template <typename CastType>
+inline static CastType cast(float16 value);
+
 template <typename CastType, typename Type>
 inline static Point2<typename Cast<Type, CastType>::Type> cast(const Point2<Type> & value);
 
@@ -0,0 +1,114 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_IMAGEBUFFERPOOL_IMPL_HPP
+#define SONAR_IMAGEBUFFERPOOL_IMPL_HPP
+
+namespace sonar {
+
+template <typename Type>
+ImageBufferPool<Type>::ImageBufferPool(int maxNumberBuffersPerSize, int maxNumberBuffers):
+    m_maxNumberBuffersPerSize(maxNumberBuffersPerSize),
+    m_maxNumberBuffers(maxNumberBuffers),
+    m_numberAcquires(0)
+{
+    assert(maxNumberBuffersPerSize > 0);
+    assert(maxNumberBuffers > 0);
+}
+
+template <typename Type>
+int ImageBufferPool<Type>::maxNumberBuffersPerSize() const
+{
+    std::lock_guard<std::mutex> locker(this->m_mutex); (void)locker;
+    return this->m_maxNumberBuffersPerSize;
+}
+
+template <typename Type>
+void ImageBufferPool<Type>::setMaxNumberBuffersPerSize(int maxNumberBuffersPerSize)
+{
+    assert(maxNumberBuffersPerSize > 0);
+    std::lock_guard<std::mutex> locker(this->m_mutex); (void)locker;
+    this->m_maxNumberBuffersPerSize = maxNumberBuffersPerSize;
+}
+
+template <typename Type>
+int ImageBufferPool<Type>::maxNumberBuffers() const
+{
+    std::lock_guard<std::mutex> locker(this->m_mutex); (void)locker;
+    return this->m_maxNumberBuffers;
+}
+
+template <typename Type>
+void ImageBufferPool<Type>::setMaxNumberBuffers(int maxNumberBuffers)
+{
+    assert(maxNumberBuffers > 0);
+    std::lock_guard<std::mutex> locker(this->m_mutex); (void)locker;
+    this->m_maxNumberBuffers = maxNumberBuffers;
+    this->_evict();
+}
+
+template <typename Type>
+Image<Type> ImageBufferPool<Type>::acquire(const Size2i & size)
+{
+    std::lock_guard<std::mutex> locker(this->m_mutex); (void)locker;
+    ++this->m_numberAcquires;
+    int numberBuffersOfSize = 0;
+    for (Entry & entry : this->m_entries)
+    {
+        if (entry.buffer.size() != size)
+            continue;
+        // Nobody can take new reference to buffer while the pool holds the only one
+        if (entry.buffer.numberReferences() == 1)
+        {
+            entry.lastUse = this->m_numberAcquires;
+            return entry.buffer;
+        }
+        ++numberBuffersOfSize;
+    }
+    Image<Type> buffer(size);
+    if (numberBuffersOfSize < this->m_maxNumberBuffersPerSize)
+    {
+        this->m_entries.push_back({ buffer, this->m_numberAcquires });
+        this->_evict();
+    }
+    return buffer;
+}
+
+template <typename Type>
+void ImageBufferPool<Type>::_evict()
+{
+    while (static_cast<int>(this->m_entries.size()) > this->m_maxNumberBuffers)
+    {
+        auto oldest = this->m_entries.end();
+        for (auto it = this->m_entries.begin(); it != this->m_entries.end(); ++it)
+        {
+            if ((it->buffer.numberReferences() == 1) &&
+                ((oldest == this->m_entries.end()) || (it->lastUse < oldest->lastUse)))
+                oldest = it;
+        }
+        if (oldest == this->m_entries.end())
+            return;
+        this->m_entries.erase(oldest);
+    }
+}
+
+template <typename Type>
+int ImageBufferPool<Type>::numberBuffers() const
+{
+    std::lock_guard<std::mutex> locker(this->m_mutex); (void)locker;
+    return static_cast<int>(this->m_entries.size());
+}
+
+template <typename Type>
+void ImageBufferPool<Type>::clear()
+{
+    std::lock_guard<std::mutex> locker(this->m_mutex); (void)locker;
+    this->m_entries.clear();
+}
+
+} // namespace sonar
+
+#endif // SONAR_IMAGEBUFFERPOOL_IMPL_HPP
@@ -10,62 +10,90 @@
 namespace sonar {
 
 template < typename Type, typename SamplerType >
-ImagePyramid<Type, SamplerType>::ImagePyramid()
+ImagePyramid<Type, SamplerType>::ImagePyramid():
+    m_numberBuiltLevels(0)
 {}
 
 template < typename Type, typename SamplerType >
-ImagePyramid<Type, SamplerType>::ImagePyramid(const ImageRef<Type> & image, int numberLevels)
+ImagePyramid<Type, SamplerType>::ImagePyramid(const ImageRef<Type> & image, int numberLevels,
+                                              const std::shared_ptr<ImageBufferPool<Type>> & bufferPool):
+    m_numberBuiltLevels(0),
+    m_bufferPool(bufferPool)
 {
     if ((numberLevels <= 0) || (image.isNull()))
         return;
-    this->m_level0 = image;
-    --numberLevels;
-    if (numberLevels > 0)
-    {
-        this->m_levels.resize(numberLevels);
-        ConstImage<Type> prev = image;
-        for (int i = 0; i < static_cast<int>(m_levels.size()); ++i)
-        {
-            this->m_levels[i] = image_utils::halfSample<SamplerType, Type>(prev);
-            prev = this->m_levels[i];
-        }
-    }
+    this->_setLevel0(image);
+    this->m_levels.resize(static_cast<size_t>(numberLevels - 1));
 }
 
 template < typename Type, typename SamplerType >
-ImagePyramid<Type, SamplerType>::ImagePyramid(const ImagePyramid<Type, SamplerType> & pyramid, int numberLevels)
+ImagePyramid<Type, SamplerType>::ImagePyramid(const ImagePyramid<Type, SamplerType> & pyramid):
+    m_numberBuiltLevels(0)
+{
+    std::lock_guard<std::mutex> locker(pyramid.m_mutex); (void)locker;
+    this->m_level0 = pyramid.m_level0;
+    this->m_levels = pyramid.m_levels;
+    this->m_bufferPool = pyramid.m_bufferPool;
+    this->m_numberBuiltLevels.store(pyramid.m_numberBuiltLevels.load());
+}
+
+template < typename Type, typename SamplerType >
+ImagePyramid<Type, SamplerType>::ImagePyramid(ImagePyramid<Type, SamplerType> && pyramid):
+    m_numberBuiltLevels(0)
+{
+    std::lock_guard<std::mutex> locker(pyramid.m_mutex); (void)locker;
+    this->m_level0 = std::move(pyramid.m_level0);
+    this->m_levels = std::move(pyramid.m_levels);
+    this->m_bufferPool = std::move(pyramid.m_bufferPool);
+    this->m_numberBuiltLevels.store(pyramid.m_numberBuiltLevels.exchange(0));
+    pyramid.m_levels.clear();
+}
+
+template < typename Type, typename SamplerType >
+ImagePyramid<Type, SamplerType>::ImagePyramid(const ImagePyramid<Type, SamplerType> & pyramid, int numberLevels):
+    m_numberBuiltLevels(0)
 {
     if ((numberLevels <= 0) || (pyramid.isNull()))
         return;
-    int i;
+    std::lock_guard<std::mutex> locker(pyramid.m_mutex); (void)locker;
     this->m_level0 = pyramid.m_level0;
+    this->m_bufferPool = pyramid.m_bufferPool;
     --numberLevels;
-    if (numberLevels <= 0)
-        return;
-    this->m_levels.resize(numberLevels);
-    if (this->m_levels.size() > pyramid.m_levels.size())
-    {
-        ConstImage<Type> prev = this->m_level0;
-        for (i = 0; i < static_cast<int>(pyramid.m_levels.size()); ++i)
-        {
-            this->m_levels[i] = pyramid.m_levels[i];
-            prev = this->m_levels[i];
-        }
-        for (i = static_cast<int>(pyramid.m_levels.size());
-             i < static_cast<int>(this->m_levels.size());
-             ++i)
-        {
-            this->m_levels[i] = image_utils::halfSample<SamplerType, Type>(prev);
-            prev = this->m_levels[i];
-        }
-    }
-    else
-    {
-        for (i = 0; i < static_cast<int>(this->m_levels.size()); ++i)
-        {
-            this->m_levels[i] = pyramid.m_levels[i];
-        }
-    }
+    this->m_levels.resize(static_cast<size_t>(numberLevels));
+    // Built levels are shared, other levels will be built by this pyramid
+    int numberSharedLevels = std::min(numberLevels, pyramid.m_numberBuiltLevels.load());
+    for (int i = 0; i < numberSharedLevels; ++i)
+        this->m_levels[i] = pyramid.m_levels[i];
+    this->m_numberBuiltLevels.store(numberSharedLevels);
+}
+
+template < typename Type, typename SamplerType >
+ImagePyramid<Type, SamplerType> &
+ImagePyramid<Type, SamplerType>::operator = (const ImagePyramid<Type, SamplerType> & pyramid)
+{
+    if (this == &pyramid)
+        return *this;
+    std::lock_guard<std::mutex> locker(pyramid.m_mutex); (void)locker;
+    this->m_level0 = pyramid.m_level0;
+    this->m_levels = pyramid.m_levels;
+    this->m_bufferPool = pyramid.m_bufferPool;
+    this->m_numberBuiltLevels.store(pyramid.m_numberBuiltLevels.load());
+    return *this;
+}
+
+template < typename Type, typename SamplerType >
+ImagePyramid<Type, SamplerType> &
+ImagePyramid<Type, SamplerType>::operator = (ImagePyramid<Type, SamplerType> && pyramid)
+{
+    if (this == &pyramid)
+        return *this;
+    std::lock_guard<std::mutex> locker(pyramid.m_mutex); (void)locker;
+    this->m_level0 = std::move(pyramid.m_level0);
+    this->m_levels = std::move(pyramid.m_levels);
+    this->m_bufferPool = std::move(pyramid.m_bufferPool);
+    this->m_numberBuiltLevels.store(pyramid.m_numberBuiltLevels.exchange(0));
+    pyramid.m_levels.clear();
+    return *this;
 }
 
 template < typename Type, typename SamplerType >
@@ -87,107 +115,173 @@ void ImagePyramid<Type, SamplerType>::clear()
 {
     this->m_level0 = Image<Type>();
     this->m_levels.clear();
+    this->m_numberBuiltLevels.store(0);
 }
 
 template < typename Type, typename SamplerType >
-ConstImage<Type> ImagePyramid<Type, SamplerType>::get(int level) const
+std::shared_ptr<ImageBufferPool<Type>> ImagePyramid<Type, SamplerType>::bufferPool() const
 {
-    if (level == 0)
-        return this->m_level0;
-    return this->m_levels.at(level - 1);
+    return this->m_bufferPool;
 }
 
 template < typename Type, typename SamplerType >
-void ImagePyramid<Type, SamplerType>::rebuild(const ImageRef<Type> & image)
+void ImagePyramid<Type, SamplerType>::setBufferPool(const std::shared_ptr<ImageBufferPool<Type>> & bufferPool)
 {
-    if (this->isNull())
+    this->m_bufferPool = bufferPool;
+}
+
+template < typename Type, typename SamplerType >
+void ImagePyramid<Type, SamplerType>::_setLevel0(const ImageRef<Type> & image)
+{
+    if (image.autoDeleting())
     {
+        this->m_level0 = image;
         return;
     }
-    if (image.isNull())
+    // Levels are built later, when the external buffer can already hold another frame.
+    // Own buffer is released first, so the pool can give it back if it was pooled
+    this->m_level0.release();
+    Image<Type> level0 = (this->m_bufferPool) ? this->m_bufferPool->acquire(image.size()) : Image<Type>(image.size());
+    level0.copyData(image);
+    this->m_level0 = level0;
+}
+
+template < typename Type, typename SamplerType >
+const ImageRef<Type> & ImagePyramid<Type, SamplerType>::_previousLevel(int index) const
+{
+    if (index == 0)
+        return this->m_level0;
+    return this->m_levels[static_cast<size_t>(index - 1)];
+}
+
+template < typename Type, typename SamplerType >
+Image<Type> & ImagePyramid<Type, SamplerType>::_prepareLevel(int index) const
+{
+    Image<Type> & out = this->m_levels[static_cast<size_t>(index)];
+    Size2i size = this->_previousLevel(index).size() / 2;
+    if (this->m_bufferPool)
     {
-        this->clear();
+        // Pooled buffer is referenced by the pool too, so it's released first and the pool gives it back,
+        // if nobody else holds it
+        out.release();
+        out = this->m_bufferPool->acquire(size);
+        return out;
+    }
+    if ((out.numberReferences() == 1) && (out.size() == size))
+        return out;
+    out = Image<Type>(size);
+    return out;
+}
+
+template < typename Type, typename SamplerType >
+void ImagePyramid<Type, SamplerType>::_buildLevels(int level) const
+{
+    if (level <= this->m_numberBuiltLevels.load(std::memory_order_acquire))
         return;
+    std::lock_guard<std::mutex> locker(this->m_mutex); (void)locker;
+    for (int i = this->m_numberBuiltLevels.load(std::memory_order_relaxed); i < level; ++i)
+    {
+        image_utils::halfSample<SamplerType, Type>(this->_prepareLevel(i), this->_previousLevel(i));
+        // Readers see the level only after it's completely built
+        this->m_numberBuiltLevels.store(i + 1, std::memory_order_release);
     }
-    ConstImage<Type> prev = image;
-    if (image.size() == this->m_level0.size())
+}
+
+template < typename Type, typename SamplerType >
+void ImagePyramid<Type, SamplerType>::buildLevels(WorkerPool & workerPool) const
+{
+    int numberLevels = static_cast<int>(this->m_levels.size());
+    if (numberLevels <= this->m_numberBuiltLevels.load(std::memory_order_acquire))
+        return;
+    std::lock_guard<std::mutex> locker(this->m_mutex); (void)locker;
+    int firstLevel = this->m_numberBuiltLevels.load(std::memory_order_relaxed);
+    if (firstLevel >= numberLevels)
+        return;
+    for (int i = firstLevel; i < numberLevels; ++i)
+        this->_prepareLevel(i);
+    if constexpr (image_utils::IsSamplerGauss5<SamplerType>::value)
     {
-        this->m_level0 = image;
-        for (int i = 0; i < static_cast<int>(this->m_levels.size()); ++i)
+        // Rows of band depend on neighbouring rows of previous level, so levels are built one by one
+        for (int i = firstLevel; i < numberLevels; ++i)
         {
-            if (this->m_levels[i].numberReferences() == 1)
-                image_utils::halfSample<SamplerType, Type>(this->m_levels[i], prev);
-            else
-                this->m_levels[i] = image_utils::halfSample<SamplerType, Type>(prev);
-            prev = this->m_levels[i];
+            const Image<Type> & out = this->m_levels[static_cast<size_t>(i)];
+            const ImageRef<Type> & prev = this->_previousLevel(i);
+            workerPool.parallelFor(0, out.height(), [&] (int beginRow, int endRow) {
+                image_utils::halfSampleGauss5<typename SamplerType::TypeSum, Type>(out, prev, beginRow, endRow);
+            });
         }
+        this->m_numberBuiltLevels.store(numberLevels, std::memory_order_release);
+        return;
     }
-    else
-    {
-        this->m_level0 = image;
-        for (int i = 0; i < static_cast<int>(this->m_levels.size()); ++i)
+    // Bands are aligned, so that band of every level is computed only from rows of the same band
+    // of previous level. The last band also takes remaining rows of every level.
+    int bandUnit = 1 << (numberLevels - 1 - firstLevel);
+    int numberUnits = std::max(this->m_levels[static_cast<size_t>(firstLevel)].height() / bandUnit, 1);
+    workerPool.parallelFor(0, numberUnits, [&] (int beginUnit, int endUnit) {
+        for (int i = firstLevel; i < numberLevels; ++i)
         {
-            this->m_levels[i] = image_utils::halfSample<SamplerType, Type>(prev);
-            prev = this->m_levels[i];
+            const Image<Type> & out = this->m_levels[static_cast<size_t>(i)];
+            int shift = i - firstLevel;
+            int beginRow = (beginUnit * bandUnit) >> shift;
+            int endRow = (endUnit == numberUnits) ? out.height() : ((endUnit * bandUnit) >> shift);
+            if (endRow <= beginRow)
+                continue;
+            Image<Type> outBand(out, Point2i(0, beginRow), Size2i(out.width(), endRow - beginRow));
+            ConstImage<Type> prevBand(this->_previousLevel(i), Point2i(0, beginRow * 2),
+                                      Size2i(out.width() * 2, (endRow - beginRow) * 2));
+            image_utils::halfSample<SamplerType, Type>(outBand, prevBand);
         }
-    }
+    });
+    this->m_numberBuiltLevels.store(numberLevels, std::memory_order_release);
 }
 
 template < typename Type, typename SamplerType >
-void ImagePyramid<Type, SamplerType>::rebuild(const ImageRef<Type> & image, int numberLevels)
+ConstImage<Type> ImagePyramid<Type, SamplerType>::get(int level) const
 {
-    if ((numberLevels <= 0) || (image.isNull()))
+    if (level == 0)
+        return this->m_level0;
+    const Image<Type> & image = this->m_levels.at(level - 1);
+    this->_buildLevels(level);
+    return image;
+}
+
+template < typename Type, typename SamplerType >
+ImageView<Type> ImagePyramid<Type, SamplerType>::view(int level) const
+{
+    assert((level >= 0) && (level < this->numberLevels()));
+    if (level == 0)
+        return this->m_level0.view();
+    this->_buildLevels(level);
+    return this->m_levels[static_cast<size_t>(level - 1)].view();
+}
+
+template < typename Type, typename SamplerType >
+void ImagePyramid<Type, SamplerType>::rebuild(const ImageRef<Type> & image)
+{
+    if (this->isNull())
     {
-        this->clear();
         return;
     }
-    --numberLevels;
-    ConstImage<Type> prev = image;
-    int i;
-    if (image.size() == this->m_level0.size())
+    if (image.isNull())
     {
-        this->m_level0 = image;
-        if (numberLevels > (int)this->m_levels.size())
-        {
-            int oldNumberLevels = (int)this->m_levels.size();
-            this->m_levels.resize(numberLevels);
-            for (i = 0; i < oldNumberLevels; ++i)
-            {
-                if (this->m_levels[i].numberReferences() == 1)
-                    image_utils::halfSample<SamplerType, Type>(this->m_levels[i], prev);
-                else
-                    this->m_levels[i] = image_utils::halfSample<SamplerType, Type>(prev);
-                prev = this->m_levels[i];
-            }
-            for (i = oldNumberLevels; i < numberLevels; ++i)
-            {
-                this->m_levels[i] = image_utils::halfSample<SamplerType, Type>(prev);
-                prev = this->m_levels[i];
-            }
-        }
-        else
-        {
-            this->m_levels.resize(numberLevels);
-            for (i = 0; i < numberLevels; ++i)
-            {
-                if (this->m_levels[i].numberReferences() == 1)
-                    image_utils::halfSample<SamplerType, Type>(this->m_levels[i], prev);
-                else
-                    this->m_levels[i] = image_utils::halfSample<SamplerType, Type>(prev);
-                prev = this->m_levels[i];
-            }
-        }
+        this->clear();
+        return;
     }
-    else
+    this->_setLevel0(image);
+    this->m_numberBuiltLevels.store(0);
+}
+
+template < typename Type, typename SamplerType >
+void ImagePyramid<Type, SamplerType>::rebuild(const ImageRef<Type> & image, int numberLevels)
+{
+    if ((numberLevels <= 0) || (image.isNull()))
     {
-        this->m_level0 = image;
-        this->m_levels.resize(numberLevels);
-        for (i = 0; i < numberLevels; ++i)
-        {
-            this->m_levels[i] = image_utils::halfSample<SamplerType, Type>(prev);
-            prev = this->m_levels[i];
-        }
+        this->clear();
+        return;
     }
+    this->_setLevel0(image);
+    this->m_levels.resize(static_cast<size_t>(numberLevels - 1));
+    this->m_numberBuiltLevels.store(0);
 }
 
 template < typename Type, typename SamplerType >
@@ -197,36 +291,59 @@ void ImagePyramid<Type, SamplerType>::rebuild(int numberLevels)
     {
         return;
     }
-    if (numberLevels == 0)
+    if (numberLevels <= 0)
     {
         this->clear();
         return;
     }
     --numberLevels;
-    int oldNumberLevels = static_cast<int>(this->m_levels.size());
-    this->m_levels.resize(numberLevels);
-    if (numberLevels > oldNumberLevels)
+    this->m_levels.resize(static_cast<size_t>(numberLevels));
+    this->m_numberBuiltLevels.store(std::min(this->m_numberBuiltLevels.load(), numberLevels));
+}
+
+template < typename Type, typename SamplerType >
+template < typename ColorType >
+void ImagePyramid<Type, SamplerType>::rebuildFromColor(const ImageRef<ColorType> & image, int numberLevels,
+                                                       simd::LumaStandard standard, simd::ChannelOrder order)
+{
+    static_assert(std::is_same<Type, uchar>::value &&
+                  std::is_same<SamplerType, image_utils::Sampler_avg<int>>::value,
+                  "Fused conversion is implemented only for uchar pyramid with averaging sampler");
+    if ((numberLevels <= 0) || (image.isNull()))
     {
-        ConstImage<Type> prev = (oldNumberLevels == 0) ? this->m_level0 :
-                                                         this->m_levels[oldNumberLevels - 1];
-        for (int i = oldNumberLevels; i < numberLevels; ++i)
-        {
-            this->m_levels[i] = image_utils::halfSample<SamplerType, Type>(prev);
-            prev = this->m_levels[i];
-        }
+        this->clear();
+        return;
     }
+    // Own buffer is released first, so the pool can give it back if it was pooled
+    this->m_level0.release();
+    Image<Type> gray = (this->m_bufferPool) ? this->m_bufferPool->acquire(image.size()) : Image<Type>(image.size());
+    this->m_level0 = gray;
+    this->m_levels.resize(static_cast<size_t>(numberLevels - 1));
+    this->m_numberBuiltLevels.store(0);
+    int numberFusedLevels = std::min(numberLevels - 1, 2);
+    for (int i = 0; i < numberFusedLevels; ++i)
+        this->_prepareLevel(i);
+    image_utils::convertToGrayscaleWithLevels(gray,
+                                              (numberFusedLevels > 0) ? &this->m_levels[0] : nullptr,
+                                              (numberFusedLevels > 1) ? &this->m_levels[1] : nullptr,
+                                              image, standard, order);
+    this->m_numberBuiltLevels.store(numberFusedLevels);
 }
 
 template < typename Type, typename SamplerType >
 ImagePyramid<Type, SamplerType> ImagePyramid<Type, SamplerType>::copy() const
 {
     ImagePyramid<Type, SamplerType> r;
+    if (this->isNull())
+        return r;
+    this->_buildLevels(static_cast<int>(this->m_levels.size()));
     r.m_level0 = this->m_level0.copy();
-    r.m_levels.resize(m_levels.size());
+    r.m_levels.resize(this->m_levels.size());
     for (int i = 0; i < (int)this->m_levels.size(); ++i)
     {
         r.m_levels[i] = this->m_levels[i].copy();
     }
+    r.m_numberBuiltLevels.store(static_cast<int>(r.m_levels.size()));
     return r;
 }
 
@@ -234,36 +351,22 @@ template < typename Type, typename SamplerType >
 ImagePyramid<Type, SamplerType> ImagePyramid<Type, SamplerType>::copy(int numberLevels) const
 {
     ImagePyramid<Type, SamplerType> r;
-    if ((this->isNull()) || (numberLevels == 0))
+    if ((this->isNull()) || (numberLevels <= 0))
         return r;
     r.m_level0 = this->m_level0.copy();
     --numberLevels;
-    r.m_levels.resize(numberLevels);
-    int i;
-    if (r.m_levels.size() > this->m_levels.size())
-    {
-        ConstImage<Type> prev = this->m_level0;
-        for (i = 0; i < (int)this->m_levels.size(); ++i)
-        {
-            r.m_levels[i] = this->m_levels[i].copy();
-            prev = r.m_levels[i];
-        }
-        for (i = (int)this->m_levels.size(); i < (int)r.m_levels.size(); ++i)
-        {
-            r.m_levels[i] = image_utils::halfSample<SamplerType, Type>(prev);
-            prev = r.m_levels[i];
-        }
-    }
-    else
+    r.m_levels.resize(static_cast<size_t>(numberLevels));
+    // Missing levels will be built from copied data by the new pyramid
+    int numberCopiedLevels = std::min(numberLevels, static_cast<int>(this->m_levels.size()));
+    this->_buildLevels(numberCopiedLevels);
+    for (int i = 0; i < numberCopiedLevels; ++i)
     {
-        for (i = 0; i < (int)r.m_levels.size(); ++i)
-        {
-            r.m_levels[i] = this->m_levels[i].copy();
-        }
+        r.m_levels[i] = this->m_levels[i].copy();
     }
+    r.m_numberBuiltLevels.store(numberCopiedLevels);
     return r;
 }
 
 } // namespace sonar
 
-#endif // SONAR_IMAGE_PYRAMID_IMPL_HPP;
+#endif // SONAR_IMAGE_PYRAMID_IMPL_HPP
@@ -98,124 +98,183 @@ QImage convertToQImage(const ImageRef<uchar> & image)
 #endif
 
 #if defined(OPENCV_LIB)
+template <typename Type>
+struct CvMatType;
+
+template <> struct CvMatType<uchar> { static constexpr int value = CV_8UC1; };
+template <> struct CvMatType<short> { static constexpr int value = CV_16SC1; };
+template <> struct CvMatType<ushort> { static constexpr int value = CV_16UC1; };
+template <> struct CvMatType<int> { static constexpr int value = CV_32SC1; };
+template <> struct CvMatType<float> { static constexpr int value = CV_32FC1; };
+template <> struct CvMatType<Rgb_u> { static constexpr int value = CV_8UC3; };
+template <> struct CvMatType<Rgba_u> { static constexpr int value = CV_8UC4; };
+template <> struct CvMatType<Rgb_f> { static constexpr int value = CV_32FC3; };
+template <> struct CvMatType<Rgba_f> { static constexpr int value = CV_32FC4; };
+
+/// Allocator of cv::Mat which holds reference to image instead of own memory.
+/// New memory is allocated by default allocator of opencv (for example, cv::Mat::create with another size).
+class ImageMatAllocator: public cv::MatAllocator
+{
+public:
+#if CV_VERSION_MAJOR >= 4
+    cv::UMatData * allocate(int dims, const int * sizes, int type, void * data, size_t * step,
+                            cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override
+    {
+        return cv::Mat::getDefaultAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(cv::UMatData * data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override
+    {
+        return cv::Mat::getDefaultAllocator()->allocate(data, accessFlags, usageFlags);
+    }
+#else
+    cv::UMatData * allocate(int dims, const int * sizes, int type, void * data, size_t * step,
+                            int flags, cv::UMatUsageFlags usageFlags) const override
+    {
+        return cv::Mat::getDefaultAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+
+    bool allocate(cv::UMatData * data, int accessFlags, cv::UMatUsageFlags usageFlags) const override
+    {
+        return cv::Mat::getDefaultAllocator()->allocate(data, accessFlags, usageFlags);
+    }
+#endif
+
+    void deallocate(cv::UMatData * data) const override
+    {
+        // userdata keeps copy of image
+        delete static_cast<std::function<void()>*>(data->userdata);
+        delete data;
+    }
+
+    static ImageMatAllocator * instance()
+    {
+        static ImageMatAllocator allocator;
+        return &allocator;
+    }
+};
+
+template <typename Type>
+Image<Type> shareCvMat(const cv::Mat & image)
+{
+    assert(image.type() == CvMatType<Type>::value);
+    if (image.empty())
+        return Image<Type>();
+    assert(image.dims == 2);
+    assert((image.step[0] % sizeof(Type)) == 0);
+    cv::Mat holder = image;
+    return Image<Type>(Point2i(image.cols, image.rows), reinterpret_cast<Type*>(image.data),
+                       cast<int>(image.step[0] / sizeof(Type)), [holder] () { (void)holder; });
+}
+
+template <typename Type>
+cv::Mat shareToCvMat(const ImageRef<Type> & image)
+{
+    if (image.isNull())
+        return cv::Mat();
+    uchar * data = const_cast<uchar*>(reinterpret_cast<const uchar*>(image.data()));
+    size_t step = cast<size_t>(image.widthStep()) * sizeof(Type);
+    cv::Mat result(image.height(), image.width(), CvMatType<Type>::value, data, step);
+    ConstImage<Type> holder(image);
+    cv::UMatData * u = new cv::UMatData(ImageMatAllocator::instance());
+    u->data = u->origdata = data;
+    u->size = step * cast<size_t>(image.height());
+    u->userdata = new std::function<void()>([holder] () { (void)holder; });
+    u->refcount = 1;
+    result.u = u;
+    result.allocator = ImageMatAllocator::instance();
+    return result;
+}
+
 Image<uchar> convertCvMat_u(cv::Mat image, bool copy)
 {
     assert(image.type() == CV_8UC1);
-    Image<uchar> im(Point2i(image.cols, image.rows), reinterpret_cast<uchar*>(image.data),
-                    cast<int>(image.step1()), false);
+    Image<uchar> im = shareCvMat<uchar>(image);
     return copy ? im.copy() : im;
 }
 
 Image<short> convertCvMat_short(cv::Mat image, bool copy)
 {
     assert(image.type() == CV_16SC1);
-    Image<short> im(Point2i(image.cols, image.rows), reinterpret_cast<short*>(image.data),
-                    cast<int>(image.step1()), false);
+    Image<short> im = shareCvMat<short>(image);
     return copy ? im.copy() : im;
 }
 
 Image<Rgb_u> convertCvMat_rgb_u(cv::Mat image, bool copy)
 {
     assert(image.type() == CV_8UC3);
-    Image<Rgb_u> im(Point2i(image.cols, image.rows), reinterpret_cast<Rgb_u*>(image.data),
-                    cast<int>(image.step1()) / 3, false);
+    Image<Rgb_u> im = shareCvMat<Rgb_u>(image);
     return copy ? im.copy() : im;
 }
 
 Image<Rgba_u> convertCvMat_rgba_u(cv::Mat image, bool copy)
 {
     assert(image.type() == CV_8UC4);
-    Image<Rgba_u> im(Point2i(image.cols, image.rows), reinterpret_cast<Rgba_u*>(image.data),
-                     cast<int>(image.step1()) / 4, false);
+    Image<Rgba_u> im = shareCvMat<Rgba_u>(image);
     return copy ? im.copy() : im;
 }
 
 Image<float> convertCvMat_f(cv::Mat image, bool copy)
 {
     assert(image.type() == CV_32FC1);
-    Image<float> im(Point2i(image.cols, image.rows), reinterpret_cast<float*>(image.data),
-                    cast<int>(image.step1()), false);
+    Image<float> im = shareCvMat<float>(image);
     return copy ? im.copy() : im;
 }
 
 Image<Rgb_f> convertCvMat_rgb_f(cv::Mat image, bool copy)
 {
     assert(image.type() == CV_32FC3);
-    Image<Rgb_f> im(Point2i(image.cols, image.rows), reinterpret_cast<Rgb_f*>(image.data),
-                    cast<int>(image.step1()) / 3, false);
+    Image<Rgb_f> im = shareCvMat<Rgb_f>(image);
     return copy ? im.copy() : im;
 }
 
 Image<Rgba_f> convertCvMat_rgba_f(cv::Mat image, bool copy)
 {
     assert(image.type() == CV_32FC4);
-    Image<Rgba_f> im(Point2i(image.cols, image.rows), reinterpret_cast<Rgba_f*>(image.data),
-                     cast<int>(image.step1()) / 4, false);
+    Image<Rgba_f> im = shareCvMat<Rgba_f>(image);
     return copy ? im.copy() : im;
 }
 
 Image<int> convertCvMat_i(cv::Mat image, bool copy)
 {
     assert(image.type() == CV_32S);
-    Image<int> im(Point2i(image.cols, image.rows), reinterpret_cast<int*>(image.data),
-                  cast<int>(image.step1()), false);
+    Image<int> im = shareCvMat<int>(image);
     return copy ? im.copy() : im;
 }
 
 cv::Mat convertToCvMat(const ImageRef<Rgba_u> & image)
 {
-    cv::Mat result(image.height(), image.width(), CV_8UC4,
-                   const_cast<uchar*>(reinterpret_cast<const uchar*>(image.data())),
-                   image.widthStep() * sizeof(Rgba_u));
-    return result;
+    return shareToCvMat(image);
 }
 
 cv::Mat convertToCvMat(const ImageRef<Rgb_u> & image)
 {
-    cv::Mat result(image.height(), image.width(), CV_8UC3,
-                   const_cast<uchar*>(reinterpret_cast<const uchar*>(image.data())),
-                   image.widthStep() * sizeof(Rgb_u));
-    return result;
+    return shareToCvMat(image);
 }
 
 cv::Mat convertToCvMat(const ImageRef<uchar> & image)
 {
-    cv::Mat result(image.height(), image.width(), CV_8UC1,
-                   const_cast<uchar*>(reinterpret_cast<const uchar*>(image.data())),
-                   image.widthStep() * sizeof(uchar));
-    return result;
+    return shareToCvMat(image);
 }
 
 cv::Mat convertToCvMat(const ImageRef<ushort> & image)
 {
-    cv::Mat result(image.height(), image.width(), CV_16UC1,
-                   const_cast<ushort*>(reinterpret_cast<const ushort*>(image.data())),
-                   image.widthStep() * sizeof(ushort));
-    return result;
+    return shareToCvMat(image);
 }
 
 cv::Mat convertToCvMat(const ImageRef<float> & image)
 {
-    cv::Mat result(image.height(), image.width(), CV_32FC1,
-                   const_cast<uchar*>(reinterpret_cast<const uchar*>(image.data())),
-                   image.widthStep() * sizeof(float));
-    return result;
+    return shareToCvMat(image);
 }
 
 cv::Mat convertToCvMat(const ImageRef<Rgba_f> & image)
 {
-    cv::Mat result(image.height(), image.width(), CV_32FC4,
-                   const_cast<uchar*>(reinterpret_cast<const uchar*>(image.data())),
-                   image.widthStep() * sizeof(Rgba_f));
-    return result;
+    return shareToCvMat(image);
 }
 
 cv::Mat convertToCvMat(const ImageRef<Rgb_f> & image)
 {
-    cv::Mat result(image.height(), image.width(), CV_32FC3,
-                   const_cast<uchar*>(reinterpret_cast<const uchar*>(image.data())),
-                   image.widthStep() * sizeof(Rgb_f));
-    return result;
+    return shareToCvMat(image);
 }
 #endif
 
@@ -223,14 +282,75 @@ template <typename Type>
 Image<Type> resizeImage(const ImageRef<Type> & image, const Point2i & newSize)
 {
     Image<Type> newImage(newSize);
-    paint::drawImage(newImage, image, image.size());
+    if constexpr (std::is_same<Type, uchar>::value)
+        resizeImage(newImage, image);
+    else
+        paint::drawImage(newImage, image, Point2f(0.0f, 0.0f), Size2f(cast<float>(newSize.x), cast<float>(newSize.y)));
     return newImage;
 }
 
+void resizeImage(const Image<uchar> & out, const ImageRef<uchar> & in)
+{
+    std::shared_ptr<const simd::ResizeCoefficients> xCoefficients = simd::resizeCoefficients(in.width(), out.width());
+    std::shared_ptr<const simd::ResizeCoefficients> yCoefficients = simd::resizeCoefficients(in.height(), out.height());
+    simd::resize_u(out.data(), out.widthStep(), in.data(), in.widthStep(),
+                   *xCoefficients, *yCoefficients, 0, out.height());
+}
+
+void resizeImage(const Image<uchar> & out, const ImageRef<uchar> & in, WorkerPool & workerPool)
+{
+    std::shared_ptr<const simd::ResizeCoefficients> xCoefficients = simd::resizeCoefficients(in.width(), out.width());
+    std::shared_ptr<const simd::ResizeCoefficients> yCoefficients = simd::resizeCoefficients(in.height(), out.height());
+    workerPool.parallelFor(0, out.height(), [&] (int beginRow, int endRow) {
+        simd::resize_u(out.data(), out.widthStep(), in.data(), in.widthStep(),
+                       *xCoefficients, *yCoefficients, beginRow, endRow);
+    });
+}
+
+void convertToHalf(const Image<float16> & out, const ImageRef<float> & in)
+{
+    assert(out.size() == in.size());
+    for (int y = 0; y < in.height(); ++y)
+        simd::convertToHalf_f(reinterpret_cast<std::uint16_t*>(out.pointer(0, y)), in.pointer(0, y), in.width());
+}
+
+void convertToHalf(const Image<float16> & out, const ImageRef<uchar> & in)
+{
+    assert(out.size() == in.size());
+    for (int y = 0; y < in.height(); ++y)
+        simd::convertToHalf_u(reinterpret_cast<std::uint16_t*>(out.pointer(0, y)), in.pointer(0, y), in.width());
+}
+
+Image<float16> convertToHalf(const ImageRef<float> & image)
+{
+    Image<float16> out(image.size());
+    convertToHalf(out, image);
+    return out;
+}
+
+void convertToFloat(const Image<float> & out, const ImageRef<float16> & in)
+{
+    assert(out.size() == in.size());
+    for (int y = 0; y < in.height(); ++y)
+        simd::convertFromHalf_f(out.pointer(0, y), reinterpret_cast<const std::uint16_t*>(in.pointer(0, y)), in.width());
+}
+
+Image<float> convertToFloat(const ImageRef<float16> & image)
+{
+    Image<float> out(image.size());
+    convertToFloat(out, image);
+    return out;
+}
+
 template <typename Type>
 void convertToGrayscale(Image<Type> & out, const ImageRef<Rgb<Type>> & image)
 {
     assert(out.size() == image.size());
+    if constexpr (std::is_same<Type, uchar>::value)
+    {
+        convertToGrayscale(out, image, simd::LumaStandard::Bt601);
+        return;
+    }
     Point2i p;
     for (p.y = 0; p.y < out.height(); ++p.y)
     {
@@ -239,7 +359,7 @@ void convertToGrayscale(Image<Type> & out, const ImageRef<Rgb<Type>> & image)
         for (p.x = 0; p.x < out.width(); ++p.x)
         {
             const Rgb<Type> & rgb = imageStr[p.x];
-            resultStr[p.x] = cast<Type>((rgb.red + rgb.green + rgb.blue) / 3);
+            resultStr[p.x] = cast<Type>(rgb.red * 0.299f + rgb.green * 0.587f + rgb.blue * 0.114f);
         }
     }
 }
@@ -256,6 +376,11 @@ template <typename Type>
 void convertToGrayscale(Image<Type> & out, const ImageRef<Rgba<Type>> & image)
 {
     assert(out.size() == image.size());
+    if constexpr (std::is_same<Type, uchar>::value)
+    {
+        convertToGrayscale(out, image, simd::LumaStandard::Bt601);
+        return;
+    }
     Point2i p;
     for (p.y = 0; p.y < out.height(); ++p.y)
     {
@@ -264,7 +389,7 @@ void convertToGrayscale(Image<Type> & out, const ImageRef<Rgba<Type>> & image)
         for (p.x = 0; p.x < out.width(); ++p.x)
         {
             const Rgba<Type> & rgb = imageStr[p.x];
-            resultStr[p.x] = cast<Type>((rgb.red + rgb.green + rgb.blue) / 3);
+            resultStr[p.x] = cast<Type>(rgb.red * 0.299f + rgb.green * 0.587f + rgb.blue * 0.114f);
         }
     }
 }
@@ -277,17 +402,78 @@ Image<Type> convertToGrayscale(const ImageRef<Rgba<Type>> & image)
     return r;
 }
 
+void convertToGrayscale(const Image<uchar> & out, const ImageRef<Rgb_u> & in,
+                        simd::LumaStandard standard, simd::ChannelOrder order)
+{
+    static_assert(sizeof(Rgb_u) == 3, "Rgb_u must be packed");
+    assert(out.size() == in.size());
+    simd::grayscale_u(out.data(), out.widthStep(), reinterpret_cast<const uchar*>(in.data()),
+                      in.widthStep() * 3, in.width(), 3, order, standard, 0, in.height());
+}
+
+void convertToGrayscale(const Image<uchar> & out, const ImageRef<Rgba_u> & in,
+                        simd::LumaStandard standard, simd::ChannelOrder order)
+{
+    static_assert(sizeof(Rgba_u) == 4, "Rgba_u must be packed");
+    assert(out.size() == in.size());
+    simd::grayscale_u(out.data(), out.widthStep(), reinterpret_cast<const uchar*>(in.data()),
+                      in.widthStep() * 4, in.width(), 4, order, standard, 0, in.height());
+}
+
+template <typename ColorType>
+void convertToGrayscaleWithLevels(const Image<uchar> & outGray,
+                                  const Image<uchar> * outLevel1, const Image<uchar> * outLevel2,
+                                  const ImageRef<ColorType> & in,
+                                  simd::LumaStandard standard, simd::ChannelOrder order)
+{
+    assert(outGray.size() == in.size());
+    assert((outLevel1 == nullptr) || (outLevel1->size() == (outGray.size() / 2)));
+    assert((outLevel2 == nullptr) || ((outLevel1 != nullptr) && (outLevel2->size() == (outLevel1->size() / 2))));
+    static_assert((sizeof(ColorType) == 3) || (sizeof(ColorType) == 4), "Only Rgb_u and Rgba_u are supported");
+    auto convertRow = [&] (int y) {
+        simd::grayscale_u(outGray.pointer(0, y), outGray.widthStep(), reinterpret_cast<const uchar*>(in.pointer(0, y)),
+                          in.widthStep() * static_cast<int>(sizeof(ColorType)), in.width(),
+                          static_cast<int>(sizeof(ColorType)), order, standard, 0, 1);
+    };
+    auto halfSampleRow = [] (const Image<uchar> & out, const Image<uchar> & prev, int y) {
+        simd::halfSample_u(out.pointer(0, y), out.widthStep(), prev.pointer(0, y * 2), prev.widthStep(),
+                           out.width(), 1);
+    };
+    // Rows of levels are computed right after rows of previous level, while they are still in cache
+    int y = 0;
+    if (outLevel1 != nullptr)
+    {
+        for (int y1 = 0; y1 < outLevel1->height(); ++y1)
+        {
+            convertRow(y++);
+            convertRow(y++);
+            halfSampleRow(*outLevel1, outGray, y1);
+            if ((outLevel2 != nullptr) && ((y1 & 1) == 1) && ((y1 >> 1) < outLevel2->height()))
+                halfSampleRow(*outLevel2, *outLevel1, y1 >> 1);
+        }
+    }
+    for (; y < in.height(); ++y)
+        convertRow(y);
+}
+
 template <typename SumType, typename Type>
-void computeIntegralImage(Image<typename Cast<SumType, Type>::Type> & outIntegral, const ImageRef<Type> & inImage)
+void computeIntegralImage(Image<typename Cast<Type, SumType>::Type> & outIntegral, const ImageRef<Type> & inImage)
 {
     assert(outIntegral.size() == inImage.size());
 
+    if constexpr (std::is_same<Type, uchar>::value &&
+                  std::is_same<typename Cast<Type, SumType>::Type, int>::value)
+    {
+        computeIntegralImages(outIntegral, Image<std::int64_t>(), inImage);
+        return;
+    }
+
     const Type * strCur = inImage.data();
-    typename Cast<SumType, Type>::Type * strOutIntegral_prev;
-    typename Cast<SumType, Type>::Type * strOutIntegral = outIntegral.data();
+    typename Cast<Type, SumType>::Type * strOutIntegral_prev;
+    typename Cast<Type, SumType>::Type * strOutIntegral = outIntegral.data();
     int w = inImage.width();
     int h = inImage.height();
-    typename Cast<SumType, Type>::Type rs;
+    typename Cast<Type, SumType>::Type rs;
     Point2i p;
     strOutIntegral[0] = strCur[0];
     for (p.x = 1; p.x < w; ++p.x)
@@ -381,23 +567,79 @@ template <typename SamplerType, typename Type>
 void halfSample(Image<Type> & out, const ImageRef<Type> & in)
 {
     assert((in.size() / 2) == out.size());
-    SamplerType sampler;
-    Point2i outP;
-    int inPx = 0;
-    Type * outStr = out.data();
-    const Type * inStrA = in.data();
-    const Type * inStrB = &inStrA[in.widthStep()];
-    for (outP.y = 0; outP.y < out.height(); ++outP.y)
+    if constexpr (IsSamplerGauss5<SamplerType>::value)
     {
-        for (inPx = outP.x = 0; outP.x < out.width(); ++outP.x)
+        halfSampleGauss5<typename SamplerType::TypeSum, Type>(out, in);
+    }
+    else if constexpr (std::is_same<Type, uchar>::value && std::is_same<SamplerType, Sampler_avg<int>>::value)
+    {
+        simd::halfSample_u(out.data(), out.widthStep(), in.data(), in.widthStep(), out.width(), out.height());
+    }
+    else
+    {
+        SamplerType sampler;
+        Point2i outP;
+        int inPx = 0;
+        Type * outStr = out.data();
+        const Type * inStrA = in.data();
+        const Type * inStrB = &inStrA[in.widthStep()];
+        for (outP.y = 0; outP.y < out.height(); ++outP.y)
         {
-            outStr[outP.x] = sampler(inStrA[inPx], inStrA[inPx + 1],
-                                     inStrB[inPx], inStrB[inPx + 1]);
-            inPx += 2;
+            for (inPx = outP.x = 0; outP.x < out.width(); ++outP.x)
+            {
+                outStr[outP.x] = sampler(inStrA[inPx], inStrA[inPx + 1],
+                                         inStrB[inPx], inStrB[inPx + 1]);
+                inPx += 2;
+            }
+            outStr = &outStr[out.widthStep()];
+            inStrA = &inStrB[in.widthStep()];
+            inStrB = &inStrA[in.widthStep()];
+        }
+    }
+}
+
+template <typename SumType, typename Type>
+void halfSampleGauss5(const Image<Type> & out, const ImageRef<Type> & in, int beginRow, int endRow)
+{
+    assert((in.size() / 2) == out.size());
+    if (endRow < 0)
+        endRow = out.height();
+    assert((beginRow >= 0) && (endRow <= out.height()));
+    if constexpr (std::is_same<Type, uchar>::value && std::is_same<SumType, int>::value)
+    {
+        simd::halfSampleGauss5_u(out.data(), out.widthStep(), in.data(), in.widthStep(),
+                                 in.width(), in.height(), beginRow, endRow);
+    }
+    else
+    {
+        using Sum = typename Cast<Type, SumType>::Type;
+        if ((in.width() < 2) || (beginRow >= endRow))
+            return;
+        int inWidth = in.width();
+        // Sums of columns with 2 replicated elements on both sides
+        std::vector<Sum> rowBuffer(static_cast<size_t>(inWidth + 4));
+        Sum * row = &rowBuffer[2];
+        const Type * s[5];
+        for (int y = beginRow; y < endRow; ++y)
+        {
+            for (int i = 0; i < 5; ++i)
+                s[i] = in.pointer(0, std::min(std::max(y * 2 + i - 2, 0), in.height() - 1));
+            for (int x = 0; x < inWidth; ++x)
+            {
+                row[x] = cast<SumType>(s[0][x]) + cast<SumType>(s[4][x]) +
+                         (cast<SumType>(s[1][x]) + cast<SumType>(s[3][x])) * 4 +
+                         cast<SumType>(s[2][x]) * 6;
+            }
+            row[-2] = row[-1] = row[0];
+            row[inWidth] = row[inWidth + 1] = row[inWidth - 1];
+            Type * outStr = out.pointer(0, y);
+            for (int x = 0; x < out.width(); ++x)
+            {
+                const Sum * r = &row[x * 2];
+                outStr[x] = cast<typename BaseElement<Type>::Type>(
+                            (r[-2] + r[2] + (r[-1] + r[1]) * 4 + r[0] * 6) * (1.0f / 256.0f));
+            }
         }
-        outStr = &outStr[out.widthStep()];
-        inStrA = &inStrB[in.widthStep()];
-        inStrB = &inStrA[in.widthStep()];
     }
 }
 
@@ -511,22 +753,24 @@ template <typename SumType, typename Type>
 Image<typename Cast<Type, SumType>::Type> computeIntegralImage(const ImageRef<Type> & image)
 {
     Image<typename Cast<Type, SumType>::Type> integral(image.size());
-    computeIntegralImage(integral, image);
+    computeIntegralImage<SumType, Type>(integral, image);
     return integral;
 }
 
 template <typename OutType, typename Type, typename FType>
 OutType interpolate(const ImageRef<Type> & image, FType x, FType y)
 {
+    using BaseOutType = typename BaseElement<OutType>::Type;
+
     int ix = cast<int>(std::floor(x)), iy = cast<int>(std::floor(y));
     FType dx = x - ix, dy = y - iy;
     FType idx = cast<FType>(1) - dx, idy = cast<FType>(1) - dy;
     const Type * strA = image.pointer(ix, iy);
     const Type * strB = &strA[image.widthStep()];
-    return cast<BaseElement<OutType>::Type>(strA[0]) * (idx * idy) +
-           cast<BaseElement<OutType>::Type>(strA[1]) * (dx * idy) +
-           cast<BaseElement<OutType>::Type>(strB[0]) * (idx * dy) +
-           cast<BaseElement<OutType>::Type>(strB[1]) * (dx * dy);
+    return cast<BaseOutType>(strA[0]) * (idx * idy) +
+           cast<BaseOutType>(strA[1]) * (dx * idy) +
+           cast<BaseOutType>(strB[0]) * (idx * dy) +
+           cast<BaseOutType>(strB[1]) * (dx * dy);
 }
 
 template <typename OutType, typename Type, typename FType>
@@ -545,6 +789,62 @@ OutType interpolate(const ImageRef<Type> & image, const Point2<FType> & point)
            cast<BaseOutType>(strB[1]) * (dx * dy);
 }
 
+void interpolatePoints(float * out, const ImageRef<uchar> & image, const Point2f * points, int numberPoints)
+{
+    static_assert(sizeof(Point2f) == sizeof(float) * 2, "Points are passed as interleaved coordinates");
+    assert(std::all_of(points, points + numberPoints, [&] (const Point2f & p) {
+        return (p.x >= 0.0f) && (p.y >= 0.0f) && (p.x < (image.width() - 1)) && (p.y < (image.height() - 1));
+    }));
+
+    simd::bilinearPoints_f(out, reinterpret_cast<const float*>(points), numberPoints,
+                           image.data(), image.widthStep(), image.width(), image.height());
+}
+
+std::vector<float> interpolatePoints(const ImageRef<uchar> & image, const std::vector<Point2f> & points)
+{
+    std::vector<float> values(points.size());
+    interpolatePoints(values.data(), image, points.data(), static_cast<int>(points.size()));
+    return values;
+}
+
+/// Calls function(outRow, inPointer, subPixel) for every patch
+template <typename Type, typename Function>
+static void _forEachPatch(const Image<Type> & out, int patchHeight, const ImageRef<uchar> & image,
+                          const std::vector<Point2f> & beginPoints, Function && function)
+{
+    assert((patchHeight > 0) && (out.height() == (patchHeight * static_cast<int>(beginPoints.size()))));
+    for (std::size_t i = 0; i < beginPoints.size(); ++i)
+    {
+        const Point2f & beginPoint = beginPoints[i];
+        Point2i beginPoint_i(cast<int>(std::floor(beginPoint.x)), cast<int>(std::floor(beginPoint.y)));
+        assert((beginPoint_i.x >= 0) && (beginPoint_i.y >= 0));
+        assert(((beginPoint_i.x + out.width() + 1) <= image.width()) &&
+               ((beginPoint_i.y + patchHeight + 1) <= image.height()));
+        function(out.pointer(0, static_cast<int>(i) * patchHeight), image.pointer(beginPoint_i),
+                 Point2f(beginPoint.x - beginPoint_i.x, beginPoint.y - beginPoint_i.y));
+    }
+}
+
+void interpolatePatches(const Image<uchar> & out, int patchHeight,
+                        const ImageRef<uchar> & image, const std::vector<Point2f> & beginPoints)
+{
+    _forEachPatch(out, patchHeight, image, beginPoints,
+                  [&] (uchar * outStr, const uchar * imageStr, const Point2f & subPixel) {
+        simd::bilinearPatch_u(outStr, out.widthStep(), out.width(), patchHeight,
+                              imageStr, image.widthStep(), subPixel.x, subPixel.y);
+    });
+}
+
+void interpolatePatches(const Image<float> & out, int patchHeight,
+                        const ImageRef<uchar> & image, const std::vector<Point2f> & beginPoints)
+{
+    _forEachPatch(out, patchHeight, image, beginPoints,
+                  [&] (float * outStr, const uchar * imageStr, const Point2f & subPixel) {
+        simd::bilinearPatch_f(outStr, out.widthStep(), out.width(), patchHeight,
+                              imageStr, image.widthStep(), subPixel.x, subPixel.y);
+    });
+}
+
 void sobel(Image<int> & out, const ImageRef<uchar> & in)
 {
     assert(in.size() == out.size());
@@ -590,31 +890,135 @@ Image<int> sobel(const ImageRef<uchar> & in)
     return r;
 }
 
+void centralDifferences(const Image<Point2<short>> & out, const ImageRef<uchar> & in)
+{
+    gradients(out, in, simd::GradientOperator::CentralDifferences);
+}
+
+Image<Point2<short>> centralDifferences(const ImageRef<uchar> & in)
+{
+    Image<Point2<short>> r(in.size());
+    centralDifferences(r, in);
+    return r;
+}
+
+void gradients(const Image<Point2<short>> & out, const ImageRef<uchar> & in, simd::GradientOperator gradientOperator)
+{
+    static_assert(sizeof(Point2<short>) == sizeof(short) * 2, "Gradients must be stored as pairs of short");
+    assert(in.size() == out.size());
+
+    simd::gradients_s(reinterpret_cast<short*>(out.data()), out.widthStep(),
+                      in.data(), in.widthStep(), in.width(), in.height(),
+                      gradientOperator, 0, in.height());
+}
+
+void structureTensor(const Image<int> & outXX, const Image<int> & outXY, const Image<int> & outYY,
+                     const ImageRef<uchar> & in, simd::GradientOperator gradientOperator)
+{
+    assert((outXX.size() == in.size()) && (outXY.size() == in.size()) && (outYY.size() == in.size()));
+    assert((outXX.widthStep() == outXY.widthStep()) && (outXX.widthStep() == outYY.widthStep()));
+
+    simd::structureTensor_i(outXX.data(), outXY.data(), outYY.data(), outXX.widthStep(),
+                            in.data(), in.widthStep(), in.width(), in.height(),
+                            gradientOperator, 0, in.height());
+}
+
+void computeIntegralImages(const Image<int> & outIntegral, const Image<std::int64_t> & outSquaredIntegral,
+                           const ImageRef<uchar> & in)
+{
+    assert(outIntegral.size() == in.size());
+    assert(outSquaredIntegral.isNull() || (outSquaredIntegral.size() == in.size()));
+
+    simd::integralBand_u(outIntegral.data(), outIntegral.widthStep(),
+                         outSquaredIntegral.data(), outSquaredIntegral.widthStep(),
+                         in.data(), in.widthStep(), in.width(), 0, in.height());
+}
+
+void computeIntegralImages(const Image<int> & outIntegral, const Image<std::int64_t> & outSquaredIntegral,
+                           const ImageRef<uchar> & in, WorkerPool & workerPool)
+{
+    assert(outIntegral.size() == in.size());
+    assert(outSquaredIntegral.isNull() || (outSquaredIntegral.size() == in.size()));
+
+    // calling thread takes one of bands
+    int numberBands = std::min(workerPool.size() + 1, in.height() / 16);
+    if (numberBands <= 1)
+    {
+        computeIntegralImages(outIntegral, outSquaredIntegral, in);
+        return;
+    }
+    int width = in.width();
+    std::int64_t * squaredSum = outSquaredIntegral.data();
+    std::vector<int> bandBegins(static_cast<std::size_t>(numberBands + 1));
+    for (int i = 0; i <= numberBands; ++i)
+        bandBegins[i] = (in.height() * i) / numberBands;
+
+    workerPool.parallelFor(0, numberBands, [&] (int beginBand, int endBand) {
+        for (int i = beginBand; i < endBand; ++i)
+            simd::integralBand_u(outIntegral.data(), outIntegral.widthStep(),
+                                 squaredSum, outSquaredIntegral.widthStep(),
+                                 in.data(), in.widthStep(), width, bandBegins[i], bandBegins[i + 1]);
+    });
+
+    // Sums above band are the sum above previous band plus the last row of previous band
+    std::vector<int> carries(static_cast<std::size_t>((numberBands - 1) * width));
+    std::vector<std::int64_t> squaredCarries((squaredSum != nullptr) ? carries.size() : 0);
+    for (int i = 1; i < numberBands; ++i)
+    {
+        int * carry = &carries[(i - 1) * width];
+        const int * lastRow = &outIntegral.data()[(bandBegins[i] - 1) * outIntegral.widthStep()];
+        if (i == 1)
+            std::copy(lastRow, lastRow + width, carry);
+        else
+            std::transform(lastRow, lastRow + width, carry - width, carry, std::plus<int>());
+        if (squaredSum == nullptr)
+            continue;
+        std::int64_t * squaredCarry = &squaredCarries[(i - 1) * width];
+        const std::int64_t * squaredLastRow = &squaredSum[(bandBegins[i] - 1) * outSquaredIntegral.widthStep()];
+        if (i == 1)
+            std::copy(squaredLastRow, squaredLastRow + width, squaredCarry);
+        else
+            std::transform(squaredLastRow, squaredLastRow + width, squaredCarry - width, squaredCarry,
+                           std::plus<std::int64_t>());
+    }
+
+    workerPool.parallelFor(1, numberBands, [&] (int beginBand, int endBand) {
+        for (int i = beginBand; i < endBand; ++i)
+            simd::addRowToBand_i(outIntegral.data(), outIntegral.widthStep(),
+                                 squaredSum, outSquaredIntegral.widthStep(),
+                                 &carries[(i - 1) * width],
+                                 (squaredSum != nullptr) ? &squaredCarries[(i - 1) * width] : nullptr,
+                                 width, bandBegins[i], bandBegins[i + 1]);
+    });
+}
+
 void erode(Image<uchar> & out, const ImageRef<int> & integral, int size, float k)
 {
     assert(out.size() == integral.size());
-    assert((out.width() > size * 2) && (out.height() > size * 2));
+    assert((out.width() > (size * 2 + 1)) && (out.height() > (size * 2 + 1)));
 
+    // Sums of integral image include own row and column, so window needs row and column before it
+    const int begin = size + 1;
     // fill borders
-    Image<uchar>(out, Point2i(0, 0), Point2i(out.width(), size)).fill(0);
+    Image<uchar>(out, Point2i(0, 0), Point2i(out.width(), begin)).fill(0);
     Image<uchar>(out, Point2i(0, out.height() - size), Point2i(out.width(), size)).fill(0);
-    Image<uchar>(out, Point2i(0, size), Point2i(size, out.height() - 2 * size)).fill(0);
-    Image<uchar>(out, Point2i(out.width() - size, size), Point2i(size, out.height() - 2 * size)).fill(0);
+    Image<uchar>(out, Point2i(0, begin), Point2i(begin, out.height() - begin - size)).fill(0);
+    Image<uchar>(out, Point2i(out.width() - size, begin), Point2i(size, out.height() - begin - size)).fill(0);
 
     const int minCountPixels = static_cast<int>((size * 2 + 1) * (size * 2 + 1) * k);
     uchar * strOut;
     Point2i p;
     int w = integral.width() - size;
     int h = integral.height() - size;
-    for (p.y = size; p.y < h; ++p.y)
+    for (p.y = begin; p.y < h; ++p.y)
     {
         strOut = &out.data()[p.y * out.widthStep()];
-        const int * strA = &integral.data()[(p.y - size) * integral.widthStep()];
+        const int * strA = &integral.data()[(p.y - begin) * integral.widthStep()];
         const int * strB = &integral.data()[(p.y + size) * integral.widthStep()];
-        for (p.x = size; p.x < w; ++p.x)
+        for (p.x = begin; p.x < w; ++p.x)
         {
-            strOut[p.x] = ((strB[p.x + size] + strA[p.x - size] -
-                    (strB[p.x - size] + strA[p.x + size])) > minCountPixels);
+            int countPixels = (strB[p.x + size] + strA[p.x - begin]) - (strB[p.x - begin] + strA[p.x + size]);
+            strOut[p.x] = (countPixels > minCountPixels) ? 255 : 0;
         }
     }
 }
@@ -622,10 +1026,53 @@ void erode(Image<uchar> & out, const ImageRef<int> & integral, int size, float k
 Image<uchar> erode(const ImageRef<int> & integral, int size, float k)
 {
     Image<uchar> r(integral.size());
-    erode(integral, size, k);
+    erode(r, integral, size, k);
     return r;
 }
 
+void thresholdLocalMean(const Image<uchar> & out, const ImageRef<uchar> & in, const ImageRef<int> & integral,
+                        int halfSize, float delta, bool inverse)
+{
+    assert((out.size() == in.size()) && (integral.size() == in.size()));
+    simd::thresholdMean_u(out.data(), out.widthStep(), in.data(), in.widthStep(),
+                          integral.data(), integral.widthStep(), in.width(), in.height(),
+                          halfSize, delta, inverse, 0, in.height());
+}
+
+void thresholdLocalMean(const Image<uchar> & out, const ImageRef<uchar> & in, const ImageRef<int> & integral,
+                        WorkerPool & workerPool, int halfSize, float delta, bool inverse)
+{
+    assert((out.size() == in.size()) && (integral.size() == in.size()));
+    workerPool.parallelFor(0, in.height(), [&] (int beginRow, int endRow) {
+        simd::thresholdMean_u(out.data(), out.widthStep(), in.data(), in.widthStep(),
+                              integral.data(), integral.widthStep(), in.width(), in.height(),
+                              halfSize, delta, inverse, beginRow, endRow);
+    });
+}
+
+void thresholdSauvola(const Image<uchar> & out, const ImageRef<uchar> & in,
+                      const ImageRef<int> & integral, const ImageRef<std::int64_t> & squaredIntegral,
+                      int halfSize, float k, float r, bool inverse)
+{
+    assert((out.size() == in.size()) && (integral.size() == in.size()) && (squaredIntegral.size() == in.size()));
+    simd::thresholdSauvola_u(out.data(), out.widthStep(), in.data(), in.widthStep(),
+                             integral.data(), integral.widthStep(), squaredIntegral.data(), squaredIntegral.widthStep(),
+                             in.width(), in.height(), halfSize, k, r, inverse, 0, in.height());
+}
+
+void thresholdSauvola(const Image<uchar> & out, const ImageRef<uchar> & in,
+                      const ImageRef<int> & integral, const ImageRef<std::int64_t> & squaredIntegral,
+                      WorkerPool & workerPool, int halfSize, float k, float r, bool inverse)
+{
+    assert((out.size() == in.size()) && (integral.size() == in.size()) && (squaredIntegral.size() == in.size()));
+    workerPool.parallelFor(0, in.height(), [&] (int beginRow, int endRow) {
+        simd::thresholdSauvola_u(out.data(), out.widthStep(), in.data(), in.widthStep(),
+                                 integral.data(), integral.widthStep(),
+                                 squaredIntegral.data(), squaredIntegral.widthStep(),
+                                 in.width(), in.height(), halfSize, k, r, inverse, beginRow, endRow);
+    });
+}
+
 template <typename RealSumType, typename Type, typename FType>
 void gaussianBlurX(Image<Type> & out, const ImageRef<Type> & in, int halfSizeBlur, FType sigma)
 {
@@ -782,17 +1229,37 @@ void gaussianBlur(Image<Type> & out, const ImageRef<Type> & in, int halfSizeBlur
 
 void gaussianBlurX(Image<uchar> & out, const ImageRef<uchar> & in, int halfSizeBlur, float sigma)
 {
-    gaussianBlurX<float, uchar, float>(out, in, halfSizeBlur, sigma);
+    assert(out.size() == in.size());
+    assert(!in.equalsSources(out));
+
+    std::shared_ptr<const simd::GaussianKernel_u> kernel = simd::gaussianKernel_u(halfSizeBlur, sigma);
+    simd::gaussianBlurX_u(out.data(), out.widthStep(), in.data(), in.widthStep(), in.width(), in.height(),
+                          *kernel, 0, in.height());
 }
 
 void gaussianBlurY(Image<uchar> & out, const ImageRef<uchar> & in, int halfSizeBlur, float sigma)
 {
-    gaussianBlurY<float, uchar, float>(out, in, halfSizeBlur, sigma);
+    assert(out.size() == in.size());
+    assert(!in.equalsSources(out));
+
+    std::shared_ptr<const simd::GaussianKernel_u> kernel = simd::gaussianKernel_u(halfSizeBlur, sigma);
+    simd::gaussianBlurY_u(out.data(), out.widthStep(), in.data(), in.widthStep(), in.width(), in.height(),
+                          *kernel, 0, in.height());
 }
 
 void gaussianBlur(Image<uchar> & out, const ImageRef<uchar> & in, int halfSizeBlur, float sigma)
 {
-    gaussianBlur<float, uchar, float>(out, in, halfSizeBlur, sigma);
+    assert(out.size() == in.size());
+
+    // Strips read rows of in image around already written rows of out image, so in place blur needs a copy
+    if (in.equalsSources(out))
+    {
+        gaussianBlur(out, in.copy(), halfSizeBlur, sigma);
+        return;
+    }
+    std::shared_ptr<const simd::GaussianKernel_u> kernel = simd::gaussianKernel_u(halfSizeBlur, sigma);
+    simd::gaussianBlur_u(out.data(), out.widthStep(), in.data(), in.widthStep(), in.width(), in.height(),
+                         *kernel, 0, in.height());
 }
 
 template <typename T, typename S, typename P>
@@ -866,6 +1333,43 @@ int transform2x2(Image<T> & out, const ImageRef<S> & in, const Eigen::Matrix<P,
     return count;
 }
 
+void warpAffine(const Image<uchar> & out, const ImageRef<uchar> & in,
+                const Eigen::Matrix<float, 2, 3> & transform, uchar borderValue)
+{
+    Eigen::Matrix<float, 2, 3, Eigen::RowMajor> matrix = transform;
+    simd::warpAffine_u(out.data(), out.widthStep(), out.width(), in.data(), in.widthStep(), in.width(), in.height(),
+                       matrix.data(), borderValue, 0, out.height());
+}
+
+void warpAffine(const Image<uchar> & out, const ImageRef<uchar> & in,
+                const Eigen::Matrix<float, 2, 3> & transform, WorkerPool & workerPool, uchar borderValue)
+{
+    Eigen::Matrix<float, 2, 3, Eigen::RowMajor> matrix = transform;
+    workerPool.parallelFor(0, out.height(), [&] (int beginRow, int endRow) {
+        simd::warpAffine_u(out.data(), out.widthStep(), out.width(), in.data(), in.widthStep(), in.width(), in.height(),
+                           matrix.data(), borderValue, beginRow, endRow);
+    });
+}
+
+void warpPerspective(const Image<uchar> & out, const ImageRef<uchar> & in,
+                     const Eigen::Matrix3f & homography, uchar borderValue)
+{
+    Eigen::Matrix<float, 3, 3, Eigen::RowMajor> matrix = homography;
+    simd::warpPerspective_u(out.data(), out.widthStep(), out.width(), in.data(), in.widthStep(), in.width(), in.height(),
+                            matrix.data(), borderValue, 0, out.height());
+}
+
+void warpPerspective(const Image<uchar> & out, const ImageRef<uchar> & in,
+                     const Eigen::Matrix3f & homography, WorkerPool & workerPool, uchar borderValue)
+{
+    Eigen::Matrix<float, 3, 3, Eigen::RowMajor> matrix = homography;
+    workerPool.parallelFor(0, out.height(), [&] (int beginRow, int endRow) {
+        simd::warpPerspective_u(out.data(), out.widthStep(), out.width(),
+                                in.data(), in.widthStep(), in.width(), in.height(),
+                                matrix.data(), borderValue, beginRow, endRow);
+    });
+}
+
 template <typename Type>
 void normalize(Image<Type> & inout)
 {
@@ -269,6 +269,12 @@ int ImageRef<Type>::numberReferences() const
                 this->m_count_references->load() : (-1);
 }
 
+template < typename Type >
+ImageView<Type> ImageRef<Type>::view() const
+{
+    return ImageView<Type>(this->m_size, this->m_data, this->m_widthStep);
+}
+
 template < typename Type >
 bool ImageRef<Type>::pointInImageWithBorder(const Point2i & point, int border) const
 {
@@ -302,6 +308,7 @@ void ImageRef<Type>::swap(ImageRef<Type> & image)
     std::swap(this->m_sourceData, image.m_sourceData);
     std::swap(this->m_data, image.m_data);
     std::swap(this->m_count_references, image.m_count_references);
+    std::swap(this->m_deleter, image.m_deleter);
     std::swap(this->m_size, image.m_size);
     std::swap(this->m_widthStep, image.m_widthStep);
 }
@@ -352,7 +359,15 @@ void ImageRef<Type>::_remove()
 #elif defined(__ANDROID__)
         free(this->m_data);
 #endif*/
-        delete [] this->m_sourceData;
+        if (this->m_deleter != nullptr)
+        {
+            (*this->m_deleter)();
+            delete this->m_deleter;
+        }
+        else
+        {
+            delete [] this->m_sourceData;
+        }
         delete this->m_count_references;
     }
     else
@@ -362,6 +377,7 @@ void ImageRef<Type>::_remove()
     this->m_sourceData = nullptr;
     this->m_data = nullptr;
     this->m_count_references = nullptr;
+    this->m_deleter = nullptr;
 }
 
 template < typename Type >
@@ -388,10 +404,12 @@ void ImageRef<Type>::_copyRef(const ImageRef<Type> & image)
     {
         ++(*image.m_count_references);
         this->m_count_references = image.m_count_references;
+        this->m_deleter = image.m_deleter;
     }
     else
     {
         this->m_count_references = nullptr;
+        this->m_deleter = nullptr;
     }
 }
 
@@ -408,6 +426,8 @@ void ImageRef<Type>::_moveRef(ImageRef<Type> && image)
     image.m_size.set(0, 0);
     this->m_count_references = image.m_count_references;
     image.m_count_references = nullptr;
+    this->m_deleter = image.m_deleter;
+    image.m_deleter = nullptr;
 }
 
 template < typename Type >
@@ -425,10 +445,12 @@ void ImageRef<Type>::_copyRef(const ImageRef<Type> & image, const Point2i & offs
     {
         ++(*image.m_count_references);
         this->m_count_references = image.m_count_references;
+        this->m_deleter = image.m_deleter;
     }
     else
     {
         this->m_count_references = nullptr;
+        this->m_deleter = nullptr;
     }
 }
 
@@ -444,11 +466,13 @@ void ImageRef<Type>::_moveRef(ImageRef<Type> && image, const Point2i & offset, c
     this->m_sourceData = image.m_sourceData;
     this->m_widthStep = image.m_widthStep;
     this->m_count_references = image.m_count_references;
+    this->m_deleter = image.m_deleter;
     image.m_sourceData = nullptr;
     image.m_widthStep = 0;
     image.m_data = nullptr;
     image.m_size.set(0, 0);
     image.m_count_references = nullptr;
+    image.m_deleter = nullptr;
 }
 
 template < typename Type >
@@ -457,6 +481,7 @@ ConstImage<Type>::ConstImage()
     this->m_sourceData = nullptr;
     this->m_data = nullptr;
     this->m_count_references = nullptr;
+    this->m_deleter = nullptr;
     this->m_size.setZero();
     this->m_widthStep = 0;
 }
@@ -504,6 +529,7 @@ ConstImage<Type>::ConstImage(const Size2i & size, const Type * data, bool autoDe
     this->m_widthStep = size.x;
     this->m_sourceData = this->m_data = const_cast<Type*>(data);
     this->m_count_references = (autoDeleting) ? new std::atomic_int(1) : nullptr;
+    this->m_deleter = nullptr;
 }
 
 template < typename Type >
@@ -513,6 +539,7 @@ ConstImage<Type>::ConstImage(int width, int height, const Type * data, bool auto
     this->m_widthStep = width;
     this->m_sourceData = this->m_data = const_cast<Type*>(data);
     this->m_count_references = (autoDeleting) ? new std::atomic_int(1) : nullptr;
+    this->m_deleter = nullptr;
 }
 
 template < typename Type >
@@ -522,6 +549,7 @@ ConstImage<Type>::ConstImage(const Size2i & size, const Type * data, int widthSt
     this->m_widthStep = widthStep;
     this->m_sourceData = this->m_data = const_cast<Type*>(data);
     this->m_count_references = (autoDeleting) ? new std::atomic_int(1) : nullptr;
+    this->m_deleter = nullptr;
 }
 
 template < typename Type >
@@ -531,6 +559,18 @@ ConstImage<Type>::ConstImage(int width, int height, const Type * data, int width
     this->m_widthStep = widthStep;
     this->m_sourceData = this->m_data = const_cast<Type*>(data);
     this->m_count_references = (autoDeleting) ? new std::atomic_int(1) : nullptr;
+    this->m_deleter = nullptr;
+}
+
+template < typename Type >
+ConstImage<Type>::ConstImage(const Size2i & size, const Type * data, int widthStep,
+                             const std::function<void()> & deleter)
+{
+    this->m_size = size;
+    this->m_widthStep = widthStep;
+    this->m_sourceData = this->m_data = const_cast<Type*>(data);
+    this->m_count_references = new std::atomic_int(1);
+    this->m_deleter = new std::function<void()>(deleter);
 }
 
 template < typename Type >
@@ -586,6 +626,7 @@ void ConstImage<Type>::release()
     this->m_sourceData = nullptr;
     this->m_data = nullptr;
     this->m_count_references = nullptr;
+    this->m_deleter = nullptr;
     this->m_size.set(0, 0);
     this->m_widthStep = 0;
 }
@@ -596,6 +637,7 @@ Image<Type>::Image()
     this->m_sourceData = nullptr;
     this->m_data = nullptr;
     this->m_count_references = nullptr;
+    this->m_deleter = nullptr;
     this->m_size.setZero();
     this->m_widthStep = 0;
 }
@@ -631,6 +673,7 @@ Image<Type>::Image(const Size2i & size)
     this->m_widthStep = size.x;
     this->_allocData();
     this->m_count_references = new std::atomic_int(1);
+    this->m_deleter = nullptr;
 }
 
 template <typename Type>
@@ -640,6 +683,7 @@ Image<Type>::Image(int width, int height)
     this->m_widthStep = width;
     this->_allocData();
     this->m_count_references = new std::atomic_int(1);
+    this->m_deleter = nullptr;
 }
 
 template <typename Type>
@@ -649,6 +693,7 @@ Image<Type>::Image(const Size2i & size, Type * data, bool autoDeleting)
     this->m_widthStep = size.x;
     this->m_sourceData = this->m_data = data;
     this->m_count_references = autoDeleting ? new std::atomic_int(1) : nullptr;
+    this->m_deleter = nullptr;
 }
 
 template <typename Type>
@@ -658,6 +703,7 @@ Image<Type>::Image(int width, int height, Type * data, bool autoDeleting)
     this->m_widthStep = width;
     this->m_sourceData = this->m_data = data;
     this->m_count_references = autoDeleting ? new std::atomic_int(1) : nullptr;
+    this->m_deleter = nullptr;
 }
 
 template <typename Type>
@@ -667,6 +713,7 @@ Image<Type>::Image(const Size2i & size, Type * data, int widthStep, bool autoDel
     this->m_widthStep = widthStep;
     this->m_sourceData = this->m_data = data;
     this->m_count_references = autoDeleting ? new std::atomic_int(1) : nullptr;
+    this->m_deleter = nullptr;
 }
 
 template <typename Type>
@@ -676,6 +723,17 @@ Image<Type>::Image(int width, int height, Type * data, int widthStep, bool autoD
     this->m_widthStep = widthStep;
     this->m_sourceData = this->m_data = data;
     this->m_count_references = autoDeleting ? new std::atomic_int(1) : nullptr;
+    this->m_deleter = nullptr;
+}
+
+template <typename Type>
+Image<Type>::Image(const Size2i & size, Type * data, int widthStep, const std::function<void()> & deleter)
+{
+    this->m_size = size;
+    this->m_widthStep = widthStep;
+    this->m_sourceData = this->m_data = data;
+    this->m_count_references = new std::atomic_int(1);
+    this->m_deleter = new std::function<void()>(deleter);
 }
 
 template <typename Type>
@@ -799,13 +857,11 @@ Image<Type> ImageRef<Type>::copy() const
 }
 
 template <typename Type>
-template <typename ConvertType>
-void ImageRef<Type>::convertTo(const Image<ConvertType> & out,
-                               const std::function<ConvertType(const Point2i & pos, const Type & a)> &
-                               convertFunction) const
+template <typename ConvertType, typename ConvertFunction>
+void ImageRef<Type>::convertTo(const Image<ConvertType> & out, ConvertFunction && convertFunction) const
 {
     assert(this->m_size == out.size());
-    Type * str = this->m_data;
+    const Type * str = this->m_data;
     ConvertType * outStr = out.data();
     Point2i p;
     for (p.y = 0; p.y < this->m_size.y; ++p.y)
@@ -820,17 +876,17 @@ void ImageRef<Type>::convertTo(const Image<ConvertType> & out,
 }
 
 template <typename Type>
-template <typename ConvertType>
-Image<ConvertType> ImageRef<Type>::convert(const std::function<ConvertType(const Point2i & pos, const Type & a)> &
-                                           convertFunction) const
+template <typename ConvertType, typename ConvertFunction>
+Image<ConvertType> ImageRef<Type>::convert(ConvertFunction && convertFunction) const
 {
     Image<ConvertType> image(this->m_size);
-    convertTo<ConvertType>(image, convertFunction);
+    convertTo<ConvertType>(image, std::forward<ConvertFunction>(convertFunction));
     return image;
 }
 
 template <typename Type>
-void ImageRef<Type>::for_each(const std::function<void(const Point2i & pos, const Type & val)> & func) const
+template <typename Function>
+void ImageRef<Type>::for_each(Function && func) const
 {
     const Type * str = this->m_data;
     Point2i p;
@@ -845,7 +901,60 @@ void ImageRef<Type>::for_each(const std::function<void(const Point2i & pos, cons
 }
 
 template <typename Type>
-void Image<Type>::for_each(const std::function<void(const Point2i & pos, Type & val)> & func) const
+template <typename Function>
+void ImageRef<Type>::parallel_for_each(WorkerPool & pool, Function && func) const
+{
+    const Type * data = this->m_data;
+    int widthStep = this->m_widthStep;
+    int width = this->m_size.x;
+    pool.parallelFor(0, this->m_size.y, [&func, data, widthStep, width] (int beginRow, int endRow) {
+        Point2i p;
+        for (p.y = beginRow; p.y < endRow; ++p.y)
+        {
+            const Type * str = &data[p.y * widthStep];
+            for (p.x = 0; p.x < width; ++p.x)
+            {
+                func(p, str[p.x]);
+            }
+        }
+    });
+}
+
+template <typename Type>
+template <typename ConvertType, typename ConvertFunction>
+void ImageRef<Type>::parallel_convertTo(WorkerPool & pool, const Image<ConvertType> & out,
+                                        ConvertFunction && convertFunction) const
+{
+    assert(this->m_size == out.size());
+    const Type * data = this->m_data;
+    int widthStep = this->m_widthStep;
+    int width = this->m_size.x;
+    pool.parallelFor(0, this->m_size.y, [&convertFunction, &out, data, widthStep, width] (int beginRow, int endRow) {
+        Point2i p;
+        for (p.y = beginRow; p.y < endRow; ++p.y)
+        {
+            const Type * str = &data[p.y * widthStep];
+            ConvertType * outStr = &out.data()[p.y * out.widthStep()];
+            for (p.x = 0; p.x < width; ++p.x)
+            {
+                outStr[p.x] = convertFunction(p, str[p.x]);
+            }
+        }
+    });
+}
+
+template <typename Type>
+template <typename ConvertType, typename ConvertFunction>
+Image<ConvertType> ImageRef<Type>::parallel_convert(WorkerPool & pool, ConvertFunction && convertFunction) const
+{
+    Image<ConvertType> image(this->m_size);
+    parallel_convertTo<ConvertType>(pool, image, std::forward<ConvertFunction>(convertFunction));
+    return image;
+}
+
+template <typename Type>
+template <typename Function>
+void Image<Type>::for_each(Function && func) const
 {
     Type * str = this->m_data;
     Point2i p;
@@ -859,6 +968,26 @@ void Image<Type>::for_each(const std::function<void(const Point2i & pos, Type &
     }
 }
 
+template <typename Type>
+template <typename Function>
+void Image<Type>::parallel_for_each(WorkerPool & pool, Function && func) const
+{
+    Type * data = this->m_data;
+    int widthStep = this->m_widthStep;
+    int width = this->m_size.x;
+    pool.parallelFor(0, this->m_size.y, [&func, data, widthStep, width] (int beginRow, int endRow) {
+        Point2i p;
+        for (p.y = beginRow; p.y < endRow; ++p.y)
+        {
+            Type * str = &data[p.y * widthStep];
+            for (p.x = 0; p.x < width; ++p.x)
+            {
+                func(p, str[p.x]);
+            }
+        }
+    });
+}
+
 template < typename Type >
 void Image<Type>::release()
 {
@@ -866,10 +995,160 @@ void Image<Type>::release()
     this->m_sourceData = nullptr;
     this->m_data = nullptr;
     this->m_count_references = nullptr;
+    this->m_deleter = nullptr;
     this->m_size.set(0, 0);
     this->m_widthStep = 0;
 }
 
+template < typename Type >
+ImageView<Type>::ImageView():
+    m_data(nullptr),
+    m_size(0, 0),
+    m_widthStep(0)
+{}
+
+template < typename Type >
+ImageView<Type>::ImageView(const ImageRef<Type> & image):
+    m_data(image.data()),
+    m_size(image.size()),
+    m_widthStep(image.widthStep())
+{}
+
+template < typename Type >
+ImageView<Type>::ImageView(const ImageView<Type> & view, const Point2i & offset, const Size2i & size)
+{
+    assert((offset.x >= 0) && (offset.y >= 0));
+    assert((view.m_size.x >= (offset.x + size.x)) && (view.m_size.y >= (offset.y + size.y)));
+    this->m_data = &view.m_data[offset.y * view.m_widthStep + offset.x];
+    this->m_size = size;
+    this->m_widthStep = view.m_widthStep;
+}
+
+template < typename Type >
+ImageView<Type>::ImageView(const Size2i & size, const Type * data, int widthStep):
+    m_data(data),
+    m_size(size),
+    m_widthStep(widthStep)
+{}
+
+template < typename Type >
+ImageView<Type>::ImageView(int width, int height, const Type * data, int widthStep):
+    m_data(data),
+    m_size(width, height),
+    m_widthStep(widthStep)
+{}
+
+template < typename Type >
+bool ImageView<Type>::isNull() const
+{
+    return (this->m_data == nullptr);
+}
+
+template < typename Type >
+bool ImageView<Type>::isContinuous() const
+{
+    return (this->m_size.x == this->m_widthStep);
+}
+
+template < typename Type >
+const Type * ImageView<Type>::data() const
+{
+    return this->m_data;
+}
+
+template < typename Type >
+const Type & ImageView<Type>::operator () (int x, int y) const
+{
+#if defined(QT_DEBUG)
+    assert(this->pointInImage(x, y));
+#endif
+    return this->m_data[y * this->m_widthStep + x];
+}
+
+template < typename Type >
+const Type & ImageView<Type>::operator () (const Point2i & point) const
+{
+#if defined(QT_DEBUG)
+    assert(this->pointInImage(point));
+#endif
+    return this->m_data[point.y * this->m_widthStep + point.x];
+}
+
+template < typename Type >
+const Type * ImageView<Type>::pointer(int x, int y) const
+{
+#if defined(QT_DEBUG)
+    assert(this->pointInImage(x, y));
+#endif
+    return &this->m_data[y * this->m_widthStep + x];
+}
+
+template < typename Type >
+const Type * ImageView<Type>::pointer(const Point2i & point) const
+{
+#if defined(QT_DEBUG)
+    assert(this->pointInImage(point));
+#endif
+    return &this->m_data[point.y * this->m_widthStep + point.x];
+}
+
+template < typename Type >
+int ImageView<Type>::area() const
+{
+    return this->m_size.y * this->m_size.x;
+}
+
+template < typename Type >
+Size2i ImageView<Type>::size() const
+{
+    return this->m_size;
+}
+
+template < typename Type >
+int ImageView<Type>::width() const
+{
+    return this->m_size.x;
+}
+
+template < typename Type >
+int ImageView<Type>::height() const
+{
+    return this->m_size.y;
+}
+
+template < typename Type >
+int ImageView<Type>::widthStep() const
+{
+    return this->m_widthStep;
+}
+
+template < typename Type >
+bool ImageView<Type>::pointInImageWithBorder(const Point2i & point, int border) const
+{
+    return ((point.x >= border) && (point.y >= border) &&
+            (point.x < (this->m_size.x - border)) && (point.y < (this->m_size.y - border)));
+}
+
+template < typename Type >
+bool ImageView<Type>::pointInImageWithBorder(int x, int y, int border) const
+{
+    return ((x >= border) && (y >= border) &&
+            (x < (this->m_size.x - border)) && (y < (this->m_size.y - border)));
+}
+
+template < typename Type >
+bool ImageView<Type>::pointInImage(const Point2i & point) const
+{
+    return ((point.x >= 0) && (point.y >= 0) &&
+            (point.x < this->m_size.x) && (point.y < this->m_size.y));
+}
+
+template < typename Type >
+bool ImageView<Type>::pointInImage(int x, int y) const
+{
+    return ((x >= 0) && (y >= 0) && (x < this->m_size.x) && (y < this->m_size.y));
+}
+
 } // namespace sonar
 
 #endif // SONAR_IMAGE_IMPL_HPP
@@ -0,0 +1,98 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_MAPPEDIMAGEFILE_IMPL_HPP
+#define SONAR_MAPPEDIMAGEFILE_IMPL_HPP
+
+namespace sonar {
+
+namespace image_utils {
+
+template <typename Type>
+ConstImage<Type> mapImage(const std::shared_ptr<MappedFile> & file, const Size2i & size,
+                          std::size_t offset, int widthStep)
+{
+    if (!file || (size.x <= 0) || (size.y <= 0))
+        return ConstImage<Type>();
+    if (widthStep < 0)
+        widthStep = size.x;
+    assert(widthStep >= size.x);
+    // Data of mapping is aligned by page, so only offset can break alignment of elements
+    if ((offset % alignof(Type)) != 0)
+        return ConstImage<Type>();
+    std::size_t countBytes = (static_cast<std::size_t>(widthStep) * static_cast<std::size_t>(size.y - 1) +
+                              static_cast<std::size_t>(size.x)) * sizeof(Type);
+    if ((offset > file->size()) || (countBytes > (file->size() - offset)))
+        return ConstImage<Type>();
+    std::shared_ptr<MappedFile> holder = file;
+    return ConstImage<Type>(size, reinterpret_cast<const Type*>(&file->data()[offset]), widthStep,
+                            [holder] () { (void)holder; });
+}
+
+template <typename Type>
+ConstImage<Type> mapRawFile(const std::string & filename, const Size2i & size, std::size_t offset)
+{
+    return mapImage<Type>(MappedFile::open(filename), size, offset);
+}
+
+} // namespace image_utils
+
+template <typename Type>
+MappedFrames<Type>::MappedFrames():
+    m_frameSize(0, 0),
+    m_headerSize(0),
+    m_numberFrames(0)
+{}
+
+template <typename Type>
+MappedFrames<Type>::MappedFrames(const std::string & filename, const Size2i & frameSize, std::size_t headerSize):
+    m_file(MappedFile::open(filename)),
+    m_frameSize(frameSize),
+    m_headerSize(headerSize),
+    m_numberFrames(0)
+{
+    assert((frameSize.x > 0) && (frameSize.y > 0));
+    if (!m_file || (m_file->size() < m_headerSize) || ((m_headerSize % alignof(Type)) != 0))
+    {
+        m_file.reset();
+        return;
+    }
+    std::size_t frameBytes = static_cast<std::size_t>(frameSize.x) * static_cast<std::size_t>(frameSize.y) *
+                             sizeof(Type);
+    m_numberFrames = static_cast<int>((m_file->size() - m_headerSize) / frameBytes);
+}
+
+template <typename Type>
+bool MappedFrames<Type>::isNull() const
+{
+    return !m_file;
+}
+
+template <typename Type>
+int MappedFrames<Type>::numberFrames() const
+{
+    return m_numberFrames;
+}
+
+template <typename Type>
+Size2i MappedFrames<Type>::frameSize() const
+{
+    return m_frameSize;
+}
+
+template <typename Type>
+ConstImage<Type> MappedFrames<Type>::frame(int index) const
+{
+    assert((index >= 0) && (index < m_numberFrames));
+    std::size_t frameBytes = static_cast<std::size_t>(m_frameSize.x) * static_cast<std::size_t>(m_frameSize.y) *
+                             sizeof(Type);
+    return image_utils::mapImage<Type>(m_file, m_frameSize,
+                                       m_headerSize + frameBytes * static_cast<std::size_t>(index));
+}
+
+} // namespace sonar
+
+#endif // SONAR_MAPPEDIMAGEFILE_IMPL_HPP
@@ -0,0 +1,232 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_PLANARIMAGE_IMPL_HPP
+#define SONAR_PLANARIMAGE_IMPL_HPP
+
+#include "sonar/SimdTools/Planar.h"
+#include "sonar/ThreadsTools/WorkerPool.h"
+
+namespace sonar {
+
+template <typename PixelType>
+PlanarImage<PixelType>::PlanarImage()
+{}
+
+template <typename PixelType>
+PlanarImage<PixelType>::PlanarImage(const Size2i & size)
+{
+    this->create(size);
+}
+
+template <typename PixelType>
+PlanarImage<PixelType>::PlanarImage(const ImageRef<PixelType> & image)
+{
+    this->copyFrom(image);
+}
+
+template <typename PixelType>
+bool PlanarImage<PixelType>::isNull() const
+{
+    return this->m_buffer.isNull();
+}
+
+template <typename PixelType>
+Size2i PlanarImage<PixelType>::size() const
+{
+    return this->m_planes[0].size();
+}
+
+template <typename PixelType>
+int PlanarImage<PixelType>::width() const
+{
+    return this->m_planes[0].width();
+}
+
+template <typename PixelType>
+int PlanarImage<PixelType>::height() const
+{
+    return this->m_planes[0].height();
+}
+
+template <typename PixelType>
+void PlanarImage<PixelType>::create(const Size2i & size)
+{
+    assert((size.x >= 0) && (size.y >= 0));
+    if ((size.x == 0) || (size.y == 0))
+    {
+        this->m_buffer = Image<ChannelType>();
+        for (int c = 0; c < numberChannels; ++c)
+            this->m_planes[c] = Image<ChannelType>();
+        return;
+    }
+    this->m_buffer = Image<ChannelType>(size.x, size.y * numberChannels);
+    for (int c = 0; c < numberChannels; ++c)
+        this->m_planes[c] = Image<ChannelType>(this->m_buffer, Point2i(0, size.y * c), size);
+}
+
+template <typename PixelType>
+const Image<typename PlanarImage<PixelType>::ChannelType> & PlanarImage<PixelType>::plane(int channel) const
+{
+    assert((channel >= 0) && (channel < numberChannels));
+    return this->m_planes[channel];
+}
+
+template <typename PixelType>
+template <int Channel>
+const Image<typename PlanarImage<PixelType>::ChannelType> & PlanarImage<PixelType>::plane() const
+{
+    static_assert((Channel >= 0) && (Channel < numberChannels), "Wrong index of channel");
+    return this->m_planes[Channel];
+}
+
+template <typename PixelType>
+PixelType PlanarImage<PixelType>::pixel(int x, int y) const
+{
+    assert(this->pointInImage(x, y));
+    PixelType value;
+    ChannelType * channels = reinterpret_cast<ChannelType*>(&value);
+    for (int c = 0; c < numberChannels; ++c)
+        channels[c] = this->m_planes[c](x, y);
+    return value;
+}
+
+template <typename PixelType>
+PixelType PlanarImage<PixelType>::pixel(const Point2i & point) const
+{
+    return this->pixel(point.x, point.y);
+}
+
+template <typename PixelType>
+void PlanarImage<PixelType>::setPixel(int x, int y, const PixelType & value) const
+{
+    assert(this->pointInImage(x, y));
+    const ChannelType * channels = reinterpret_cast<const ChannelType*>(&value);
+    for (int c = 0; c < numberChannels; ++c)
+        this->m_planes[c](x, y) = channels[c];
+}
+
+template <typename PixelType>
+void PlanarImage<PixelType>::setPixel(const Point2i & point, const PixelType & value) const
+{
+    this->setPixel(point.x, point.y, value);
+}
+
+template <typename PixelType>
+void PlanarImage<PixelType>::fill(const PixelType & value) const
+{
+    const ChannelType * channels = reinterpret_cast<const ChannelType*>(&value);
+    for (int c = 0; c < numberChannels; ++c)
+        this->m_planes[c].fill(channels[c]);
+}
+
+template <typename PixelType>
+void PlanarImage<PixelType>::copyFrom(const ImageRef<PixelType> & image)
+{
+    if ((this->size() != image.size()) || this->isNull())
+        this->create(image.size());
+    this->_split(image, 0, image.height());
+}
+
+template <typename PixelType>
+void PlanarImage<PixelType>::copyFrom(const ImageRef<PixelType> & image, WorkerPool & workerPool)
+{
+    if ((this->size() != image.size()) || this->isNull())
+        this->create(image.size());
+    workerPool.parallelFor(0, image.height(), [&] (int beginRow, int endRow) {
+        this->_split(image, beginRow, endRow);
+    });
+}
+
+template <typename PixelType>
+void PlanarImage<PixelType>::copyTo(const Image<PixelType> & out) const
+{
+    assert(out.size() == this->size());
+    this->_join(out, 0, out.height());
+}
+
+template <typename PixelType>
+void PlanarImage<PixelType>::copyTo(const Image<PixelType> & out, WorkerPool & workerPool) const
+{
+    assert(out.size() == this->size());
+    workerPool.parallelFor(0, out.height(), [&] (int beginRow, int endRow) {
+        this->_join(out, beginRow, endRow);
+    });
+}
+
+template <typename PixelType>
+Image<PixelType> PlanarImage<PixelType>::toImage() const
+{
+    if (this->isNull())
+        return Image<PixelType>();
+    Image<PixelType> out(this->size());
+    this->copyTo(out);
+    return out;
+}
+
+template <typename PixelType>
+void PlanarImage<PixelType>::_split(const ImageRef<PixelType> & image, int beginRow, int endRow) const
+{
+    ChannelType * planes[numberChannels];
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        const ChannelType * str = reinterpret_cast<const ChannelType*>(image.pointer(0, y));
+        for (int c = 0; c < numberChannels; ++c)
+            planes[c] = this->m_planes[c].pointer(0, y);
+        if constexpr (std::is_same<ChannelType, uchar>::value)
+        {
+            simd::deinterleave_u(planes, str, image.width(), numberChannels);
+        }
+        else
+        {
+            for (int x = 0; x < image.width(); ++x)
+            {
+                for (int c = 0; c < numberChannels; ++c)
+                    planes[c][x] = str[x * numberChannels + c];
+            }
+        }
+    }
+}
+
+template <typename PixelType>
+void PlanarImage<PixelType>::_join(const Image<PixelType> & out, int beginRow, int endRow) const
+{
+    const ChannelType * planes[numberChannels];
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        ChannelType * str = reinterpret_cast<ChannelType*>(out.pointer(0, y));
+        for (int c = 0; c < numberChannels; ++c)
+            planes[c] = this->m_planes[c].pointer(0, y);
+        if constexpr (std::is_same<ChannelType, uchar>::value)
+        {
+            simd::interleave_u(str, planes, out.width(), numberChannels);
+        }
+        else
+        {
+            for (int x = 0; x < out.width(); ++x)
+            {
+                for (int c = 0; c < numberChannels; ++c)
+                    str[x * numberChannels + c] = planes[c][x];
+            }
+        }
+    }
+}
+
+template <typename PixelType>
+bool PlanarImage<PixelType>::pointInImage(const Point2i & point) const
+{
+    return this->m_planes[0].pointInImage(point);
+}
+
+template <typename PixelType>
+bool PlanarImage<PixelType>::pointInImage(int x, int y) const
+{
+    return this->m_planes[0].pointInImage(x, y);
+}
+
+} // namespace sonar
+
+#endif // SONAR_PLANARIMAGE_IMPL_HPP
@@ -0,0 +1,210 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_TILEDIMAGE_IMPL_HPP
+#define SONAR_TILEDIMAGE_IMPL_HPP
+
+namespace sonar {
+
+template <typename Type, int TileSize>
+TiledImage<Type, TileSize>::TiledImage():
+    m_size(0, 0),
+    m_numberTiles(0, 0)
+{}
+
+template <typename Type, int TileSize>
+TiledImage<Type, TileSize>::TiledImage(const Size2i & size)
+{
+    this->create(size);
+}
+
+template <typename Type, int TileSize>
+TiledImage<Type, TileSize>::TiledImage(const ImageView<Type> & image)
+{
+    this->copyFrom(image);
+}
+
+template <typename Type, int TileSize>
+bool TiledImage<Type, TileSize>::isNull() const
+{
+    return this->m_data.empty();
+}
+
+template <typename Type, int TileSize>
+Size2i TiledImage<Type, TileSize>::size() const
+{
+    return this->m_size;
+}
+
+template <typename Type, int TileSize>
+int TiledImage<Type, TileSize>::width() const
+{
+    return this->m_size.x;
+}
+
+template <typename Type, int TileSize>
+int TiledImage<Type, TileSize>::height() const
+{
+    return this->m_size.y;
+}
+
+template <typename Type, int TileSize>
+Size2i TiledImage<Type, TileSize>::numberTiles() const
+{
+    return this->m_numberTiles;
+}
+
+template <typename Type, int TileSize>
+void TiledImage<Type, TileSize>::create(const Size2i & size)
+{
+    assert((size.x >= 0) && (size.y >= 0));
+    this->m_size = size;
+    this->m_numberTiles.set((size.x + tileMask) >> tileShift, (size.y + tileMask) >> tileShift);
+    this->m_data.resize(static_cast<std::size_t>(this->m_numberTiles.x * this->m_numberTiles.y) *
+                        static_cast<std::size_t>(tileArea));
+}
+
+template <typename Type, int TileSize>
+void TiledImage<Type, TileSize>::copyFrom(const ImageView<Type> & image)
+{
+    this->create(image.size());
+    Point2i t;
+    for (t.y = 0; t.y < this->m_numberTiles.y; ++t.y)
+    {
+        int beginY = t.y << tileShift;
+        int endY = std::min(beginY + TileSize, this->m_size.y);
+        for (t.x = 0; t.x < this->m_numberTiles.x; ++t.x)
+        {
+            int beginX = t.x << tileShift;
+            int endX = std::min(beginX + TileSize, this->m_size.x);
+            Type * tileStr = this->tile(t.x, t.y);
+            for (int y = beginY; y < endY; ++y)
+            {
+                const Type * imageStr = image.pointer(beginX, y);
+                std::copy(imageStr, imageStr + (endX - beginX), tileStr);
+                tileStr = &tileStr[TileSize];
+            }
+        }
+    }
+}
+
+template <typename Type, int TileSize>
+void TiledImage<Type, TileSize>::copyTo(const Image<Type> & out) const
+{
+    assert(out.size() == this->m_size);
+    this->copyPatch(out, Point2i(0, 0));
+}
+
+template <typename Type, int TileSize>
+Image<Type> TiledImage<Type, TileSize>::toImage() const
+{
+    if (this->isNull())
+        return Image<Type>();
+    Image<Type> out(this->m_size);
+    this->copyTo(out);
+    return out;
+}
+
+template <typename Type, int TileSize>
+int TiledImage<Type, TileSize>::_index(int x, int y) const
+{
+    assert(this->pointInImage(x, y));
+    return (((y >> tileShift) * this->m_numberTiles.x + (x >> tileShift)) << (tileShift * 2)) +
+            ((y & tileMask) << tileShift) + (x & tileMask);
+}
+
+template <typename Type, int TileSize>
+const Type & TiledImage<Type, TileSize>::operator () (int x, int y) const
+{
+    return this->m_data[this->_index(x, y)];
+}
+
+template <typename Type, int TileSize>
+const Type & TiledImage<Type, TileSize>::operator () (const Point2i & point) const
+{
+    return this->m_data[this->_index(point.x, point.y)];
+}
+
+template <typename Type, int TileSize>
+Type & TiledImage<Type, TileSize>::operator () (int x, int y)
+{
+    return this->m_data[this->_index(x, y)];
+}
+
+template <typename Type, int TileSize>
+Type & TiledImage<Type, TileSize>::operator () (const Point2i & point)
+{
+    return this->m_data[this->_index(point.x, point.y)];
+}
+
+template <typename Type, int TileSize>
+const Type * TiledImage<Type, TileSize>::tile(int tileX, int tileY) const
+{
+    assert((tileX >= 0) && (tileY >= 0) && (tileX < this->m_numberTiles.x) && (tileY < this->m_numberTiles.y));
+    return &this->m_data[(tileY * this->m_numberTiles.x + tileX) << (tileShift * 2)];
+}
+
+template <typename Type, int TileSize>
+Type * TiledImage<Type, TileSize>::tile(int tileX, int tileY)
+{
+    assert((tileX >= 0) && (tileY >= 0) && (tileX < this->m_numberTiles.x) && (tileY < this->m_numberTiles.y));
+    return &this->m_data[(tileY * this->m_numberTiles.x + tileX) << (tileShift * 2)];
+}
+
+template <typename Type, int TileSize>
+void TiledImage<Type, TileSize>::copyPatch(const Image<Type> & out, const Point2i & begin) const
+{
+    assert((begin.x >= 0) && (begin.y >= 0));
+    assert(((begin.x + out.width()) <= this->m_size.x) && ((begin.y + out.height()) <= this->m_size.y));
+    if ((out.width() <= 0) || (out.height() <= 0))
+        return;
+    Point2i end(begin.x + out.width(), begin.y + out.height());
+    Point2i t;
+    for (t.y = (begin.y >> tileShift); (t.y << tileShift) < end.y; ++t.y)
+    {
+        int beginY = std::max(t.y << tileShift, begin.y);
+        int endY = std::min((t.y + 1) << tileShift, end.y);
+        for (t.x = (begin.x >> tileShift); (t.x << tileShift) < end.x; ++t.x)
+        {
+            int beginX = std::max(t.x << tileShift, begin.x);
+            int endX = std::min((t.x + 1) << tileShift, end.x);
+            const Type * tileStr = &this->tile(t.x, t.y)[((beginY & tileMask) << tileShift) + (beginX & tileMask)];
+            if ((endX - beginX) == TileSize)
+            {
+                // Rows of inner tiles have constant size, so copying of them is inlined
+                for (int y = beginY; y < endY; ++y)
+                {
+                    std::copy(tileStr, tileStr + TileSize, out.pointer(beginX - begin.x, y - begin.y));
+                    tileStr = &tileStr[TileSize];
+                }
+            }
+            else
+            {
+                for (int y = beginY; y < endY; ++y)
+                {
+                    std::copy(tileStr, tileStr + (endX - beginX), out.pointer(beginX - begin.x, y - begin.y));
+                    tileStr = &tileStr[TileSize];
+                }
+            }
+        }
+    }
+}
+
+template <typename Type, int TileSize>
+bool TiledImage<Type, TileSize>::pointInImage(const Point2i & point) const
+{
+    return this->pointInImage(point.x, point.y);
+}
+
+template <typename Type, int TileSize>
+bool TiledImage<Type, TileSize>::pointInImage(int x, int y) const
+{
+    return ((x >= 0) && (y >= 0) && (x < this->m_size.x) && (y < this->m_size.y));
+}
+
+} // namespace sonar
+
+#endif // SONAR_TILEDIMAGE_IMPL_HPP
@@ -87,6 +87,12 @@ CastType cast(const double & value)
     return static_cast<CastType>(value);
 }
 
+template <typename CastType>
+CastType cast(float16 value)
+{
+    return static_cast<CastType>(static_cast<float>(value));
+}
+
 template <typename CastType, typename Type>
 Point2<typename Cast<Type, CastType>::Type> cast(const Point2<Type> & p)
 {
@@ -0,0 +1,317 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "ConnectedComponents.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#include "sonar/SimdTools/BitOperations.h"
+#include "sonar/ThreadsTools/WorkerPool.h"
+
+using namespace std;
+
+namespace sonar {
+
+ConnectedComponents::ConnectedComponents():
+    m_eightConnectivity(true),
+    m_imageSize(0, 0)
+{
+}
+
+bool ConnectedComponents::eightConnectivity() const
+{
+    return m_eightConnectivity;
+}
+
+void ConnectedComponents::setEightConnectivity(bool enabled)
+{
+    m_eightConnectivity = enabled;
+}
+
+const vector<ConnectedComponents::Component> & ConnectedComponents::components() const
+{
+    return m_components;
+}
+
+const vector<ConnectedComponents::Run> & ConnectedComponents::runs() const
+{
+    return m_runs;
+}
+
+void ConnectedComponents::compute(const BitImage & image)
+{
+    Strip strip;
+    strip.beginRow = 0;
+    strip.endRow = image.height();
+    vector<int> rowSizes;
+    m_runs.clear();
+    _extractRuns(image, 0, image.height(), m_runs, rowSizes);
+    strip.beginRun = 0;
+    m_imageSize = image.size();
+    m_rowBegins.resize(static_cast<size_t>(image.height() + 1));
+    m_rowBegins[0] = 0;
+    for (int y = 0; y < image.height(); ++y)
+        m_rowBegins[y + 1] = m_rowBegins[y] + rowSizes[y];
+    m_parents.resize(m_runs.size());
+    m_perimeters.resize(m_runs.size());
+    _computeStrip(strip);
+    _finish({ strip });
+}
+
+void ConnectedComponents::compute(const BitImage & image, WorkerPool & workerPool)
+{
+    // calling thread takes one of strips
+    int numberStrips = std::min(workerPool.size() + 1, image.height() / 32);
+    if (numberStrips <= 1)
+    {
+        compute(image);
+        return;
+    }
+    vector<Strip> strips(static_cast<size_t>(numberStrips));
+    for (int i = 0; i < numberStrips; ++i)
+    {
+        strips[i].beginRow = (image.height() * i) / numberStrips;
+        strips[i].endRow = (image.height() * (i + 1)) / numberStrips;
+    }
+    vector<vector<Run>> stripRuns(static_cast<size_t>(numberStrips));
+    vector<vector<int>> stripRowSizes(static_cast<size_t>(numberStrips));
+    workerPool.parallelFor(0, numberStrips, [&] (int beginStrip, int endStrip) {
+        for (int i = beginStrip; i < endStrip; ++i)
+            _extractRuns(image, strips[i].beginRow, strips[i].endRow, stripRuns[i], stripRowSizes[i]);
+    });
+    m_imageSize = image.size();
+    m_runs.clear();
+    m_rowBegins.resize(static_cast<size_t>(image.height() + 1));
+    m_rowBegins[0] = 0;
+    for (int i = 0; i < numberStrips; ++i)
+    {
+        strips[i].beginRun = static_cast<int>(m_runs.size());
+        m_runs.insert(m_runs.end(), stripRuns[i].begin(), stripRuns[i].end());
+        for (int y = strips[i].beginRow; y < strips[i].endRow; ++y)
+            m_rowBegins[y + 1] = m_rowBegins[y] + stripRowSizes[i][y - strips[i].beginRow];
+    }
+    m_parents.resize(m_runs.size());
+    m_perimeters.resize(m_runs.size());
+    // Strips join only own runs, so they change different parts of m_parents
+    workerPool.parallelFor(0, numberStrips, [&] (int beginStrip, int endStrip) {
+        for (int i = beginStrip; i < endStrip; ++i)
+            _computeStrip(strips[i]);
+    });
+    _finish(strips);
+}
+
+void ConnectedComponents::drawLabels(const Image<int> & out) const
+{
+    assert(out.size() == m_imageSize);
+    out.fill(-1);
+    for (const Run & run : m_runs)
+    {
+        int * str = out.pointer(0, run.y);
+        std::fill(&str[run.beginX], &str[run.endX], run.label);
+    }
+}
+
+void ConnectedComponents::_extractRuns(const BitImage & image, int beginRow, int endRow,
+                                       vector<Run> & runs, vector<int> & rowSizes) const
+{
+    rowSizes.assign(static_cast<size_t>(endRow - beginRow), 0);
+    Run run;
+    run.label = -1;
+    for (run.y = beginRow; run.y < endRow; ++run.y)
+    {
+        const size_t rowBegin = runs.size();
+        const uint64_t * str = image.row(run.y);
+        bool inRun = false;
+        for (int i = 0; i < image.widthStep(); ++i)
+        {
+            // Transitions are found by the lowest bit of word (or of inverted word inside of run)
+            int position = 0;
+            while (position < 64)
+            {
+                uint64_t word = (inRun ? ~str[i] : str[i]) & (~uint64_t(0) << position);
+                if (word == 0)
+                    break;
+                position = simd::trailingZeros(word);
+                if (inRun)
+                {
+                    run.endX = (i << 6) + position;
+                    runs.push_back(run);
+                }
+                else
+                {
+                    run.beginX = (i << 6) + position;
+                }
+                inRun = !inRun;
+            }
+        }
+        // Bits after the end of row are zero, so only a run to the end of the last word is open here
+        if (inRun)
+        {
+            run.endX = image.width();
+            runs.push_back(run);
+        }
+        rowSizes[run.y - beginRow] = static_cast<int>(runs.size() - rowBegin);
+    }
+}
+
+void ConnectedComponents::_computeStrip(const Strip & strip)
+{
+    const int endRun = m_rowBegins[strip.endRow];
+    for (int i = strip.beginRun; i < endRun; ++i)
+    {
+        m_parents[i] = i;
+        m_perimeters[i] = 2 + 2 * (m_runs[i].endX - m_runs[i].beginX);
+    }
+    for (int y = strip.beginRow + 1; y < strip.endRow; ++y)
+        _joinRows(y, y - 1);
+}
+
+void ConnectedComponents::_joinRows(int row, int prevRow)
+{
+    // Runs are connected through diagonal neighbors for eight connectivity
+    const int gap = m_eightConnectivity ? 1 : 0;
+    int i = m_rowBegins[prevRow], endI = m_rowBegins[prevRow + 1];
+    int j = m_rowBegins[row], endJ = m_rowBegins[row + 1];
+    while ((i < endI) && (j < endJ))
+    {
+        const Run & a = m_runs[i];
+        const Run & b = m_runs[j];
+        if ((a.beginX < (b.endX + gap)) && (b.beginX < (a.endX + gap)))
+        {
+            _union(i, j);
+            // Shared sides of pixels are not a part of perimeter of both runs
+            int shared = std::min(a.endX, b.endX) - std::max(a.beginX, b.beginX);
+            if (shared > 0)
+                m_perimeters[j] -= shared * 2;
+        }
+        if (a.endX < b.endX)
+            ++i;
+        else
+            ++j;
+    }
+}
+
+int ConnectedComponents::_find(int index)
+{
+    // Parents always have smaller indices, root is the first run of component
+    while (m_parents[index] != index)
+    {
+        m_parents[index] = m_parents[m_parents[index]];
+        index = m_parents[index];
+    }
+    return index;
+}
+
+void ConnectedComponents::_union(int a, int b)
+{
+    a = _find(a);
+    b = _find(b);
+    if (a < b)
+        m_parents[b] = a;
+    else if (b < a)
+        m_parents[a] = b;
+}
+
+void ConnectedComponents::_finish(const vector<Strip> & strips)
+{
+    for (size_t i = 1; i < strips.size(); ++i)
+    {
+        if (strips[i].beginRow > 0)
+            _joinRows(strips[i].beginRow, strips[i].beginRow - 1);
+    }
+    m_components.clear();
+    for (size_t i = 0; i < m_runs.size(); ++i)
+    {
+        Run & run = m_runs[i];
+        if (m_parents[i] == static_cast<int>(i))
+        {
+            run.label = static_cast<int>(m_components.size());
+            Component component;
+            component.bboxMin.set(run.beginX, run.y);
+            component.bboxMax.set(run.endX - 1, run.y);
+            component.area = 0;
+            component.perimeter = 0;
+            component.startPoint.set(run.beginX, run.y);
+            m_components.push_back(component);
+        }
+        else
+        {
+            // Labels of parents are already known, they are before this run
+            run.label = m_runs[static_cast<size_t>(_find(static_cast<int>(i)))].label;
+        }
+        Component & component = m_components[static_cast<size_t>(run.label)];
+        component.bboxMin.x = std::min(component.bboxMin.x, run.beginX);
+        component.bboxMax.x = std::max(component.bboxMax.x, run.endX - 1);
+        component.bboxMax.y = run.y;
+        component.area += run.endX - run.beginX;
+        component.perimeter += m_perimeters[i];
+    }
+}
+
+vector<Point2i> ConnectedComponents::outerContour(const BitImage & image, int componentIndex) const
+{
+    assert(image.size() == m_imageSize);
+    assert((componentIndex >= 0) && (componentIndex < static_cast<int>(m_components.size())));
+    // Neighbors go clockwise from the right one
+    static const Point2i offsets[8] = { Point2i(1, 0), Point2i(1, 1), Point2i(0, 1), Point2i(-1, 1),
+                                        Point2i(-1, 0), Point2i(-1, -1), Point2i(0, -1), Point2i(1, -1) };
+    static const int directions[3][3] = { { 5, 6, 7 }, { 4, -1, 0 }, { 3, 2, 1 } };
+    const Point2i start = m_components[static_cast<size_t>(componentIndex)].startPoint;
+    vector<Point2i> contour;
+    contour.push_back(start);
+    // For 4 connectivity only neighbors by sides are checked
+    const int step = m_eightConnectivity ? 1 : 2;
+    const int numberChecks = m_eightConnectivity ? 7 : 4;
+    // Backtrack is the neighbor from which search begins, for start point it is the left one
+    Point2i point = start;
+    int backtrack = 4;
+    Point2i firstStep(-1, -1);
+    for (;;)
+    {
+        int direction = -1;
+        for (int k = 1; k <= numberChecks; ++k)
+        {
+            int d = (backtrack + k * step) & 7;
+            Point2i neighbor = point + offsets[d];
+            if (image.pointInImage(neighbor) && image.get(neighbor))
+            {
+                direction = d;
+                break;
+            }
+        }
+        if (direction < 0)
+            break; // single pixel
+        Point2i next = point + offsets[direction];
+        // Contour is closed, when it leaves start point by the first step again (stop criterion of Jacob)
+        if (point == start)
+        {
+            if (next == firstStep)
+            {
+                contour.pop_back();
+                break;
+            }
+            if (firstStep.x < 0)
+                firstStep = next;
+        }
+        if (m_eightConnectivity)
+        {
+            Point2i background = point + offsets[(direction + 7) & 7] - next;
+            backtrack = directions[background.y + 1][background.x + 1];
+        }
+        else
+        {
+            // Search begins from the left turn, so backtrack is the previous point
+            backtrack = (direction + 4) & 7;
+        }
+        point = next;
+        contour.push_back(point);
+    }
+    return contour;
+}
+
+} // namespace sonar
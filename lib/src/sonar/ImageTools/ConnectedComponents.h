@@ -0,0 +1,97 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_CONNECTEDCOMPONENTS_H
+#define SONAR_CONNECTEDCOMPONENTS_H
+
+#include <vector>
+
+#include "sonar/General/Point2.h"
+#include "sonar/General/Image.h"
+#include "sonar/General/BitImage.h"
+
+namespace sonar {
+
+class WorkerPool;
+
+/// Labeling of connected components of set pixels of binary image.
+/// Image is encoded by runs (horizontal segments of set pixels), runs of neighboring rows are joined
+/// by union-find, so cost depends on number of runs instead of number of pixels.
+/// Rows can be split into strips between threads, strips are joined by their boundary rows.
+class ConnectedComponents
+{
+public:
+    /// Horizontal segment [beginX, endX) of set pixels of row y
+    struct Run
+    {
+        int y;
+        int beginX;
+        int endX;
+        int label; // index of component
+    };
+
+    struct Component
+    {
+        Point2i bboxMin; // inclusive
+        Point2i bboxMax; // inclusive
+        int area;
+        /// Number of sides of pixels between component and background (or border of image)
+        int perimeter;
+        /// The first pixel of component in order of rows, it lies on outer contour
+        Point2i startPoint;
+    };
+
+    ConnectedComponents();
+
+    bool eightConnectivity() const;
+    /// Diagonal neighbors are connected for eight connectivity (default), else only 4 neighbors
+    void setEightConnectivity(bool enabled);
+
+    void compute(const BitImage & image);
+    void compute(const BitImage & image, WorkerPool & workerPool);
+
+    /// Components in order of their start points
+    const std::vector<Component> & components() const;
+    /// Runs with labels in order of rows
+    const std::vector<Run> & runs() const;
+
+    /// Labels of pixels, background is -1
+    void drawLabels(const Image<int> & out) const;
+
+    /// Outer contour of component by border following (Moore neighborhood), points go clockwise
+    /// for image with y axis down. Contour follows 8 neighbors or only 4 neighbors by sides
+    /// for 4 connectivity, image must be the same as for computing.
+    std::vector<Point2i> outerContour(const BitImage & image, int componentIndex) const;
+
+private:
+    struct Strip
+    {
+        int beginRow;
+        int endRow;
+        int beginRun; // index of the first run of strip in m_runs
+    };
+
+    bool m_eightConnectivity;
+    Size2i m_imageSize;
+    std::vector<Run> m_runs;
+    std::vector<int> m_rowBegins; // index of the first run of row, size is height + 1
+    std::vector<int> m_parents;
+    std::vector<int> m_perimeters; // perimeters of runs without shared sides with row above and below
+    std::vector<Component> m_components;
+
+    void _extractRuns(const BitImage & image, int beginRow, int endRow,
+                      std::vector<Run> & runs, std::vector<int> & rowSizes) const;
+    void _joinRows(int row, int prevRow);
+    void _computeStrip(const Strip & strip);
+    void _finish(const std::vector<Strip> & strips);
+
+    int _find(int index);
+    void _union(int a, int b);
+};
+
+} // namespace sonar
+
+#endif // SONAR_CONNECTEDCOMPONENTS_H
@@ -26,7 +26,7 @@ void FastCorner::_make_fast_pixel_offset(int row_stride)
     _fast_pixel_ring[15] = -1 + row_stride * 3;
 }
 
-float FastCorner::shiTomasiScore_10(const ImageRef<unsigned char> & im, const Point2i & pos)
+float FastCorner::shiTomasiScore_10(const ImageView<unsigned char> & im, const Point2i & pos)
 {
     const unsigned char * p3 = &(im.data())[(pos.y - 3) * im.widthStep()];
     const unsigned char * p2 = &(im.data())[(pos.y - 2) * im.widthStep()];
@@ -63,6 +63,29 @@ float FastCorner::shiTomasiScore_10(const ImageRef<unsigned char> & im, const Po
     return r;
 }
 
+float FastCorner::shiTomasiScore_10(const ImageView<Point2<short>> & gradients, const Point2i & pos)
+{
+    float Dxx = 0.0f;
+    float Dxy = 0.0f;
+    float Dyy = 0.0f;
+    const int endx = pos.x + 3;
+    for (int x = pos.x - 3; x <= endx; ++x)
+    {
+        // Rows are summed in the same order as in version for image, so scores are equal
+        for (int y = pos.y - 2; y <= pos.y + 2; ++y)
+        {
+            const Point2<short> & d = gradients(x, y);
+            float dx = (float)d.x; float dy = (float)d.y;
+            Dxx += dx * dx; Dyy += dy * dy; Dxy += dx * dy;
+        }
+    }
+
+    const float sum_Dxx_Dyy = Dxx + Dyy;
+
+    float r = 0.04f * 0.5f * (sum_Dxx_Dyy - std::sqrt(sum_Dxx_Dyy * sum_Dxx_Dyy - 4.0f * (Dxx * Dyy - Dxy * Dxy)));
+    return r;
+}
+
 void FastCorner::fastNonmaxSuppression(const std::vector<FastCorner::Corner> & corners,
                                        std::vector<FastCorner::Corner> & ret_nonmax)
 {
@@ -26,7 +26,7 @@ public:
     };
 
     /// Perform tree based 10 point FAST feature detection
-    static void fast_corner_detect_10(const ImageRef<unsigned char> & im,
+    static void fast_corner_detect_10(const ImageView<unsigned char> & im,
                                       const Point2i & begin, const Point2i & end,
                                       std::vector<Corner> & corners, int barrier);
 
@@ -41,7 +41,9 @@ public:
     static int fast_corner_score_10(const unsigned char * p, int barrier);
 
     // Более умный отклик на углы
-    static float shiTomasiScore_10(const ImageRef<unsigned char> & im, const Point2i & pos);
+    static float shiTomasiScore_10(const ImageView<unsigned char> & im, const Point2i & pos);
+    /// The same score computed from precomputed central differences (see image_utils::centralDifferences)
+    static float shiTomasiScore_10(const ImageView<Point2<short>> & gradients, const Point2i & pos);
 
 protected:
     static int _fast_pixel_ring[16];
@@ -110,112 +110,35 @@ void FeatureDetector::setLevelForFeature(int minLevel, int maxLevel)
 vector<FeatureDetector::FeatureCorner>
 FeatureDetector::detectCorners(const ImagePyramid_u & imagePyramid) const
 {
-    assert((m_gridSize.x > 0) && (m_gridSize.y > 0));
-
-    Point2i imageSize = imagePyramid.get(0).size();
-
-    assert((imageSize.x != 0) && (imageSize.y != 0));
-
-    Point2f cellSize(imageSize.x / cast<float>(m_gridSize.x),
-                     imageSize.y / cast<float>(m_gridSize.y));
-
-    vector<FastCorner::Corner> candidates;
-    vector<FeatureDetector::FeatureCorner> corners;
-    int prevSize = 0;
-
-    int minLevel = (m_minLevelForFeature < 0) ? 0 : m_minLevelForFeature;
-    int maxLevel = ((m_maxLevelForFeature < 0) ||
-                    (m_maxLevelForFeature >= imagePyramid.numberLevels())) ?
-                        (imagePyramid.numberLevels() - 1) :  m_maxLevelForFeature;
-
-    for (int level = minLevel; level <= maxLevel; ++level)
-    {
-        ConstImage<uchar> image = imagePyramid.get(level);
-
-        FastCorner::fast_corner_detect_10(image,
-                                          m_borderSize,
-                                          image.size() - (m_borderSize + Point2i(1, 1)),
-                                          candidates,
-                                          m_barrier);
-        //FastCorner::fastNonmaxSuppression(m_candidates, m_finalCandidates);
-        if (level > 0)
-        {
-            int scale = (1 << level);
-            for (vector<FastCorner::Corner>::iterator it = candidates.begin() + prevSize;
-                 it != candidates.end();
-                 ++it)
-            {
-                it->pos *= scale;
-                if ((it->pos.x < 0) || (it->pos.y < 0) ||
-                        (it->pos.x >= imageSize.x) || (it->pos.y >= imageSize.y)) {
-                    assert(false);
-                }
-                it->level = level;
-            }
-            break;
-        }
-        else
-        {
-            for (vector<FastCorner::Corner>::iterator it = candidates.begin() + prevSize;
-                 it != candidates.end();
-                 ++it)
-            {
-                it->level = 0;
-            }
-        }
-        prevSize = cast<int>(candidates.size());
-    }
-
-    for (vector<Cell>::iterator it = m_cells.begin(); it != m_cells.end(); ++it)
-    {
-        it->score = 0.0f;
-    }
-
-    ConstImage<uchar> firstImage = imagePyramid.get(0);
-    size_t k;
-    float score;
-    for (vector<FastCorner::Corner>::iterator it = candidates.begin();
-            it != candidates.end();
-            ++it)
-    {
-        k = cast<size_t>(floor(it->pos.y / cellSize.y) * m_gridSize.x + floor(it->pos.x / cellSize.x));
-        score = FastCorner::shiTomasiScore_10(firstImage, it->pos);
-        if (score > m_cells[k].score)
-        {
-            m_cells[k].score = score;
-            m_cells[k].pos = it->pos;
-            m_cells[k].level = it->level;
-        }
-    }
+    return _detectCorners(imagePyramid, nullptr, nullptr);
+}
 
-    vector<int> cellOrders;
-    cellOrders.resize(m_cells.size());
+vector<FeatureDetector::FeatureCorner>
+FeatureDetector::detectCorners(const ImagePyramid_u & imagePyramid, const vector<Point2i> & existCorners) const
+{
+    return _detectCorners(imagePyramid, nullptr, &existCorners);
+}
 
-    for (size_t i = 0; i < cellOrders.size(); ++i)
-        cellOrders[i] = cast<int>(i);
-    random_device rng;
-    mt19937 urng(rng());
-    shuffle(cellOrders.begin(), cellOrders.end(), urng);
+vector<FeatureDetector::FeatureCorner>
+FeatureDetector::detectCorners(const FrameData & frameData) const
+{
+    return _detectCorners(frameData.pyramid(), &frameData, nullptr);
+}
 
-    for (vector<int>::iterator it = cellOrders.begin(); it != cellOrders.end(); ++it)
-    {
-        const Cell & cell = m_cells[cast<size_t>(*it)];
-        if (cell.score > m_detectionThreshold)
-        {
-            corners.push_back(FeatureCorner(cell.pos, cell.level));
-            if (cast<int>(corners.size()) > m_maxCountFeatures)
-                return corners;
-        }
-    }
-    return corners;
+vector<FeatureDetector::FeatureCorner>
+FeatureDetector::detectCorners(const FrameData & frameData, const vector<Point2i> & existCorners) const
+{
+    return _detectCorners(frameData.pyramid(), &frameData, &existCorners);
 }
 
 vector<FeatureDetector::FeatureCorner>
-FeatureDetector::detectCorners(const ImagePyramid_u & imagePyramid, const vector<Point2i> & existCorners) const
+FeatureDetector::_detectCorners(const ImagePyramid_u & imagePyramid,
+                                const FrameData * frameData,
+                                const vector<Point2i> * existCorners) const
 {
     assert((m_gridSize.x > 0) && (m_gridSize.y > 0));
 
-    Point2i imageSize = imagePyramid.get(0).size();
+    Point2i imageSize = imagePyramid.view(0).size();
 
     assert((imageSize.x != 0) && (imageSize.y != 0));
 
@@ -233,7 +156,7 @@ FeatureDetector::detectCorners(const ImagePyramid_u & imagePyramid, const vector
 
     for (int level = minLevel; level <= maxLevel; ++level)
     {
-        ConstImage<uchar> image = imagePyramid.get(level);
+        ImageView<uchar> image = imagePyramid.view(level);
 
         FastCorner::fast_corner_detect_10(image,
                                           m_borderSize,
@@ -273,18 +196,27 @@ FeatureDetector::detectCorners(const ImagePyramid_u & imagePyramid, const vector
     vector<char> blockCells(m_cells.size(), 0);
 
     size_t k;
-    for (auto it = existCorners.cbegin(); it != existCorners.cend(); ++it)
+    if (existCorners != nullptr)
     {
-        k = cast<size_t>(floor(it->y / cellSize.y) * m_gridSize.x + floor(it->x / cellSize.x));
-        blockCells[k] = 1;
+        for (auto it = existCorners->cbegin(); it != existCorners->cend(); ++it)
+        {
+            k = cast<size_t>(floor(it->y / cellSize.y) * m_gridSize.x + floor(it->x / cellSize.x));
+            blockCells[k] = 1;
+        }
     }
 
     for (vector<Cell>::iterator it = m_cells.begin(); it != m_cells.end(); ++it)
     {
-        it->score = m_detectionThreshold;
+        it->score = (existCorners != nullptr) ? m_detectionThreshold : 0.0f;
     }
 
-    ConstImage<uchar> firstImage = imagePyramid.get(0);
+    // Gradients of frame are computed once and are shared with other consumers of frame
+    ImageView<uchar> firstImage;
+    ImageView<Point2<short>> firstGradients;
+    if (frameData != nullptr)
+        firstGradients = frameData->gradientsView(0);
+    else
+        firstImage = imagePyramid.view(0);
     float score;
     for (vector<FastCorner::Corner>::iterator it = candidates.begin();
             it != candidates.end();
@@ -293,7 +225,8 @@ FeatureDetector::detectCorners(const ImagePyramid_u & imagePyramid, const vector
         k = cast<size_t>(floor(it->pos.y / cellSize.y) * m_gridSize.x + floor(it->pos.x / cellSize.x));
         if (blockCells[k] > 0)
             continue;
-        score = FastCorner::shiTomasiScore_10(firstImage, it->pos);
+        score = (frameData != nullptr) ? FastCorner::shiTomasiScore_10(firstGradients, it->pos) :
+                                         FastCorner::shiTomasiScore_10(firstImage, it->pos);
         if (score > m_cells[k].score)
         {
             m_cells[k].score = score;
@@ -12,6 +12,7 @@
 #include "sonar/General/Image.h"
 #include "sonar/General/ImagePyramid.h"
 #include "sonar/ImageTools/FastCorner.h"
+#include "sonar/ImageTools/FrameData.h"
 
 namespace sonar {
 
@@ -52,6 +53,10 @@ public:
     std::vector<FeatureCorner> detectCorners(const ImagePyramid_u & imagePyramid) const;
     std::vector<FeatureCorner> detectCorners(const ImagePyramid_u & imagePyramid,
                                              const std::vector<Point2i> & existCorners) const;
+    /// Scores of corners are computed from gradients of frame, so they are shared with other consumers
+    std::vector<FeatureCorner> detectCorners(const FrameData & frameData) const;
+    std::vector<FeatureCorner> detectCorners(const FrameData & frameData,
+                                             const std::vector<Point2i> & existCorners) const;
 
     int indexOfCell(const Point2i & point, const Point2f & cellSize) const;
     int indexOfCell(const Point2f & point, const Point2f & cellSize) const;
@@ -76,6 +81,10 @@ protected:
 
     Point2i m_gridSize;
     mutable std::vector<Cell> m_cells;
+
+    std::vector<FeatureCorner> _detectCorners(const ImagePyramid_u & imagePyramid,
+                                              const FrameData * frameData,
+                                              const std::vector<Point2i> * existCorners) const;
 };
 
 } // namespace sonar
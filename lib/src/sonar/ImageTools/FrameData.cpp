@@ -0,0 +1,80 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "sonar/ImageTools/FrameData.h"
+
+#include <cassert>
+
+#include "sonar/General/ImageUtils.h"
+
+using namespace std;
+
+namespace sonar {
+
+FrameData::FrameData(const ImageRef<uchar> & image, int numberLevels,
+                     const shared_ptr<ImageBufferPool_u> & bufferPool):
+    FrameData(ImagePyramid_u(image, numberLevels, bufferPool))
+{
+}
+
+FrameData::FrameData(const ImagePyramid_u & pyramid):
+    m_pyramid(pyramid)
+{
+    assert(!m_pyramid.isNull());
+
+    size_t numberLevels = static_cast<size_t>(m_pyramid.numberLevels());
+    m_gradients.resize(numberLevels);
+    m_gradientsFlags.reset(new once_flag[numberLevels]);
+}
+
+int FrameData::numberLevels() const
+{
+    return m_pyramid.numberLevels();
+}
+
+Size2i FrameData::size() const
+{
+    return m_pyramid.view(0).size();
+}
+
+const ImagePyramid_u & FrameData::pyramid() const
+{
+    return m_pyramid;
+}
+
+ConstImage<uchar> FrameData::image(int level) const
+{
+    return m_pyramid.get(level);
+}
+
+ImageView<uchar> FrameData::view(int level) const
+{
+    return m_pyramid.view(level);
+}
+
+ConstImage<Point2<short>> FrameData::gradients(int level) const
+{
+    return _gradients(level);
+}
+
+ImageView<Point2<short>> FrameData::gradientsView(int level) const
+{
+    return _gradients(level).view();
+}
+
+const Image<Point2<short>> & FrameData::_gradients(int level) const
+{
+    size_t index = static_cast<size_t>(level);
+    Image<Point2<short>> & gradients = m_gradients.at(index);
+    call_once(m_gradientsFlags[index], [this, level, &gradients] () {
+        Image<Point2<short>> result(m_pyramid.view(level).size());
+        image_utils::centralDifferences(result, m_pyramid.get(level));
+        gradients = move(result);
+    });
+    return gradients;
+}
+
+} // namespace sonar
@@ -0,0 +1,59 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_FRAMEDATA_H
+#define SONAR_FRAMEDATA_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "sonar/General/Point2.h"
+#include "sonar/General/Image.h"
+#include "sonar/General/ImagePyramid.h"
+#include "sonar/General/ImageBufferPool.h"
+
+namespace sonar {
+
+/// Data of one grayscale frame, which is shared by all consumers (feature detector, optical flow and etc).
+/// Levels of pyramid and gradients of levels are computed lazily on first request,
+/// every quantity is computed at most once. Requesting from several threads is safe.
+/// The object is not copyable, it's passed by std::shared_ptr<const FrameData>.
+class FrameData
+{
+public:
+    FrameData(const ImageRef<uchar> & image, int numberLevels,
+              const std::shared_ptr<ImageBufferPool_u> & bufferPool = nullptr);
+    explicit FrameData(const ImagePyramid_u & pyramid);
+
+    FrameData(const FrameData &) = delete;
+    FrameData & operator = (const FrameData &) = delete;
+
+    int numberLevels() const;
+    Size2i size() const;
+
+    const ImagePyramid_u & pyramid() const;
+
+    ConstImage<uchar> image(int level = 0) const;
+    /// Non-owning view of level, the frame must outlive it
+    ImageView<uchar> view(int level = 0) const;
+
+    /// Central differences of level without scaling (see image_utils::centralDifferences)
+    ConstImage<Point2<short>> gradients(int level = 0) const;
+    /// Non-owning view of gradients of level, the frame must outlive it
+    ImageView<Point2<short>> gradientsView(int level = 0) const;
+
+private:
+    ImagePyramid_u m_pyramid;
+    mutable std::vector<Image<Point2<short>>> m_gradients;
+    std::unique_ptr<std::once_flag[]> m_gradientsFlags;
+
+    const Image<Point2<short>> & _gradients(int level) const;
+};
+
+} // namespace sonar
+
+#endif // SONAR_FRAMEDATA_H
@@ -1,14 +1,18 @@
 DEFINES += MODULE_IMAGE_TOOLS
 
 HEADERS += \
+    $$PWD/ConnectedComponents.h \
     $$PWD/FastCorner.h \
     $$PWD/FeatureDetector.h \
+    $$PWD/FrameData.h \
     $$PWD/OpticalFlow.h \
     $$PWD/OpticalFlowCalculator.h 
 
 SOURCES += \
+    $$PWD/ConnectedComponents.cpp \
     $$PWD/FastCorner.cpp \
     $$PWD/FeatureDetector.cpp \
+    $$PWD/FrameData.cpp \
     $$PWD/OpticalFlow.cpp \
     $$PWD/OpticalFlowCalculator.cpp \
     $$PWD/faster_corner_10.cxx
\ No newline at end of file
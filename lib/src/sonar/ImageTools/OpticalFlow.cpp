@@ -6,7 +6,9 @@ using namespace std;
 
 namespace sonar {
 
-OpticalFlow::OpticalFlow()
+OpticalFlow::OpticalFlow():
+    m_bufferPool(make_shared<ImageBufferPool_u>()),
+    m_tiledLayout(false)
 {
     setNumberLevels(3);
     setCursorSize(Point2i(20, 20));
@@ -66,6 +68,47 @@ void OpticalFlow::setDetThreashold(float value)
     m_opticalFlowCalculator.setDetThreshold(value);
 }
 
+bool OpticalFlow::tiledLayout() const
+{
+    return m_tiledLayout;
+}
+
+void OpticalFlow::setTiledLayout(bool enabled)
+{
+    m_tiledLayout = enabled;
+    if (!m_tiledLayout)
+    {
+        m_firstTiledLevels.clear();
+        m_validFirstTiledLevels.clear();
+    }
+}
+
+void OpticalFlow::_resetFirstTiledLevels()
+{
+    // Tiled images keep own memory, so next levels are copied into them without allocation
+    fill(m_validFirstTiledLevels.begin(), m_validFirstTiledLevels.end(), false);
+}
+
+void OpticalFlow::_setLevel(int level)
+{
+    m_opticalFlowCalculator.setFirstImage(m_firstPyramid.view(level));
+    m_opticalFlowCalculator.setSecondImage(m_secondPyramid.view(level));
+    if (!m_tiledLayout)
+        return;
+    size_t index = static_cast<size_t>(level);
+    if (m_firstTiledLevels.size() <= index)
+    {
+        m_firstTiledLevels.resize(index + 1);
+        m_validFirstTiledLevels.resize(index + 1, false);
+    }
+    if (!m_validFirstTiledLevels[index])
+    {
+        m_firstTiledLevels[index].copyFrom(m_firstPyramid.view(level));
+        m_validFirstTiledLevels[index] = true;
+    }
+    m_opticalFlowCalculator.setFirstTiledImage(&m_firstTiledLevels[index]);
+}
+
 ImagePyramid_u OpticalFlow::firstPyramid() const
 {
     return m_firstPyramid;
@@ -80,30 +123,75 @@ void OpticalFlow::setFirstPyramid(const ImagePyramid_u & firstPyramid)
 {
     assert(!firstPyramid.isNull());
 
+    m_firstFrame.reset();
     m_firstPyramid = ImagePyramid_u(firstPyramid, m_numberLevels);
+    _resetFirstTiledLevels();
 }
 
 void OpticalFlow::setSecondPyramid(const ImagePyramid_u & secondPyramid)
 {
     assert(!secondPyramid.isNull());
 
+    m_secondFrame.reset();
     m_secondPyramid = ImagePyramid_u(secondPyramid, m_numberLevels);
 }
 
 void OpticalFlow::setFirstImage(const ImageRef<uchar> & image)
 {
-    setFirstPyramid(ImagePyramid_u(image, m_numberLevels));
+    assert(!image.isNull());
+
+    m_firstFrame.reset();
+    m_firstPyramid.setBufferPool(m_bufferPool);
+    m_firstPyramid.rebuild(image, m_numberLevels);
+    _resetFirstTiledLevels();
 }
 
 void OpticalFlow::setSecondImage(const ImageRef<uchar> &image)
 {
-    setSecondPyramid(ImagePyramid_u(image, m_numberLevels));
+    assert(!image.isNull());
+
+    m_secondFrame.reset();
+    m_secondPyramid.setBufferPool(m_bufferPool);
+    m_secondPyramid.rebuild(image, m_numberLevels);
+}
+
+void OpticalFlow::setFirstFrame(const shared_ptr<const FrameData> & frame)
+{
+    assert(frame);
+
+    // Levels are built in the frame first, so the copy of pyramid shares them instead of building own
+    frame->view(min(m_numberLevels, frame->numberLevels()) - 1);
+    m_firstPyramid = ImagePyramid_u(frame->pyramid(), m_numberLevels);
+    m_firstFrame = frame;
+    _resetFirstTiledLevels();
+}
+
+void OpticalFlow::setSecondFrame(const shared_ptr<const FrameData> & frame)
+{
+    assert(frame);
+
+    frame->view(min(m_numberLevels, frame->numberLevels()) - 1);
+    m_secondPyramid = ImagePyramid_u(frame->pyramid(), m_numberLevels);
+    m_secondFrame = frame;
+}
+
+shared_ptr<const FrameData> OpticalFlow::firstFrame() const
+{
+    return m_firstFrame;
+}
+
+shared_ptr<const FrameData> OpticalFlow::secondFrame() const
+{
+    return m_secondFrame;
 }
 
 void OpticalFlow::reset()
 {
     m_firstPyramid.clear();
     m_secondPyramid.clear();
+    m_firstFrame.reset();
+    m_secondFrame.reset();
+    _resetFirstTiledLevels();
 }
 
 TrackingResult OpticalFlow::tracking2d(Point2f & secondPosition, const Point2f & firstPosition)
@@ -111,8 +199,7 @@ TrackingResult OpticalFlow::tracking2d(Point2f & secondPosition, const Point2f &
     Point2f p, prev;
     for (int level = m_numberLevels - 1; level >= 0; --level)
     {
-        m_opticalFlowCalculator.setFirstImage(m_firstPyramid.get(level));
-        m_opticalFlowCalculator.setSecondImage(m_secondPyramid.get(level));
+        _setLevel(level);
         float scale = cast<float>(1 << level);
         p = secondPosition / scale;
         prev = p;
@@ -129,8 +216,7 @@ TrackingResult OpticalFlow::tracking2d(Point2f & secondPosition, const Point2f &
         }
     }
 
-    m_opticalFlowCalculator.setFirstImage(m_firstPyramid.get(0));
-    m_opticalFlowCalculator.setSecondImage(m_secondPyramid.get(0));
+    _setLevel(0);
     p = secondPosition;
     prev = p;
     TrackingResult result = m_opticalFlowCalculator.tracking2d(p, firstPosition);
@@ -163,8 +249,7 @@ void OpticalFlow::tracking2d(vector<TrackingResult> & status,
     for (int level = m_numberLevels - 1; level >= 0; --level)
     {
 
-        m_opticalFlowCalculator.setFirstImage(m_firstPyramid.get(level));
-        m_opticalFlowCalculator.setSecondImage(m_secondPyramid.get(level));
+        _setLevel(level);
         float scale = cast<float>(1 << level);
         vector<Point2f>::iterator itSecond = secondPoints.begin();
         vector<Point2f>::const_iterator itFirst = firstPoints.cbegin();
@@ -189,8 +274,7 @@ void OpticalFlow::tracking2d(vector<TrackingResult> & status,
         }
     }
 
-    m_opticalFlowCalculator.setFirstImage(m_firstPyramid.get(0));
-    m_opticalFlowCalculator.setSecondImage(m_secondPyramid.get(0));
+    _setLevel(0);
     vector<Point2f>::iterator itSecond = secondPoints.begin();
     vector<Point2f>::const_iterator itFirst = firstPoints.cbegin();
     vector<TrackingResult>::iterator itSuccess = status.begin();
@@ -221,8 +305,7 @@ TrackingResult OpticalFlow::tracking2dLK(Point2f & secondPosition, const Point2f
     for (int level = m_numberLevels - 1; level >= 0; --level)
     {
 
-        m_opticalFlowCalculator.setFirstImage(m_firstPyramid.get(level));
-        m_opticalFlowCalculator.setSecondImage(m_secondPyramid.get(level));
+        _setLevel(level);
         float scale = cast<float>(1 << level);
         p = secondPosition / scale;
         prev = p;
@@ -238,8 +321,7 @@ TrackingResult OpticalFlow::tracking2dLK(Point2f & secondPosition, const Point2f
             }
         }
     }
-    m_opticalFlowCalculator.setFirstImage(m_firstPyramid.get(0));
-    m_opticalFlowCalculator.setSecondImage(m_secondPyramid.get(0));
+    _setLevel(0);
     p = secondPosition;
     prev = p;
     TrackingResult result = m_opticalFlowCalculator.tracking2dLK(p, firstPosition);
@@ -273,8 +355,7 @@ void OpticalFlow::tracking2dLK(vector<TrackingResult> & status,
     for (int level = m_numberLevels - 1; level >= 0; --level)
     {
 
-        m_opticalFlowCalculator.setFirstImage(m_firstPyramid.get(level));
-        m_opticalFlowCalculator.setSecondImage(m_secondPyramid.get(level));
+        _setLevel(level);
         float scale = cast<float>(1 << level);
         vector<Point2f>::iterator itSecond = secondPoints.begin();
         vector<Point2f>::const_iterator itFirst = firstPoints.cbegin();
@@ -299,8 +380,7 @@ void OpticalFlow::tracking2dLK(vector<TrackingResult> & status,
         }
     }
 
-    m_opticalFlowCalculator.setFirstImage(m_firstPyramid.get(0));
-    m_opticalFlowCalculator.setSecondImage(m_secondPyramid.get(0));
+    _setLevel(0);
     vector<Point2f>::iterator itSecond = secondPoints.begin();
     vector<Point2f>::const_iterator itFirst = firstPoints.cbegin();
     vector<TrackingResult>::iterator itSuccess = status.begin();
@@ -327,9 +407,11 @@ void OpticalFlow::tracking2dLK(vector<TrackingResult> & status,
 
 void OpticalFlow::swapFirstSecond()
 {
-    ImagePyramid_u temp = m_firstPyramid;
-    m_firstPyramid = m_secondPyramid;
-    m_secondPyramid = temp;
+    ImagePyramid_u temp = move(m_firstPyramid);
+    m_firstPyramid = move(m_secondPyramid);
+    m_secondPyramid = move(temp);
+    m_firstFrame.swap(m_secondFrame);
+    _resetFirstTiledLevels();
 }
 
 } // namespace sonar
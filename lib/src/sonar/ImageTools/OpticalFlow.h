@@ -9,10 +9,13 @@
 
 #include <vector>
 #include <utility>
+#include <memory>
 
 #include "sonar/General/Image.h"
 #include "sonar/General/ImagePyramid.h"
+#include "sonar/General/ImageBufferPool.h"
 #include "sonar/ImageTools/OpticalFlowCalculator.h"
+#include "sonar/ImageTools/FrameData.h"
 
 namespace sonar {
 
@@ -38,6 +41,13 @@ public:
     float detThreshold() const;
     void setDetThreashold(float value);
 
+    bool tiledLayout() const;
+    /// Levels of first pyramid are copied to tiled images once per first image,
+    /// first patches of points are sampled from tiles then (see TiledImage). Results of tracking are the same.
+    /// Disabled by default: in test_tiled_patch_sampling tiled layout isn't faster than linear one yet,
+    /// also with cold caches, so it's only for experiments on big frames.
+    void setTiledLayout(bool enabled);
+
     ImagePyramid_u firstPyramid() const;
     ImagePyramid_u secondPyramid() const;
 
@@ -47,6 +57,14 @@ public:
     void setFirstImage(const ImageRef<uchar> & image);
     void setSecondImage(const ImageRef<uchar> & image);
 
+    /// Levels of frame are used without rebuilding, so they are shared with other consumers of frame.
+    /// The frame is held until next setting of first (second) image, pyramid or frame.
+    void setFirstFrame(const std::shared_ptr<const FrameData> & frame);
+    void setSecondFrame(const std::shared_ptr<const FrameData> & frame);
+
+    std::shared_ptr<const FrameData> firstFrame() const;
+    std::shared_ptr<const FrameData> secondFrame() const;
+
     void swapFirstSecond();
 
     TrackingResult tracking2d(Point2f & secondPosition, const Point2f & firstPosition);
@@ -63,10 +81,21 @@ public:
 protected:
     ImagePyramid_u m_firstPyramid;
     ImagePyramid_u m_secondPyramid;
+    std::shared_ptr<const FrameData> m_firstFrame;
+    std::shared_ptr<const FrameData> m_secondFrame;
+    // Levels of pyramids are taken from here, so tracking of frames doesn't allocate memory
+    std::shared_ptr<ImageBufferPool_u> m_bufferPool;
     OpticalFlowCalculator m_opticalFlowCalculator;
+    bool m_tiledLayout;
+    // Tiled copies of levels of first pyramid, levels are copied on first use after change of first image
+    std::vector<TiledImage_u> m_firstTiledLevels;
+    std::vector<bool> m_validFirstTiledLevels;
 
     float m_maxVelocitySquared;
     int m_numberLevels;
+
+    void _setLevel(int level);
+    void _resetFirstTiledLevels();
 };
 
 } // namespace sonar
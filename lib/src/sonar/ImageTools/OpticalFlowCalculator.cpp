@@ -1,4 +1,6 @@
 #include "sonar/ImageTools/OpticalFlowCalculator.h"
+#include "sonar/SimdTools/HalfConversion.h"
+#include "sonar/SimdTools/Interpolation.h"
 
 #include <cmath>
 #include <limits>
@@ -12,7 +14,8 @@ using namespace Eigen;
 
 namespace sonar {
 
-OpticalFlowCalculator::OpticalFlowCalculator()
+OpticalFlowCalculator::OpticalFlowCalculator():
+    m_firstTiledImage(nullptr)
 {
     m_invMaxErrorSquared = 0.0f;
     m_cursorSize.set(4, 4);
@@ -144,66 +147,68 @@ float OpticalFlowCalculator::lastDet() const
     return m_lastDet;
 }
 
-void OpticalFlowCalculator::setFirstImage(const ImageRef<uchar> & image)
+void OpticalFlowCalculator::setFirstImage(const ImageView<uchar> & image)
 {
     m_firstImage = image;
+    m_firstGradients = ImageView<Point2<short>>();
+    m_firstTiledImage = nullptr;
     m_begin_first = m_cursorSize + Point2i(2, 2);
     m_end_first = m_firstImage.size() - (m_cursorSize + Point2i(3, 3));
 }
 
-ConstImage<uchar> OpticalFlowCalculator::firstImage() const
+ImageView<uchar> OpticalFlowCalculator::firstImage() const
 {
     return m_firstImage;
 }
 
-void OpticalFlowCalculator::setSecondImage(const ImageRef<uchar> & image)
+void OpticalFlowCalculator::setFirstGradients(const ImageView<Point2<short>> & gradients)
+{
+    assert(gradients.isNull() || (gradients.size() == m_firstImage.size()));
+    m_firstGradients = gradients;
+}
+
+ImageView<Point2<short>> OpticalFlowCalculator::firstGradients() const
+{
+    return m_firstGradients;
+}
+
+void OpticalFlowCalculator::setFirstTiledImage(const TiledImage_u * image)
+{
+    assert((image == nullptr) || (image->size() == m_firstImage.size()));
+    m_firstTiledImage = image;
+}
+
+const TiledImage_u * OpticalFlowCalculator::firstTiledImage() const
+{
+    return m_firstTiledImage;
+}
+
+void OpticalFlowCalculator::setSecondImage(const ImageView<uchar> & image)
 {
     m_secondImage = image;
     m_begin_second = m_cursorSize + Point2i(2, 2);
     m_end_second = m_secondImage.size() - (m_cursorSize + Point2i(3, 3));
 }
 
-ConstImage<uchar> OpticalFlowCalculator::secondImage() const
+ImageView<uchar> OpticalFlowCalculator::secondImage() const
 {
     return m_secondImage;
 }
 
 void OpticalFlowCalculator::getSubPixelImageF(Image<float> & outImage,
-                                              const ImageRef<uchar> & image,
+                                              const ImageView<uchar> & image,
                                               const Point2f & beginPoint)
 {
     Point2i beginPoint_i(cast<int>(floor(beginPoint.x)), cast<int>(floor(beginPoint.y)));
     assert((beginPoint_i.x >= 0) && (beginPoint_i.y >= 0));
     assert(((beginPoint_i.x + outImage.width() + 1) <= image.width()) &&
-            ((beginPoint_i.y + outImage.height() + 1) <= image.height()));
-    const uchar * imageStr = image.pointer(beginPoint_i);
-    const uchar * imageStrNext = &imageStr[image.widthStep()];
-
-    float * outStr = outImage.data();
-
-    Point2f sub_pix(beginPoint.x - beginPoint_i.x, beginPoint.y - beginPoint_i.y);
-    // interpolation weights
-    float wTL, wTR, wBL, wBR;
-    wTL = (1.0f - sub_pix.x) * (1.0f - sub_pix.y);
-    wTR = sub_pix.x * (1.0f - sub_pix.y);
-    wBL = (1.0f - sub_pix.x) * sub_pix.y;
-    wBR = sub_pix.x * sub_pix.y;
-
-    Point2i p;
-    for (p.y = 0; p.y < outImage.height(); ++p.y)
-    {
-        for (p.x = 0; p.x < outImage.width(); ++p.x)
-        {
-            outStr[p.x] = wTL * imageStr[p.x] + wTR * imageStr[p.x + 1] +
-                          wBL * imageStrNext[p.x] + wBR * imageStrNext[p.x + 1];
-        }
-        imageStr = imageStrNext;
-        imageStrNext = &imageStrNext[image.widthStep()];
-        outStr = &outStr[outImage.widthStep()];
-    }
+           ((beginPoint_i.y + outImage.height() + 1) <= image.height()));
+    simd::bilinearPatch_f(outImage.data(), outImage.widthStep(), outImage.width(), outImage.height(),
+                          image.pointer(beginPoint_i), image.widthStep(),
+                          beginPoint.x - beginPoint_i.x, beginPoint.y - beginPoint_i.y);
 }
 
-Image<float> OpticalFlowCalculator::getSubPixelImageF(const ImageRef<uchar> & image,
+Image<float> OpticalFlowCalculator::getSubPixelImageF(const ImageView<uchar> & image,
                                                       const Point2f & beginPoint,
                                                       const Point2i & size)
 {
@@ -212,42 +217,44 @@ Image<float> OpticalFlowCalculator::getSubPixelImageF(const ImageRef<uchar> & im
     return outImage;
 }
 
-void OpticalFlowCalculator::getSubPixelImage(Image<uchar> & outImage,
-                                             const ImageRef<uchar> & image,
-                                             const Point2f & beginPoint)
+void OpticalFlowCalculator::getSubPixelImageF(Image<float16> & outImage,
+                                              const ImageView<uchar> & image,
+                                              const Point2f & beginPoint)
 {
     Point2i beginPoint_i(cast<int>(floor(beginPoint.x)), cast<int>(floor(beginPoint.y)));
     assert((beginPoint_i.x >= 0) && (beginPoint_i.y >= 0));
     assert(((beginPoint_i.x + outImage.width() + 1) <= image.width()) &&
            ((beginPoint_i.y + outImage.height() + 1) <= image.height()));
-    const uchar * imageStr = image.pointer(beginPoint_i);
-    const uchar * imageStrNext = &imageStr[image.widthStep()];
-
-    uchar * outStr = outImage.data();
-
-    Point2f sub_pix(beginPoint.x - beginPoint_i.x, beginPoint.y - beginPoint_i.y);
-    // interpolation weights
-    float wTL, wTR, wBL, wBR;
-    wTL = (1.0f - sub_pix.x) * (1.0f - sub_pix.y);
-    wTR = sub_pix.x * (1.0f - sub_pix.y);
-    wBL = (1.0f - sub_pix.x) * sub_pix.y;
-    wBR = sub_pix.x * sub_pix.y;
-
-    Point2i p;
-    for (p.y = 0; p.y < outImage.height(); ++p.y)
+    // Rows are sampled into floats by blocks on stack and converted to half precision
+    const int blockSize = 64;
+    float block[blockSize];
+    for (int y = 0; y < outImage.height(); ++y)
     {
-        for (p.x = 0; p.x < outImage.width(); ++p.x)
+        for (int x = 0; x < outImage.width(); x += blockSize)
         {
-            outStr[p.x] = cast<uchar>(wTL * imageStr[p.x] + wTR * imageStr[p.x + 1] +
-                                      wBL * imageStrNext[p.x] + wBR * imageStrNext[p.x + 1]);
+            int width = std::min(blockSize, outImage.width() - x);
+            simd::bilinearPatch_f(block, blockSize, width, 1,
+                                  image.pointer(beginPoint_i.x + x, beginPoint_i.y + y), image.widthStep(),
+                                  beginPoint.x - beginPoint_i.x, beginPoint.y - beginPoint_i.y);
+            simd::convertToHalf_f(reinterpret_cast<std::uint16_t*>(outImage.pointer(x, y)), block, width);
         }
-        imageStr = imageStrNext;
-        imageStrNext = &imageStrNext[image.widthStep()];
-        outStr = &outStr[outImage.widthStep()];
     }
 }
 
-Image<uchar> OpticalFlowCalculator::getSubPixelImage(const ImageRef<uchar> & image,
+void OpticalFlowCalculator::getSubPixelImage(Image<uchar> & outImage,
+                                             const ImageView<uchar> & image,
+                                             const Point2f & beginPoint)
+{
+    Point2i beginPoint_i(cast<int>(floor(beginPoint.x)), cast<int>(floor(beginPoint.y)));
+    assert((beginPoint_i.x >= 0) && (beginPoint_i.y >= 0));
+    assert(((beginPoint_i.x + outImage.width() + 1) <= image.width()) &&
+           ((beginPoint_i.y + outImage.height() + 1) <= image.height()));
+    simd::bilinearPatch_u(outImage.data(), outImage.widthStep(), outImage.width(), outImage.height(),
+                          image.pointer(beginPoint_i), image.widthStep(),
+                          beginPoint.x - beginPoint_i.x, beginPoint.y - beginPoint_i.y);
+}
+
+Image<uchar> OpticalFlowCalculator::getSubPixelImage(const ImageView<uchar> & image,
                                                      const Point2f & beginPoint,
                                                      const Point2i & size)
 {
@@ -256,14 +263,74 @@ Image<uchar> OpticalFlowCalculator::getSubPixelImage(const ImageRef<uchar> & ima
     return outImage;
 }
 
+const uchar * OpticalFlowCalculator::_tiledPatch(const TiledImage_u & image, const Point2i & begin, const Size2i & size)
+{
+    // Window with one more column and row for bilinear interpolation
+    const Size2i windowSize(size.x + 1, size.y + 1);
+    if (m_tiledPatch.size() < static_cast<size_t>(windowSize.x * windowSize.y))
+        m_tiledPatch.resize(static_cast<size_t>(windowSize.x * windowSize.y));
+    image.copyPatch(Image<uchar>(windowSize, m_tiledPatch.data(), false), begin);
+    return m_tiledPatch.data();
+}
+
+void OpticalFlowCalculator::getSubPixelImageF(Image<float> & outImage,
+                                              const TiledImage_u & image,
+                                              const Point2f & beginPoint)
+{
+    Point2i beginPoint_i(cast<int>(floor(beginPoint.x)), cast<int>(floor(beginPoint.y)));
+    assert((beginPoint_i.x >= 0) && (beginPoint_i.y >= 0));
+    assert(((beginPoint_i.x + outImage.width() + 1) <= image.width()) &&
+           ((beginPoint_i.y + outImage.height() + 1) <= image.height()));
+    const uchar * window = _tiledPatch(image, beginPoint_i, outImage.size());
+    simd::bilinearPatch_f(outImage.data(), outImage.widthStep(), outImage.width(), outImage.height(),
+                          window, outImage.width() + 1,
+                          beginPoint.x - beginPoint_i.x, beginPoint.y - beginPoint_i.y);
+}
+
+void OpticalFlowCalculator::getSubPixelImageF(Image<float16> & outImage,
+                                              const TiledImage_u & image,
+                                              const Point2f & beginPoint)
+{
+    Point2i beginPoint_i(cast<int>(floor(beginPoint.x)), cast<int>(floor(beginPoint.y)));
+    assert((beginPoint_i.x >= 0) && (beginPoint_i.y >= 0));
+    assert(((beginPoint_i.x + outImage.width() + 1) <= image.width()) &&
+           ((beginPoint_i.y + outImage.height() + 1) <= image.height()));
+    const uchar * window = _tiledPatch(image, beginPoint_i, outImage.size());
+    getSubPixelImageF(outImage, ImageView<uchar>(outImage.width() + 1, outImage.height() + 1,
+                                                 window, outImage.width() + 1),
+                      Point2f(beginPoint.x - beginPoint_i.x, beginPoint.y - beginPoint_i.y));
+}
+
+void OpticalFlowCalculator::getSubPixelImage(Image<uchar> & outImage,
+                                             const TiledImage_u & image,
+                                             const Point2f & beginPoint)
+{
+    Point2i beginPoint_i(cast<int>(floor(beginPoint.x)), cast<int>(floor(beginPoint.y)));
+    assert((beginPoint_i.x >= 0) && (beginPoint_i.y >= 0));
+    assert(((beginPoint_i.x + outImage.width() + 1) <= image.width()) &&
+           ((beginPoint_i.y + outImage.height() + 1) <= image.height()));
+    const uchar * window = _tiledPatch(image, beginPoint_i, outImage.size());
+    simd::bilinearPatch_u(outImage.data(), outImage.widthStep(), outImage.width(), outImage.height(),
+                          window, outImage.width() + 1,
+                          beginPoint.x - beginPoint_i.x, beginPoint.y - beginPoint_i.y);
+}
+
+void OpticalFlowCalculator::_getFirstPatch(const Point2f & first)
+{
+    Point2f beginPoint(first.x - (m_cursorSize.x + 1.5f), first.y - (m_cursorSize.y + 1.5f));
+    if (m_firstTiledImage != nullptr)
+        getSubPixelImage(m_path, *m_firstTiledImage, beginPoint);
+    else
+        getSubPixelImage(m_path, m_firstImage, beginPoint);
+}
+
 TrackingResult OpticalFlowCalculator::tracking2d(Point2f & second, const Point2f & first)
 {
     if ((first.x < m_begin_first.x) || (first.y < m_begin_first.y) ||
         (first.x >= m_end_first.x) || (first.y >= m_end_first.y))
         return TrackingResult::Fail;
-    getSubPixelImage(m_path, m_firstImage, Point2f(first.x - (m_cursorSize.x + 1.5f),
-                                                   first.y - (m_cursorSize.y + 1.5f)));
-    return _tracking2dOnSecondImage(second, m_path.data(), m_path.widthStep());
+    _getFirstPatch(first);
+    return _tracking2dOnSecondImage(second, m_path.data(), m_path.widthStep(), nullptr, 0);
 }
 
 TrackingResult OpticalFlowCalculator::tracking2dLK(Point2f & second, const Point2f & first)
@@ -271,9 +338,8 @@ TrackingResult OpticalFlowCalculator::tracking2dLK(Point2f & second, const Point
     if ((first.x < m_begin_first.x) || (first.y < m_begin_first.y) ||
         (first.x >= m_end_first.x) || (first.y >= m_end_first.y))
         return TrackingResult::Fail;
-    getSubPixelImage(m_path, m_firstImage, Point2f(first.x - (m_cursorSize.x + 1.5f),
-                                                     first.y - (m_cursorSize.y + 1.5f)));
-    return _tracking2dOnSecondImageLK(second, m_path.data(), m_path.widthStep());
+    _getFirstPatch(first);
+    return _tracking2dOnSecondImageLK(second, m_path.data(), m_path.widthStep(), nullptr, 0);
 }
 
 TrackingResult OpticalFlowCalculator::tracking2dLK(Point2f & second, const Point2i & first)
@@ -281,17 +347,20 @@ TrackingResult OpticalFlowCalculator::tracking2dLK(Point2f & second, const Point
     if ((first.x < m_begin_first.x) || (first.y < m_begin_first.y) ||
         (first.x >= m_end_first.x) || (first.y >= m_end_first.y))
         return TrackingResult::Fail;
-    return _tracking2dOnSecondImageLK(second, m_firstImage.pointer(first), m_firstImage.widthStep());
+    if (!m_firstGradients.isNull())
+        return _tracking2dOnSecondImageLK(second, m_firstImage.pointer(first), m_firstImage.widthStep(),
+                                          m_firstGradients.pointer(first), m_firstGradients.widthStep());
+    return _tracking2dOnSecondImageLK(second, m_firstImage.pointer(first), m_firstImage.widthStep(), nullptr, 0);
 }
 
 TrackingResult OpticalFlowCalculator::tracking2d_patch(Point2f & second)
 {
-    return _tracking2dOnSecondImage(second, m_path.data(), m_path.widthStep());
+    return _tracking2dOnSecondImage(second, m_path.data(), m_path.widthStep(), nullptr, 0);
 }
 
 TrackingResult OpticalFlowCalculator::tracking2dLK_patch(Point2f & position)
 {
-    return _tracking2dOnSecondImageLK(position, m_path.data(), m_path.widthStep());
+    return _tracking2dOnSecondImageLK(position, m_path.data(), m_path.widthStep(), nullptr, 0);
 }
 
 TrackingResult OpticalFlowCalculator::horizontalTracking(Point2f & second, const Point2i & first)
@@ -299,7 +368,10 @@ TrackingResult OpticalFlowCalculator::horizontalTracking(Point2f & second, const
     if ((first.x < m_begin_first.x) || (first.y < m_begin_first.y) ||
         (first.x >= m_end_first.x) || (first.y >= m_end_first.y))
         return TrackingResult::Fail;
-    return _horizontalTrackingOnSecondImage(second, m_firstImage.pointer(first), m_firstImage.widthStep());
+    if (!m_firstGradients.isNull())
+        return _horizontalTrackingOnSecondImage(second, m_firstImage.pointer(first), m_firstImage.widthStep(),
+                                                m_firstGradients.pointer(first), m_firstGradients.widthStep());
+    return _horizontalTrackingOnSecondImage(second, m_firstImage.pointer(first), m_firstImage.widthStep(), nullptr, 0);
 }
 
 TrackingResult OpticalFlowCalculator::horizontalTrackingLK(Point2f & second, const Point2i & first)
@@ -307,7 +379,10 @@ TrackingResult OpticalFlowCalculator::horizontalTrackingLK(Point2f & second, con
     if ((first.x < m_begin_first.x) || (first.y < m_begin_first.y) ||
         (first.x >= m_end_first.x) || (first.y >= m_end_first.y))
         return TrackingResult::Fail;
-    return _horizontalTrackingOnSecondImageLK(second, m_firstImage.pointer(first), m_firstImage.widthStep());
+    if (!m_firstGradients.isNull())
+        return _horizontalTrackingOnSecondImageLK(second, m_firstImage.pointer(first), m_firstImage.widthStep(),
+                                                  m_firstGradients.pointer(first), m_firstGradients.widthStep());
+    return _horizontalTrackingOnSecondImageLK(second, m_firstImage.pointer(first), m_firstImage.widthStep(), nullptr, 0);
 }
 
 TrackingResult OpticalFlowCalculator::horizontalTracking(Point2f & second, const Point2f & first)
@@ -315,9 +390,8 @@ TrackingResult OpticalFlowCalculator::horizontalTracking(Point2f & second, const
     if ((first.x < m_begin_first.x) || (first.y < m_begin_first.y) ||
         (first.x >= m_end_first.x) || (first.y >= m_end_first.y))
         return TrackingResult::Fail;
-    getSubPixelImage(m_path, m_firstImage, Point2f(first.x - (m_cursorSize.x + 1.5f),
-                                                   first.y - (m_cursorSize.y + 1.5f)));
-    return _horizontalTrackingOnSecondImage(second, m_path.data(), m_path.widthStep());
+    _getFirstPatch(first);
+    return _horizontalTrackingOnSecondImage(second, m_path.data(), m_path.widthStep(), nullptr, 0);
 }
 
 TrackingResult OpticalFlowCalculator::horizontalTrackingLK(Point2f & second, const Point2f & first)
@@ -325,17 +399,18 @@ TrackingResult OpticalFlowCalculator::horizontalTrackingLK(Point2f & second, con
     if ((first.x < m_begin_first.x) || (first.y < m_begin_first.y) ||
         (first.x >= m_end_first.x) || (first.y >= m_end_first.y))
         return TrackingResult::Fail;
-    getSubPixelImage(m_path, m_firstImage, Point2f(first.x - (m_cursorSize.x + 1.5f),
-                                                   first.y - (m_cursorSize.y + 1.5f)));
-    return _horizontalTrackingOnSecondImageLK(second, m_path.data(), m_path.widthStep());
+    _getFirstPatch(first);
+    return _horizontalTrackingOnSecondImageLK(second, m_path.data(), m_path.widthStep(), nullptr, 0);
 }
 
-TrackingResult OpticalFlowCalculator::_tracking2dOnSecondImage(Point2f & position, const uchar * imageRef, int imageStride)
+TrackingResult OpticalFlowCalculator::_tracking2dOnSecondImage(Point2f & position, const uchar * imageRef, int imageStride,
+                                                               const Point2<short> * gradientsRef, int gradientsStride)
 {
     const uchar * basePathRef = &imageRef[imageStride + 1];
     const uchar * pathStr = basePathRef;
     const uchar * pathStrPrev = &pathStr[-imageStride];
     const uchar * pathStrNext = &pathStr[imageStride];
+    const Point2<short> * gradientsStr = (gradientsRef != nullptr) ? &gradientsRef[gradientsStride + 1] : nullptr;
     Point2f wd;
     Point2i p;
     int k = 0;
@@ -348,8 +423,16 @@ TrackingResult OpticalFlowCalculator::_tracking2dOnSecondImage(Point2f & positio
         for (p.x = 0; p.x < m_pathSize.x; ++p.x)
         {
             Point2f & d = derivatives[k];
-            d.x = (pathStr[p.x + 1] - pathStr[p.x - 1]) * 0.5f;
-            d.y = (pathStrNext[p.x] - pathStrPrev[p.x]) * 0.5f;
+            if (gradientsStr != nullptr)
+            {
+                d.x = gradientsStr[p.x].x * 0.5f;
+                d.y = gradientsStr[p.x].y * 0.5f;
+            }
+            else
+            {
+                d.x = (pathStr[p.x + 1] - pathStr[p.x - 1]) * 0.5f;
+                d.y = (pathStrNext[p.x] - pathStrPrev[p.x]) * 0.5f;
+            }
             wd = d * gaussian_data[k];
 
             // m_H - symmetric matrix
@@ -365,6 +448,8 @@ TrackingResult OpticalFlowCalculator::_tracking2dOnSecondImage(Point2f & positio
         pathStrPrev = pathStr;
         pathStr = pathStrNext;
         pathStrNext = &pathStrNext[imageStride];
+        if (gradientsStr != nullptr)
+            gradientsStr = &gradientsStr[gradientsStride];
     }
 
     //m_lastDet = (m_H(0, 0) * m_H(1, 1) * m_H(2, 2) + m_H(0, 1) * m_H(1, 2) * m_H(2, 0) + m_H(0, 2) * m_H(2, 1) * m_H(1, 0)) -
@@ -458,13 +543,15 @@ TrackingResult OpticalFlowCalculator::_tracking2dOnSecondImage(Point2f & positio
     return TrackingResult::Uncompleted;
 }
 
-TrackingResult OpticalFlowCalculator::_tracking2dOnSecondImageLK(Point2f & position, const uchar * imageRef, int imageStride)
+TrackingResult OpticalFlowCalculator::_tracking2dOnSecondImageLK(Point2f & position, const uchar * imageRef, int imageStride,
+                                                                 const Point2<short> * gradientsRef, int gradientsStride)
 {
     const uchar * basePathRef = &imageRef[imageStride + 1];
 
     const uchar * pathStr = basePathRef;
     const uchar * pathStrPrev = &pathStr[-imageStride];
     const uchar * pathStrNext = &pathStr[imageStride];
+    const Point2<short> * gradientsStr = (gradientsRef != nullptr) ? &gradientsRef[gradientsStride + 1] : nullptr;
     Point2f wd;
     Point2i p;
     float Dxx = 0.0f, Dxy = 0.0f, Dyy = 0.0f;
@@ -476,8 +563,16 @@ TrackingResult OpticalFlowCalculator::_tracking2dOnSecondImageLK(Point2f & posit
         for (p.x = 0; p.x < m_pathSize.x; ++p.x)
         {
             Point2f & d = derivatives[k];
-            d.x = (pathStr[p.x + 1] - pathStr[p.x - 1]) * 0.5f;
-            d.y = (pathStrNext[p.x] - pathStrPrev[p.x]) * 0.5f;
+            if (gradientsStr != nullptr)
+            {
+                d.x = gradientsStr[p.x].x * 0.5f;
+                d.y = gradientsStr[p.x].y * 0.5f;
+            }
+            else
+            {
+                d.x = (pathStr[p.x + 1] - pathStr[p.x - 1]) * 0.5f;
+                d.y = (pathStrNext[p.x] - pathStrPrev[p.x]) * 0.5f;
+            }
             wd = d * gaussian_data[k];
 
             Dxx += d.x * wd.x;
@@ -489,6 +584,8 @@ TrackingResult OpticalFlowCalculator::_tracking2dOnSecondImageLK(Point2f & posit
         pathStrPrev = pathStr;
         pathStr = pathStrNext;
         pathStrNext = &pathStrNext[imageStride];
+        if (gradientsStr != nullptr)
+            gradientsStr = &gradientsStr[gradientsStride];
     }
     m_lastDet = Dxx * Dyy - Dxy * Dxy;
     if (fabs(m_lastDet) < m_detThreshold)
@@ -572,7 +669,8 @@ TrackingResult OpticalFlowCalculator::_tracking2dOnSecondImageLK(Point2f & posit
 }
 
 TrackingResult OpticalFlowCalculator::_horizontalTrackingOnSecondImage(Point2f & position,
-                                                                       const uchar * imageRef, int imageStride)
+                                                                       const uchar * imageRef, int imageStride,
+                                                                       const Point2<short> * gradientsRef, int gradientsStride)
 {
     //TODO check
 
@@ -587,6 +685,7 @@ TrackingResult OpticalFlowCalculator::_horizontalTrackingOnSecondImage(Point2f &
 
     const uchar * basePathRef = &imageRef[imageStride + 1];
     const uchar * pathStr = basePathRef;
+    const Point2<short> * gradientsStr = (gradientsRef != nullptr) ? &gradientsRef[gradientsStride + 1] : nullptr;
     Point2i p;
     int k = 0;
     float wd;
@@ -599,7 +698,10 @@ TrackingResult OpticalFlowCalculator::_horizontalTrackingOnSecondImage(Point2f &
         for (p.x = 0; p.x < m_pathSize.x; ++p.x)
         {
             float & d = derivatives[k];
-            d = (pathStr[p.x + 1] - pathStr[p.x - 1]) * 0.5f;
+            if (gradientsStr != nullptr)
+                d = gradientsStr[p.x].x * 0.5f;
+            else
+                d = (pathStr[p.x + 1] - pathStr[p.x - 1]) * 0.5f;
             wd = d * gaussian_data[k];
 
             H(0, 0) += d * wd;
@@ -608,6 +710,8 @@ TrackingResult OpticalFlowCalculator::_horizontalTrackingOnSecondImage(Point2f &
             ++k;
         }
         pathStr = &pathStr[imageStride];
+        if (gradientsStr != nullptr)
+            gradientsStr = &gradientsStr[gradientsStride];
     }
 
     H(0, 1) = - H(0, 1);
@@ -688,7 +792,8 @@ TrackingResult OpticalFlowCalculator::_horizontalTrackingOnSecondImage(Point2f &
 }
 
 TrackingResult OpticalFlowCalculator::_horizontalTrackingOnSecondImageLK(Point2f & position,
-                                                                         const uchar * imageRef, int imageStride)
+                                                                         const uchar * imageRef, int imageStride,
+                                                                         const Point2<short> * gradientsRef, int gradientsStride)
 {
     Point2i position_i;
     Point2f sub_pix;
@@ -701,6 +806,7 @@ TrackingResult OpticalFlowCalculator::_horizontalTrackingOnSecondImageLK(Point2f
 
     const uchar * basePathRef = &imageRef[imageStride + 1];
     const uchar * pathStr = basePathRef;
+    const Point2<short> * gradientsStr = (gradientsRef != nullptr) ? &gradientsRef[gradientsStride + 1] : nullptr;
     Point2i p;
     int k = 0;
     const float * gaussian_data = m_gaussian.data();
@@ -711,12 +817,17 @@ TrackingResult OpticalFlowCalculator::_horizontalTrackingOnSecondImageLK(Point2f
         for (p.x = 0; p.x < m_pathSize.x; ++p.x)
         {
             float & d = derivatives[k];
-            d = (pathStr[p.x + 1] - pathStr[p.x - 1]) * 0.5f;
+            if (gradientsStr != nullptr)
+                d = gradientsStr[p.x].x * 0.5f;
+            else
+                d = (pathStr[p.x + 1] - pathStr[p.x - 1]) * 0.5f;
 
             H += d * gaussian_data[k];
             ++k;
         }
         pathStr = &pathStr[imageStride];
+        if (gradientsStr != nullptr)
+            gradientsStr = &gradientsStr[gradientsStride];
     }
 
     m_lastDet = H;
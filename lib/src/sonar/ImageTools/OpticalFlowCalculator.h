@@ -7,7 +7,10 @@
 #ifndef SONAR_OPTICALFLOWCALCULATOR
 #define SONAR_OPTICALFLOWCALCULATOR
 
+#include <vector>
+
 #include "sonar/General/Image.h"
+#include "sonar/General/TiledImage.h"
 
 namespace sonar {
 
@@ -32,11 +35,23 @@ public:
     Image<uchar> patch();
     ConstImage<uchar> patch() const;
 
-    void setFirstImage(const ImageRef<uchar> & image);
-    ConstImage<uchar> firstImage() const;
+    /// Images are not owned by calculator, they must outlive the tracking calls
+    void setFirstImage(const ImageView<uchar> & image);
+    ImageView<uchar> firstImage() const;
+
+    /// Precomputed central differences of first image (see FrameData::gradients).
+    /// They are used instead of per-patch derivatives when the first patch is taken at integer position,
+    /// setFirstImage resets them.
+    void setFirstGradients(const ImageView<Point2<short>> & gradients);
+    ImageView<Point2<short>> firstGradients() const;
 
-    void setSecondImage(const ImageRef<uchar> & image);
-    ConstImage<uchar> secondImage() const;
+    /// Tiled copy of first image, first patches at sub pixel positions are sampled from its tiles.
+    /// It isn't owned by calculator, nullptr disables it, setFirstImage resets it.
+    void setFirstTiledImage(const TiledImage_u * image);
+    const TiledImage_u * firstTiledImage() const;
+
+    void setSecondImage(const ImageView<uchar> & image);
+    ImageView<uchar> secondImage() const;
 
     int numberIterations() const;
     void setNumberIterations(int numberIterations);
@@ -49,14 +64,26 @@ public:
 
     float lastDet() const;
 
-    static void getSubPixelImageF(Image<float> & outImage, const ImageRef<uchar> & image,
+    static void getSubPixelImageF(Image<float> & outImage, const ImageView<uchar> & image,
                                  const Point2f & beginPoint);
-    static Image<float> getSubPixelImageF(const ImageRef<uchar> & image, const Point2f & beginPoint,
+    static Image<float> getSubPixelImageF(const ImageView<uchar> & image, const Point2f & beginPoint,
                                          const Point2i & size);
-    static void getSubPixelImage(Image<uchar> & outImage, const ImageRef<uchar> & image,
+    static void getSubPixelImage(Image<uchar> & outImage, const ImageView<uchar> & image,
                                  const Point2f & beginPoint);
-    static Image<uchar> getSubPixelImage(const ImageRef<uchar> & image, const Point2f & beginPoint,
+    static Image<uchar> getSubPixelImage(const ImageView<uchar> & image, const Point2f & beginPoint,
                                          const Point2i & size);
+    /// The same as getSubPixelImageF, values are stored in half precision (caches of patches take half of memory)
+    static void getSubPixelImageF(Image<float16> & outImage, const ImageView<uchar> & image,
+                                  const Point2f & beginPoint);
+
+    /// Versions for tiled layout: window is copied tile by tile into buffer of calculator
+    /// (it's reused by calls) and sampled as linear image. Results are the same as for linear image.
+    void getSubPixelImageF(Image<float> & outImage, const TiledImage_u & image,
+                           const Point2f & beginPoint);
+    void getSubPixelImageF(Image<float16> & outImage, const TiledImage_u & image,
+                           const Point2f & beginPoint);
+    void getSubPixelImage(Image<uchar> & outImage, const TiledImage_u & image,
+                          const Point2f & beginPoint);
 
     TrackingResult tracking2d(Point2f & second, const Point2f & first);
     TrackingResult tracking2d(Point2f & second, const Point2i & first);
@@ -73,8 +100,10 @@ public:
     TrackingResult horizontalTrackingLK(Point2f & second, const Point2f & first);
 
 private:
-    ConstImage<uchar> m_firstImage;
-    ConstImage<uchar> m_secondImage;
+    ImageView<uchar> m_firstImage;
+    ImageView<Point2<short>> m_firstGradients;
+    const TiledImage_u * m_firstTiledImage;
+    ImageView<uchar> m_secondImage;
 
     Point2i m_cursorSize;
     Point2i m_pathSize;
@@ -92,6 +121,7 @@ private:
     Image<float> m_derivatives1d;
     Image<uchar> m_path;
     Image<Point2f> m_derivatives2d;
+    std::vector<uchar> m_tiledPatch;
 
     int m_numberIterations;
     float m_pixelEps;
@@ -100,14 +130,25 @@ private:
     float m_lastDet;
 
     void _solveGaussian();
+
+    /// Patch of first image around point at sub pixel position into m_path
+    void _getFirstPatch(const Point2f & first);
+    /// Window of tiled image for out patch of given size (with one more column and row) is copied
+    /// to m_tiledPatch, width step of result is size.x + 1.
+    const uchar * _tiledPatch(const TiledImage_u & image, const Point2i & begin, const Size2i & size);
     void _setSigmaGaussian(float sigma);
 
-    TrackingResult _tracking2dOnSecondImage(Point2f & position, const uchar * imageRef, int imageStride);
-    TrackingResult _tracking2dOnSecondImageLK(Point2f & position, const uchar * imageRef, int imageStride);
+    /// gradientsRef - central differences at the same position as imageRef or nullptr
+    TrackingResult _tracking2dOnSecondImage(Point2f & position, const uchar * imageRef, int imageStride,
+                                            const Point2<short> * gradientsRef, int gradientsStride);
+    TrackingResult _tracking2dOnSecondImageLK(Point2f & position, const uchar * imageRef, int imageStride,
+                                              const Point2<short> * gradientsRef, int gradientsStride);
     TrackingResult _horizontalTrackingOnSecondImage(Point2f & position,
-                                                    const uchar * imageRef, int imageStride);
+                                                    const uchar * imageRef, int imageStride,
+                                                    const Point2<short> * gradientsRef, int gradientsStride);
     TrackingResult _horizontalTrackingOnSecondImageLK(Point2f & position,
-                                                      const uchar * imageRef, int imageStride);
+                                                      const uchar * imageRef, int imageStride,
+                                                      const Point2<short> * gradientsRef, int gradientsStride);
 };
 
 } // namespace sonar
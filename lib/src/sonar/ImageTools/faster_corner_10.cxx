@@ -1,4 +1,5 @@
 #include "sonar/ImageTools/FastCorner.h"
+#include "sonar/SimdTools/FastSegment.h"
 
 #include <vector>
 #include <list>
@@ -6,7 +7,7 @@
 
 namespace sonar {
 
-void FastCorner::fast_corner_detect_10(const ImageRef<unsigned char> & im,
+void FastCorner::fast_corner_detect_10(const ImageView<unsigned char> & im,
                                         const Point2i & begin, const Point2i & end,
                                         std::vector<Corner> & corners, int barrier)
 {
@@ -18,2304 +19,22 @@ void FastCorner::fast_corner_detect_10(const ImageRef<unsigned char> & im,
     int stride = im.widthStep();
 
     _make_fast_pixel_offset(stride);
-    Corner corner;
+    if (beginx >= endx)
+        return;
 
+    // Segment test is done by SIMD kernel selected for processor, it gives the same corners as decision tree
+    std::vector<int> rowCorners(static_cast<std::size_t>(endx - beginx));
+    Corner corner;
+    corner.score = 0;
+    corner.level = 0;
     const unsigned char * data = im.data();
-    //const bool* mdata = mask.data();
-
-    const unsigned char * p;
-    //const bool* mp;
-
     for (corner.pos.y = beginy; corner.pos.y < endy; ++corner.pos.y)
     {
-        p = &data[stride * corner.pos.y];
-        //mp = &mdata[stride * corner.pos.y];
-        for (corner.pos.x = beginx; corner.pos.x < endx; ++corner.pos.x, ++p/*, ++mp*/)
+        int numberCorners = simd::fastCorners10Row_u(rowCorners.data(), &data[stride * corner.pos.y], stride,
+                                                     beginx, endx, barrier);
+        for (int i = 0; i < numberCorners; ++i)
         {
-            //if (mp)
-            //    continue;
-
-            int cb = *p + barrier;
-            int c_b= *p - barrier;
-        if(p[_fast_pixel_ring[0]] > cb)
-         if(p[_fast_pixel_ring[1]] > cb)
-          if(p[_fast_pixel_ring[2]] > cb)
-           if(p[_fast_pixel_ring[3]] > cb)
-            if(p[_fast_pixel_ring[4]] > cb)
-             if(p[_fast_pixel_ring[5]] > cb)
-              if(p[_fast_pixel_ring[6]] > cb)
-               if(p[_fast_pixel_ring[7]] > cb)
-                if(p[_fast_pixel_ring[8]] > cb)
-                 if(p[_fast_pixel_ring[9]] > cb)
-                  {}
-                 else
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[14]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                if(p[_fast_pixel_ring[13]] > cb)
-                 if(p[_fast_pixel_ring[14]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-              else if(p[_fast_pixel_ring[6]] < c_b)
-               if(p[_fast_pixel_ring[12]] > cb)
-                if(p[_fast_pixel_ring[13]] > cb)
-                 if(p[_fast_pixel_ring[14]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else if(p[_fast_pixel_ring[12]] < c_b)
-                if(p[_fast_pixel_ring[7]] < c_b)
-                 if(p[_fast_pixel_ring[8]] < c_b)
-                  if(p[_fast_pixel_ring[9]] < c_b)
-                   if(p[_fast_pixel_ring[10]] < c_b)
-                    if(p[_fast_pixel_ring[11]] < c_b)
-                     if(p[_fast_pixel_ring[13]] < c_b)
-                      if(p[_fast_pixel_ring[14]] < c_b)
-                       if(p[_fast_pixel_ring[15]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               if(p[_fast_pixel_ring[12]] > cb)
-                if(p[_fast_pixel_ring[13]] > cb)
-                 if(p[_fast_pixel_ring[14]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-             else if(p[_fast_pixel_ring[5]] < c_b)
-              if(p[_fast_pixel_ring[15]] > cb)
-               if(p[_fast_pixel_ring[11]] > cb)
-                if(p[_fast_pixel_ring[12]] > cb)
-                 if(p[_fast_pixel_ring[13]] > cb)
-                  if(p[_fast_pixel_ring[14]] > cb)
-                   {}
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else if(p[_fast_pixel_ring[11]] < c_b)
-                if(p[_fast_pixel_ring[6]] < c_b)
-                 if(p[_fast_pixel_ring[7]] < c_b)
-                  if(p[_fast_pixel_ring[8]] < c_b)
-                   if(p[_fast_pixel_ring[9]] < c_b)
-                    if(p[_fast_pixel_ring[10]] < c_b)
-                     if(p[_fast_pixel_ring[12]] < c_b)
-                      if(p[_fast_pixel_ring[13]] < c_b)
-                       if(p[_fast_pixel_ring[14]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               if(p[_fast_pixel_ring[6]] < c_b)
-                if(p[_fast_pixel_ring[7]] < c_b)
-                 if(p[_fast_pixel_ring[8]] < c_b)
-                  if(p[_fast_pixel_ring[9]] < c_b)
-                   if(p[_fast_pixel_ring[10]] < c_b)
-                    if(p[_fast_pixel_ring[11]] < c_b)
-                     if(p[_fast_pixel_ring[12]] < c_b)
-                      if(p[_fast_pixel_ring[13]] < c_b)
-                       if(p[_fast_pixel_ring[14]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-             else
-              if(p[_fast_pixel_ring[11]] > cb)
-               if(p[_fast_pixel_ring[12]] > cb)
-                if(p[_fast_pixel_ring[13]] > cb)
-                 if(p[_fast_pixel_ring[14]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else if(p[_fast_pixel_ring[11]] < c_b)
-               if(p[_fast_pixel_ring[6]] < c_b)
-                if(p[_fast_pixel_ring[7]] < c_b)
-                 if(p[_fast_pixel_ring[8]] < c_b)
-                  if(p[_fast_pixel_ring[9]] < c_b)
-                   if(p[_fast_pixel_ring[10]] < c_b)
-                    if(p[_fast_pixel_ring[12]] < c_b)
-                     if(p[_fast_pixel_ring[13]] < c_b)
-                      if(p[_fast_pixel_ring[14]] < c_b)
-                       if(p[_fast_pixel_ring[15]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-            else if(p[_fast_pixel_ring[4]] < c_b)
-             if(p[_fast_pixel_ring[14]] > cb)
-              if(p[_fast_pixel_ring[10]] > cb)
-               if(p[_fast_pixel_ring[11]] > cb)
-                if(p[_fast_pixel_ring[12]] > cb)
-                 if(p[_fast_pixel_ring[13]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     if(p[_fast_pixel_ring[7]] > cb)
-                      if(p[_fast_pixel_ring[8]] > cb)
-                       if(p[_fast_pixel_ring[9]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else if(p[_fast_pixel_ring[10]] < c_b)
-               if(p[_fast_pixel_ring[5]] < c_b)
-                if(p[_fast_pixel_ring[6]] < c_b)
-                 if(p[_fast_pixel_ring[7]] < c_b)
-                  if(p[_fast_pixel_ring[8]] < c_b)
-                   if(p[_fast_pixel_ring[9]] < c_b)
-                    if(p[_fast_pixel_ring[11]] < c_b)
-                     if(p[_fast_pixel_ring[12]] < c_b)
-                      if(p[_fast_pixel_ring[13]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else if(p[_fast_pixel_ring[14]] < c_b)
-              if(p[_fast_pixel_ring[6]] < c_b)
-               if(p[_fast_pixel_ring[7]] < c_b)
-                if(p[_fast_pixel_ring[8]] < c_b)
-                 if(p[_fast_pixel_ring[9]] < c_b)
-                  if(p[_fast_pixel_ring[10]] < c_b)
-                   if(p[_fast_pixel_ring[11]] < c_b)
-                    if(p[_fast_pixel_ring[12]] < c_b)
-                     if(p[_fast_pixel_ring[13]] < c_b)
-                      if(p[_fast_pixel_ring[5]] < c_b)
-                       {}
-                      else
-                       if(p[_fast_pixel_ring[15]] < c_b)
-                        {}
-                       else
-                        continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              if(p[_fast_pixel_ring[5]] < c_b)
-               if(p[_fast_pixel_ring[6]] < c_b)
-                if(p[_fast_pixel_ring[7]] < c_b)
-                 if(p[_fast_pixel_ring[8]] < c_b)
-                  if(p[_fast_pixel_ring[9]] < c_b)
-                   if(p[_fast_pixel_ring[10]] < c_b)
-                    if(p[_fast_pixel_ring[11]] < c_b)
-                     if(p[_fast_pixel_ring[12]] < c_b)
-                      if(p[_fast_pixel_ring[13]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-            else
-             if(p[_fast_pixel_ring[10]] > cb)
-              if(p[_fast_pixel_ring[11]] > cb)
-               if(p[_fast_pixel_ring[12]] > cb)
-                if(p[_fast_pixel_ring[13]] > cb)
-                 if(p[_fast_pixel_ring[14]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     if(p[_fast_pixel_ring[7]] > cb)
-                      if(p[_fast_pixel_ring[8]] > cb)
-                       if(p[_fast_pixel_ring[9]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else if(p[_fast_pixel_ring[10]] < c_b)
-              if(p[_fast_pixel_ring[6]] < c_b)
-               if(p[_fast_pixel_ring[7]] < c_b)
-                if(p[_fast_pixel_ring[8]] < c_b)
-                 if(p[_fast_pixel_ring[9]] < c_b)
-                  if(p[_fast_pixel_ring[11]] < c_b)
-                   if(p[_fast_pixel_ring[12]] < c_b)
-                    if(p[_fast_pixel_ring[13]] < c_b)
-                     if(p[_fast_pixel_ring[14]] < c_b)
-                      if(p[_fast_pixel_ring[5]] < c_b)
-                       {}
-                      else
-                       if(p[_fast_pixel_ring[15]] < c_b)
-                        {}
-                       else
-                        continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-           else if(p[_fast_pixel_ring[3]] < c_b)
-            if(p[_fast_pixel_ring[9]] > cb)
-             if(p[_fast_pixel_ring[10]] > cb)
-              if(p[_fast_pixel_ring[11]] > cb)
-               if(p[_fast_pixel_ring[12]] > cb)
-                if(p[_fast_pixel_ring[13]] > cb)
-                 if(p[_fast_pixel_ring[14]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     if(p[_fast_pixel_ring[7]] > cb)
-                      if(p[_fast_pixel_ring[8]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     if(p[_fast_pixel_ring[7]] > cb)
-                      if(p[_fast_pixel_ring[8]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else if(p[_fast_pixel_ring[9]] < c_b)
-             if(p[_fast_pixel_ring[6]] < c_b)
-              if(p[_fast_pixel_ring[7]] < c_b)
-               if(p[_fast_pixel_ring[8]] < c_b)
-                if(p[_fast_pixel_ring[10]] < c_b)
-                 if(p[_fast_pixel_ring[11]] < c_b)
-                  if(p[_fast_pixel_ring[12]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[4]] < c_b)
-                     {}
-                    else
-                     if(p[_fast_pixel_ring[13]] < c_b)
-                      if(p[_fast_pixel_ring[14]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[_fast_pixel_ring[13]] < c_b)
-                     if(p[_fast_pixel_ring[14]] < c_b)
-                      if(p[_fast_pixel_ring[15]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            if(p[_fast_pixel_ring[9]] > cb)
-             if(p[_fast_pixel_ring[10]] > cb)
-              if(p[_fast_pixel_ring[11]] > cb)
-               if(p[_fast_pixel_ring[12]] > cb)
-                if(p[_fast_pixel_ring[13]] > cb)
-                 if(p[_fast_pixel_ring[14]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     if(p[_fast_pixel_ring[7]] > cb)
-                      if(p[_fast_pixel_ring[8]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     if(p[_fast_pixel_ring[7]] > cb)
-                      if(p[_fast_pixel_ring[8]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else if(p[_fast_pixel_ring[9]] < c_b)
-             if(p[_fast_pixel_ring[6]] < c_b)
-              if(p[_fast_pixel_ring[7]] < c_b)
-               if(p[_fast_pixel_ring[8]] < c_b)
-                if(p[_fast_pixel_ring[10]] < c_b)
-                 if(p[_fast_pixel_ring[11]] < c_b)
-                  if(p[_fast_pixel_ring[12]] < c_b)
-                   if(p[_fast_pixel_ring[13]] < c_b)
-                    if(p[_fast_pixel_ring[5]] < c_b)
-                     if(p[_fast_pixel_ring[4]] < c_b)
-                      {}
-                     else
-                      if(p[_fast_pixel_ring[14]] < c_b)
-                       {}
-                      else
-                       continue;
-                    else
-                     if(p[_fast_pixel_ring[14]] < c_b)
-                      if(p[_fast_pixel_ring[15]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-          else if(p[_fast_pixel_ring[2]] < c_b)
-           if(p[_fast_pixel_ring[8]] > cb)
-            if(p[_fast_pixel_ring[9]] > cb)
-             if(p[_fast_pixel_ring[10]] > cb)
-              if(p[_fast_pixel_ring[11]] > cb)
-               if(p[_fast_pixel_ring[12]] > cb)
-                if(p[_fast_pixel_ring[13]] > cb)
-                 if(p[_fast_pixel_ring[14]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     if(p[_fast_pixel_ring[7]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     if(p[_fast_pixel_ring[7]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[3]] > cb)
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     if(p[_fast_pixel_ring[7]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else if(p[_fast_pixel_ring[8]] < c_b)
-            if(p[_fast_pixel_ring[6]] < c_b)
-             if(p[_fast_pixel_ring[7]] < c_b)
-              if(p[_fast_pixel_ring[9]] < c_b)
-               if(p[_fast_pixel_ring[10]] < c_b)
-                if(p[_fast_pixel_ring[11]] < c_b)
-                 if(p[_fast_pixel_ring[5]] < c_b)
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[3]] < c_b)
-                    {}
-                   else
-                    if(p[_fast_pixel_ring[12]] < c_b)
-                     if(p[_fast_pixel_ring[13]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[_fast_pixel_ring[12]] < c_b)
-                    if(p[_fast_pixel_ring[13]] < c_b)
-                     if(p[_fast_pixel_ring[14]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[12]] < c_b)
-                   if(p[_fast_pixel_ring[13]] < c_b)
-                    if(p[_fast_pixel_ring[14]] < c_b)
-                     if(p[_fast_pixel_ring[15]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-          else
-           if(p[_fast_pixel_ring[8]] > cb)
-            if(p[_fast_pixel_ring[9]] > cb)
-             if(p[_fast_pixel_ring[10]] > cb)
-              if(p[_fast_pixel_ring[11]] > cb)
-               if(p[_fast_pixel_ring[12]] > cb)
-                if(p[_fast_pixel_ring[13]] > cb)
-                 if(p[_fast_pixel_ring[14]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     if(p[_fast_pixel_ring[7]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     if(p[_fast_pixel_ring[7]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[3]] > cb)
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     if(p[_fast_pixel_ring[7]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else if(p[_fast_pixel_ring[8]] < c_b)
-            if(p[_fast_pixel_ring[6]] < c_b)
-             if(p[_fast_pixel_ring[7]] < c_b)
-              if(p[_fast_pixel_ring[9]] < c_b)
-               if(p[_fast_pixel_ring[10]] < c_b)
-                if(p[_fast_pixel_ring[11]] < c_b)
-                 if(p[_fast_pixel_ring[12]] < c_b)
-                  if(p[_fast_pixel_ring[5]] < c_b)
-                   if(p[_fast_pixel_ring[4]] < c_b)
-                    if(p[_fast_pixel_ring[3]] < c_b)
-                     {}
-                    else
-                     if(p[_fast_pixel_ring[13]] < c_b)
-                      {}
-                     else
-                      continue;
-                   else
-                    if(p[_fast_pixel_ring[13]] < c_b)
-                     if(p[_fast_pixel_ring[14]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[_fast_pixel_ring[13]] < c_b)
-                    if(p[_fast_pixel_ring[14]] < c_b)
-                     if(p[_fast_pixel_ring[15]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-         else if(p[_fast_pixel_ring[1]] < c_b)
-          if(p[_fast_pixel_ring[7]] > cb)
-           if(p[_fast_pixel_ring[8]] > cb)
-            if(p[_fast_pixel_ring[9]] > cb)
-             if(p[_fast_pixel_ring[10]] > cb)
-              if(p[_fast_pixel_ring[11]] > cb)
-               if(p[_fast_pixel_ring[12]] > cb)
-                if(p[_fast_pixel_ring[13]] > cb)
-                 if(p[_fast_pixel_ring[14]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[3]] > cb)
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                if(p[_fast_pixel_ring[2]] > cb)
-                 if(p[_fast_pixel_ring[3]] > cb)
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-          else if(p[_fast_pixel_ring[7]] < c_b)
-           if(p[_fast_pixel_ring[6]] < c_b)
-            if(p[_fast_pixel_ring[8]] < c_b)
-             if(p[_fast_pixel_ring[9]] < c_b)
-              if(p[_fast_pixel_ring[10]] < c_b)
-               if(p[_fast_pixel_ring[5]] < c_b)
-                if(p[_fast_pixel_ring[4]] < c_b)
-                 if(p[_fast_pixel_ring[3]] < c_b)
-                  if(p[_fast_pixel_ring[2]] < c_b)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[11]] < c_b)
-                    if(p[_fast_pixel_ring[12]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[11]] < c_b)
-                   if(p[_fast_pixel_ring[12]] < c_b)
-                    if(p[_fast_pixel_ring[13]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[11]] < c_b)
-                  if(p[_fast_pixel_ring[12]] < c_b)
-                   if(p[_fast_pixel_ring[13]] < c_b)
-                    if(p[_fast_pixel_ring[14]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                if(p[_fast_pixel_ring[11]] < c_b)
-                 if(p[_fast_pixel_ring[12]] < c_b)
-                  if(p[_fast_pixel_ring[13]] < c_b)
-                   if(p[_fast_pixel_ring[14]] < c_b)
-                    if(p[_fast_pixel_ring[15]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-          else
-           continue;
-         else
-          if(p[_fast_pixel_ring[7]] > cb)
-           if(p[_fast_pixel_ring[8]] > cb)
-            if(p[_fast_pixel_ring[9]] > cb)
-             if(p[_fast_pixel_ring[10]] > cb)
-              if(p[_fast_pixel_ring[11]] > cb)
-               if(p[_fast_pixel_ring[12]] > cb)
-                if(p[_fast_pixel_ring[13]] > cb)
-                 if(p[_fast_pixel_ring[14]] > cb)
-                  if(p[_fast_pixel_ring[15]] > cb)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[3]] > cb)
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                if(p[_fast_pixel_ring[2]] > cb)
-                 if(p[_fast_pixel_ring[3]] > cb)
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[6]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-          else if(p[_fast_pixel_ring[7]] < c_b)
-           if(p[_fast_pixel_ring[6]] < c_b)
-            if(p[_fast_pixel_ring[8]] < c_b)
-             if(p[_fast_pixel_ring[9]] < c_b)
-              if(p[_fast_pixel_ring[10]] < c_b)
-               if(p[_fast_pixel_ring[11]] < c_b)
-                if(p[_fast_pixel_ring[5]] < c_b)
-                 if(p[_fast_pixel_ring[4]] < c_b)
-                  if(p[_fast_pixel_ring[3]] < c_b)
-                   if(p[_fast_pixel_ring[2]] < c_b)
-                    {}
-                   else
-                    if(p[_fast_pixel_ring[12]] < c_b)
-                     {}
-                    else
-                     continue;
-                  else
-                   if(p[_fast_pixel_ring[12]] < c_b)
-                    if(p[_fast_pixel_ring[13]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[12]] < c_b)
-                   if(p[_fast_pixel_ring[13]] < c_b)
-                    if(p[_fast_pixel_ring[14]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[12]] < c_b)
-                  if(p[_fast_pixel_ring[13]] < c_b)
-                   if(p[_fast_pixel_ring[14]] < c_b)
-                    if(p[_fast_pixel_ring[15]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-          else
-           continue;
-        else if(p[_fast_pixel_ring[0]] < c_b)
-         if(p[_fast_pixel_ring[1]] > cb)
-          if(p[_fast_pixel_ring[7]] > cb)
-           if(p[_fast_pixel_ring[6]] > cb)
-            if(p[_fast_pixel_ring[8]] > cb)
-             if(p[_fast_pixel_ring[9]] > cb)
-              if(p[_fast_pixel_ring[10]] > cb)
-               if(p[_fast_pixel_ring[5]] > cb)
-                if(p[_fast_pixel_ring[4]] > cb)
-                 if(p[_fast_pixel_ring[3]] > cb)
-                  if(p[_fast_pixel_ring[2]] > cb)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[11]] > cb)
-                    if(p[_fast_pixel_ring[12]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[11]] > cb)
-                   if(p[_fast_pixel_ring[12]] > cb)
-                    if(p[_fast_pixel_ring[13]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[11]] > cb)
-                  if(p[_fast_pixel_ring[12]] > cb)
-                   if(p[_fast_pixel_ring[13]] > cb)
-                    if(p[_fast_pixel_ring[14]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                if(p[_fast_pixel_ring[11]] > cb)
-                 if(p[_fast_pixel_ring[12]] > cb)
-                  if(p[_fast_pixel_ring[13]] > cb)
-                   if(p[_fast_pixel_ring[14]] > cb)
-                    if(p[_fast_pixel_ring[15]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-          else if(p[_fast_pixel_ring[7]] < c_b)
-           if(p[_fast_pixel_ring[8]] < c_b)
-            if(p[_fast_pixel_ring[9]] < c_b)
-             if(p[_fast_pixel_ring[10]] < c_b)
-              if(p[_fast_pixel_ring[11]] < c_b)
-               if(p[_fast_pixel_ring[12]] < c_b)
-                if(p[_fast_pixel_ring[13]] < c_b)
-                 if(p[_fast_pixel_ring[14]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[3]] < c_b)
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                if(p[_fast_pixel_ring[2]] < c_b)
-                 if(p[_fast_pixel_ring[3]] < c_b)
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-          else
-           continue;
-         else if(p[_fast_pixel_ring[1]] < c_b)
-          if(p[_fast_pixel_ring[2]] > cb)
-           if(p[_fast_pixel_ring[8]] > cb)
-            if(p[_fast_pixel_ring[6]] > cb)
-             if(p[_fast_pixel_ring[7]] > cb)
-              if(p[_fast_pixel_ring[9]] > cb)
-               if(p[_fast_pixel_ring[10]] > cb)
-                if(p[_fast_pixel_ring[11]] > cb)
-                 if(p[_fast_pixel_ring[5]] > cb)
-                  if(p[_fast_pixel_ring[4]] > cb)
-                   if(p[_fast_pixel_ring[3]] > cb)
-                    {}
-                   else
-                    if(p[_fast_pixel_ring[12]] > cb)
-                     if(p[_fast_pixel_ring[13]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[_fast_pixel_ring[12]] > cb)
-                    if(p[_fast_pixel_ring[13]] > cb)
-                     if(p[_fast_pixel_ring[14]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[12]] > cb)
-                   if(p[_fast_pixel_ring[13]] > cb)
-                    if(p[_fast_pixel_ring[14]] > cb)
-                     if(p[_fast_pixel_ring[15]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else if(p[_fast_pixel_ring[8]] < c_b)
-            if(p[_fast_pixel_ring[9]] < c_b)
-             if(p[_fast_pixel_ring[10]] < c_b)
-              if(p[_fast_pixel_ring[11]] < c_b)
-               if(p[_fast_pixel_ring[12]] < c_b)
-                if(p[_fast_pixel_ring[13]] < c_b)
-                 if(p[_fast_pixel_ring[14]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     if(p[_fast_pixel_ring[7]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     if(p[_fast_pixel_ring[7]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[3]] < c_b)
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     if(p[_fast_pixel_ring[7]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-          else if(p[_fast_pixel_ring[2]] < c_b)
-           if(p[_fast_pixel_ring[3]] > cb)
-            if(p[_fast_pixel_ring[9]] > cb)
-             if(p[_fast_pixel_ring[6]] > cb)
-              if(p[_fast_pixel_ring[7]] > cb)
-               if(p[_fast_pixel_ring[8]] > cb)
-                if(p[_fast_pixel_ring[10]] > cb)
-                 if(p[_fast_pixel_ring[11]] > cb)
-                  if(p[_fast_pixel_ring[12]] > cb)
-                   if(p[_fast_pixel_ring[5]] > cb)
-                    if(p[_fast_pixel_ring[4]] > cb)
-                     {}
-                    else
-                     if(p[_fast_pixel_ring[13]] > cb)
-                      if(p[_fast_pixel_ring[14]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    if(p[_fast_pixel_ring[13]] > cb)
-                     if(p[_fast_pixel_ring[14]] > cb)
-                      if(p[_fast_pixel_ring[15]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else if(p[_fast_pixel_ring[9]] < c_b)
-             if(p[_fast_pixel_ring[10]] < c_b)
-              if(p[_fast_pixel_ring[11]] < c_b)
-               if(p[_fast_pixel_ring[12]] < c_b)
-                if(p[_fast_pixel_ring[13]] < c_b)
-                 if(p[_fast_pixel_ring[14]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     if(p[_fast_pixel_ring[7]] < c_b)
-                      if(p[_fast_pixel_ring[8]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     if(p[_fast_pixel_ring[7]] < c_b)
-                      if(p[_fast_pixel_ring[8]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else if(p[_fast_pixel_ring[3]] < c_b)
-            if(p[_fast_pixel_ring[4]] > cb)
-             if(p[_fast_pixel_ring[14]] > cb)
-              if(p[_fast_pixel_ring[6]] > cb)
-               if(p[_fast_pixel_ring[7]] > cb)
-                if(p[_fast_pixel_ring[8]] > cb)
-                 if(p[_fast_pixel_ring[9]] > cb)
-                  if(p[_fast_pixel_ring[10]] > cb)
-                   if(p[_fast_pixel_ring[11]] > cb)
-                    if(p[_fast_pixel_ring[12]] > cb)
-                     if(p[_fast_pixel_ring[13]] > cb)
-                      if(p[_fast_pixel_ring[5]] > cb)
-                       {}
-                      else
-                       if(p[_fast_pixel_ring[15]] > cb)
-                        {}
-                       else
-                        continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else if(p[_fast_pixel_ring[14]] < c_b)
-              if(p[_fast_pixel_ring[10]] > cb)
-               if(p[_fast_pixel_ring[5]] > cb)
-                if(p[_fast_pixel_ring[6]] > cb)
-                 if(p[_fast_pixel_ring[7]] > cb)
-                  if(p[_fast_pixel_ring[8]] > cb)
-                   if(p[_fast_pixel_ring[9]] > cb)
-                    if(p[_fast_pixel_ring[11]] > cb)
-                     if(p[_fast_pixel_ring[12]] > cb)
-                      if(p[_fast_pixel_ring[13]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else if(p[_fast_pixel_ring[10]] < c_b)
-               if(p[_fast_pixel_ring[11]] < c_b)
-                if(p[_fast_pixel_ring[12]] < c_b)
-                 if(p[_fast_pixel_ring[13]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     if(p[_fast_pixel_ring[7]] < c_b)
-                      if(p[_fast_pixel_ring[8]] < c_b)
-                       if(p[_fast_pixel_ring[9]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              if(p[_fast_pixel_ring[5]] > cb)
-               if(p[_fast_pixel_ring[6]] > cb)
-                if(p[_fast_pixel_ring[7]] > cb)
-                 if(p[_fast_pixel_ring[8]] > cb)
-                  if(p[_fast_pixel_ring[9]] > cb)
-                   if(p[_fast_pixel_ring[10]] > cb)
-                    if(p[_fast_pixel_ring[11]] > cb)
-                     if(p[_fast_pixel_ring[12]] > cb)
-                      if(p[_fast_pixel_ring[13]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-            else if(p[_fast_pixel_ring[4]] < c_b)
-             if(p[_fast_pixel_ring[5]] > cb)
-              if(p[_fast_pixel_ring[15]] < c_b)
-               if(p[_fast_pixel_ring[11]] > cb)
-                if(p[_fast_pixel_ring[6]] > cb)
-                 if(p[_fast_pixel_ring[7]] > cb)
-                  if(p[_fast_pixel_ring[8]] > cb)
-                   if(p[_fast_pixel_ring[9]] > cb)
-                    if(p[_fast_pixel_ring[10]] > cb)
-                     if(p[_fast_pixel_ring[12]] > cb)
-                      if(p[_fast_pixel_ring[13]] > cb)
-                       if(p[_fast_pixel_ring[14]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else if(p[_fast_pixel_ring[11]] < c_b)
-                if(p[_fast_pixel_ring[12]] < c_b)
-                 if(p[_fast_pixel_ring[13]] < c_b)
-                  if(p[_fast_pixel_ring[14]] < c_b)
-                   {}
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               if(p[_fast_pixel_ring[6]] > cb)
-                if(p[_fast_pixel_ring[7]] > cb)
-                 if(p[_fast_pixel_ring[8]] > cb)
-                  if(p[_fast_pixel_ring[9]] > cb)
-                   if(p[_fast_pixel_ring[10]] > cb)
-                    if(p[_fast_pixel_ring[11]] > cb)
-                     if(p[_fast_pixel_ring[12]] > cb)
-                      if(p[_fast_pixel_ring[13]] > cb)
-                       if(p[_fast_pixel_ring[14]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-             else if(p[_fast_pixel_ring[5]] < c_b)
-              if(p[_fast_pixel_ring[6]] > cb)
-               if(p[_fast_pixel_ring[12]] > cb)
-                if(p[_fast_pixel_ring[7]] > cb)
-                 if(p[_fast_pixel_ring[8]] > cb)
-                  if(p[_fast_pixel_ring[9]] > cb)
-                   if(p[_fast_pixel_ring[10]] > cb)
-                    if(p[_fast_pixel_ring[11]] > cb)
-                     if(p[_fast_pixel_ring[13]] > cb)
-                      if(p[_fast_pixel_ring[14]] > cb)
-                       if(p[_fast_pixel_ring[15]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else if(p[_fast_pixel_ring[12]] < c_b)
-                if(p[_fast_pixel_ring[13]] < c_b)
-                 if(p[_fast_pixel_ring[14]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else if(p[_fast_pixel_ring[6]] < c_b)
-               if(p[_fast_pixel_ring[7]] < c_b)
-                if(p[_fast_pixel_ring[8]] < c_b)
-                 if(p[_fast_pixel_ring[9]] < c_b)
-                  {}
-                 else
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[14]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                if(p[_fast_pixel_ring[13]] < c_b)
-                 if(p[_fast_pixel_ring[14]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-              else
-               if(p[_fast_pixel_ring[12]] < c_b)
-                if(p[_fast_pixel_ring[13]] < c_b)
-                 if(p[_fast_pixel_ring[14]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-             else
-              if(p[_fast_pixel_ring[11]] > cb)
-               if(p[_fast_pixel_ring[6]] > cb)
-                if(p[_fast_pixel_ring[7]] > cb)
-                 if(p[_fast_pixel_ring[8]] > cb)
-                  if(p[_fast_pixel_ring[9]] > cb)
-                   if(p[_fast_pixel_ring[10]] > cb)
-                    if(p[_fast_pixel_ring[12]] > cb)
-                     if(p[_fast_pixel_ring[13]] > cb)
-                      if(p[_fast_pixel_ring[14]] > cb)
-                       if(p[_fast_pixel_ring[15]] > cb)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else if(p[_fast_pixel_ring[11]] < c_b)
-               if(p[_fast_pixel_ring[12]] < c_b)
-                if(p[_fast_pixel_ring[13]] < c_b)
-                 if(p[_fast_pixel_ring[14]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-            else
-             if(p[_fast_pixel_ring[10]] > cb)
-              if(p[_fast_pixel_ring[6]] > cb)
-               if(p[_fast_pixel_ring[7]] > cb)
-                if(p[_fast_pixel_ring[8]] > cb)
-                 if(p[_fast_pixel_ring[9]] > cb)
-                  if(p[_fast_pixel_ring[11]] > cb)
-                   if(p[_fast_pixel_ring[12]] > cb)
-                    if(p[_fast_pixel_ring[13]] > cb)
-                     if(p[_fast_pixel_ring[14]] > cb)
-                      if(p[_fast_pixel_ring[5]] > cb)
-                       {}
-                      else
-                       if(p[_fast_pixel_ring[15]] > cb)
-                        {}
-                       else
-                        continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else if(p[_fast_pixel_ring[10]] < c_b)
-              if(p[_fast_pixel_ring[11]] < c_b)
-               if(p[_fast_pixel_ring[12]] < c_b)
-                if(p[_fast_pixel_ring[13]] < c_b)
-                 if(p[_fast_pixel_ring[14]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     if(p[_fast_pixel_ring[7]] < c_b)
-                      if(p[_fast_pixel_ring[8]] < c_b)
-                       if(p[_fast_pixel_ring[9]] < c_b)
-                        {}
-                       else
-                        continue;
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-           else
-            if(p[_fast_pixel_ring[9]] > cb)
-             if(p[_fast_pixel_ring[6]] > cb)
-              if(p[_fast_pixel_ring[7]] > cb)
-               if(p[_fast_pixel_ring[8]] > cb)
-                if(p[_fast_pixel_ring[10]] > cb)
-                 if(p[_fast_pixel_ring[11]] > cb)
-                  if(p[_fast_pixel_ring[12]] > cb)
-                   if(p[_fast_pixel_ring[13]] > cb)
-                    if(p[_fast_pixel_ring[5]] > cb)
-                     if(p[_fast_pixel_ring[4]] > cb)
-                      {}
-                     else
-                      if(p[_fast_pixel_ring[14]] > cb)
-                       {}
-                      else
-                       continue;
-                    else
-                     if(p[_fast_pixel_ring[14]] > cb)
-                      if(p[_fast_pixel_ring[15]] > cb)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else if(p[_fast_pixel_ring[9]] < c_b)
-             if(p[_fast_pixel_ring[10]] < c_b)
-              if(p[_fast_pixel_ring[11]] < c_b)
-               if(p[_fast_pixel_ring[12]] < c_b)
-                if(p[_fast_pixel_ring[13]] < c_b)
-                 if(p[_fast_pixel_ring[14]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     if(p[_fast_pixel_ring[7]] < c_b)
-                      if(p[_fast_pixel_ring[8]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     if(p[_fast_pixel_ring[7]] < c_b)
-                      if(p[_fast_pixel_ring[8]] < c_b)
-                       {}
-                      else
-                       continue;
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-          else
-           if(p[_fast_pixel_ring[8]] > cb)
-            if(p[_fast_pixel_ring[6]] > cb)
-             if(p[_fast_pixel_ring[7]] > cb)
-              if(p[_fast_pixel_ring[9]] > cb)
-               if(p[_fast_pixel_ring[10]] > cb)
-                if(p[_fast_pixel_ring[11]] > cb)
-                 if(p[_fast_pixel_ring[12]] > cb)
-                  if(p[_fast_pixel_ring[5]] > cb)
-                   if(p[_fast_pixel_ring[4]] > cb)
-                    if(p[_fast_pixel_ring[3]] > cb)
-                     {}
-                    else
-                     if(p[_fast_pixel_ring[13]] > cb)
-                      {}
-                     else
-                      continue;
-                   else
-                    if(p[_fast_pixel_ring[13]] > cb)
-                     if(p[_fast_pixel_ring[14]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                  else
-                   if(p[_fast_pixel_ring[13]] > cb)
-                    if(p[_fast_pixel_ring[14]] > cb)
-                     if(p[_fast_pixel_ring[15]] > cb)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else if(p[_fast_pixel_ring[8]] < c_b)
-            if(p[_fast_pixel_ring[9]] < c_b)
-             if(p[_fast_pixel_ring[10]] < c_b)
-              if(p[_fast_pixel_ring[11]] < c_b)
-               if(p[_fast_pixel_ring[12]] < c_b)
-                if(p[_fast_pixel_ring[13]] < c_b)
-                 if(p[_fast_pixel_ring[14]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     if(p[_fast_pixel_ring[7]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     if(p[_fast_pixel_ring[7]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[3]] < c_b)
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     if(p[_fast_pixel_ring[7]] < c_b)
-                      {}
-                     else
-                      continue;
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-         else
-          if(p[_fast_pixel_ring[7]] > cb)
-           if(p[_fast_pixel_ring[6]] > cb)
-            if(p[_fast_pixel_ring[8]] > cb)
-             if(p[_fast_pixel_ring[9]] > cb)
-              if(p[_fast_pixel_ring[10]] > cb)
-               if(p[_fast_pixel_ring[11]] > cb)
-                if(p[_fast_pixel_ring[5]] > cb)
-                 if(p[_fast_pixel_ring[4]] > cb)
-                  if(p[_fast_pixel_ring[3]] > cb)
-                   if(p[_fast_pixel_ring[2]] > cb)
-                    {}
-                   else
-                    if(p[_fast_pixel_ring[12]] > cb)
-                     {}
-                    else
-                     continue;
-                  else
-                   if(p[_fast_pixel_ring[12]] > cb)
-                    if(p[_fast_pixel_ring[13]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[12]] > cb)
-                   if(p[_fast_pixel_ring[13]] > cb)
-                    if(p[_fast_pixel_ring[14]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[12]] > cb)
-                  if(p[_fast_pixel_ring[13]] > cb)
-                   if(p[_fast_pixel_ring[14]] > cb)
-                    if(p[_fast_pixel_ring[15]] > cb)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-          else if(p[_fast_pixel_ring[7]] < c_b)
-           if(p[_fast_pixel_ring[8]] < c_b)
-            if(p[_fast_pixel_ring[9]] < c_b)
-             if(p[_fast_pixel_ring[10]] < c_b)
-              if(p[_fast_pixel_ring[11]] < c_b)
-               if(p[_fast_pixel_ring[12]] < c_b)
-                if(p[_fast_pixel_ring[13]] < c_b)
-                 if(p[_fast_pixel_ring[14]] < c_b)
-                  if(p[_fast_pixel_ring[15]] < c_b)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[3]] < c_b)
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                if(p[_fast_pixel_ring[2]] < c_b)
-                 if(p[_fast_pixel_ring[3]] < c_b)
-                  if(p[_fast_pixel_ring[4]] < c_b)
-                   if(p[_fast_pixel_ring[5]] < c_b)
-                    if(p[_fast_pixel_ring[6]] < c_b)
-                     {}
-                    else
-                     continue;
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-              else
-               continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-          else
-           continue;
-        else
-         if(p[_fast_pixel_ring[6]] > cb)
-          if(p[_fast_pixel_ring[7]] > cb)
-           if(p[_fast_pixel_ring[8]] > cb)
-            if(p[_fast_pixel_ring[9]] > cb)
-             if(p[_fast_pixel_ring[10]] > cb)
-              if(p[_fast_pixel_ring[5]] > cb)
-               if(p[_fast_pixel_ring[4]] > cb)
-                if(p[_fast_pixel_ring[3]] > cb)
-                 if(p[_fast_pixel_ring[2]] > cb)
-                  if(p[_fast_pixel_ring[1]] > cb)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[11]] > cb)
-                    {}
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[11]] > cb)
-                   if(p[_fast_pixel_ring[12]] > cb)
-                    {}
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[11]] > cb)
-                  if(p[_fast_pixel_ring[12]] > cb)
-                   if(p[_fast_pixel_ring[13]] > cb)
-                    {}
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                if(p[_fast_pixel_ring[11]] > cb)
-                 if(p[_fast_pixel_ring[12]] > cb)
-                  if(p[_fast_pixel_ring[13]] > cb)
-                   if(p[_fast_pixel_ring[14]] > cb)
-                    {}
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-              else
-               if(p[_fast_pixel_ring[11]] > cb)
-                if(p[_fast_pixel_ring[12]] > cb)
-                 if(p[_fast_pixel_ring[13]] > cb)
-                  if(p[_fast_pixel_ring[14]] > cb)
-                   if(p[_fast_pixel_ring[15]] > cb)
-                    {}
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-          else
-           continue;
-         else if(p[_fast_pixel_ring[6]] < c_b)
-          if(p[_fast_pixel_ring[7]] < c_b)
-           if(p[_fast_pixel_ring[8]] < c_b)
-            if(p[_fast_pixel_ring[9]] < c_b)
-             if(p[_fast_pixel_ring[10]] < c_b)
-              if(p[_fast_pixel_ring[5]] < c_b)
-               if(p[_fast_pixel_ring[4]] < c_b)
-                if(p[_fast_pixel_ring[3]] < c_b)
-                 if(p[_fast_pixel_ring[2]] < c_b)
-                  if(p[_fast_pixel_ring[1]] < c_b)
-                   {}
-                  else
-                   if(p[_fast_pixel_ring[11]] < c_b)
-                    {}
-                   else
-                    continue;
-                 else
-                  if(p[_fast_pixel_ring[11]] < c_b)
-                   if(p[_fast_pixel_ring[12]] < c_b)
-                    {}
-                   else
-                    continue;
-                  else
-                   continue;
-                else
-                 if(p[_fast_pixel_ring[11]] < c_b)
-                  if(p[_fast_pixel_ring[12]] < c_b)
-                   if(p[_fast_pixel_ring[13]] < c_b)
-                    {}
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-               else
-                if(p[_fast_pixel_ring[11]] < c_b)
-                 if(p[_fast_pixel_ring[12]] < c_b)
-                  if(p[_fast_pixel_ring[13]] < c_b)
-                   if(p[_fast_pixel_ring[14]] < c_b)
-                    {}
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-              else
-               if(p[_fast_pixel_ring[11]] < c_b)
-                if(p[_fast_pixel_ring[12]] < c_b)
-                 if(p[_fast_pixel_ring[13]] < c_b)
-                  if(p[_fast_pixel_ring[14]] < c_b)
-                   if(p[_fast_pixel_ring[15]] < c_b)
-                    {}
-                   else
-                    continue;
-                  else
-                   continue;
-                 else
-                  continue;
-                else
-                 continue;
-               else
-                continue;
-             else
-              continue;
-            else
-             continue;
-           else
-            continue;
-          else
-           continue;
-         else
-          continue;
+            corner.pos.x = rowCorners[static_cast<std::size_t>(i)];
             corners.push_back(corner);
         }
     }
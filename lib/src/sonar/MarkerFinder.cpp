@@ -80,6 +80,11 @@ vector<Point2f> MarkerFinder::findMarker(const ImageRef<uchar> & grayImage, bool
     return _unwarpPoints(currentMarkerCorners, cast<float>(grayImage.size()), horizontalFlipping, verticalFlipping);
 }
 
+vector<Point2f> MarkerFinder::findMarker(const FrameData & frameData, bool horizontalFlipping, bool verticalFlipping)
+{
+    return findMarker(frameData.image(0), horizontalFlipping, verticalFlipping);
+}
+
 tuple<Matrix3f, bool> MarkerFinder::findAffineTransformOfMarker(const ImageRef<uchar> & grayImage)
 {
     vector<Point2f> markerCorners = findMarker(grayImage);
@@ -191,6 +196,24 @@ Pose_f MarkerFinder::getPose(const vector<Point2f> & imageMarkerCorners, const E
 }
 
 
+Image<uchar> MarkerFinder::rectifyMarker(const ImageRef<uchar> & grayImage, const vector<Point2f> & imageMarkerCorners,
+                                         const Size2i & size) const
+{
+    assert((size.x > 0) && (size.y > 0));
+    Matrix3f H = computeHomographyTransformOfMarker(imageMarkerCorners);
+    // Sign of homography from SVD is arbitrary, but warp takes points with w <= 0 as outside of image
+    if ((H * Vector3f(0.5f, 0.5f, 1.0f)).z() < 0.0f)
+        H = - H;
+    // centers of pixels of out image to uv coordinates of marker
+    Matrix3f S;
+    S << 1.0f / size.x, 0.0f, 0.5f / size.x,
+         0.0f, 1.0f / size.y, 0.5f / size.y,
+         0.0f, 0.0f, 1.0f;
+    Image<uchar> markerImage(size);
+    image_utils::warpPerspective(markerImage, grayImage, H * S);
+    return markerImage;
+}
+
 cv::Mat MarkerFinder::_prepeareFrameForMarkerDetection(const ImageRef<uchar> & frame, bool horizontalFlipping, bool verticalFlipping) const
 {
     cv::Mat cvFrame = image_utils::convertToCvMat(frame);
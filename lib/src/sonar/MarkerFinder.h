@@ -20,6 +20,7 @@
 #include "global_types.h"
 #include "sonar/General/Point2.h"
 #include "sonar/General/Image.h"
+#include "sonar/ImageTools/FrameData.h"
 
 namespace sonar {
 
@@ -58,6 +59,10 @@ public:
     std::vector<Point2f> findMarker(const ImageRef<uchar> & grayImage, 
                                     bool horizontalFlipping = false, bool verticalFlipping = false);
 
+    /// Do finding of marker on the first level of frame, which is shared with other consumers of frame
+    std::vector<Point2f> findMarker(const FrameData & frameData,
+                                    bool horizontalFlipping = false, bool verticalFlipping = false);
+
     /// Get affine transform of marker (just test fnction).
     /// @param markerCorners - image coordinates of marker corners.
     /// @return aproximated affine matrix
@@ -81,6 +86,12 @@ public:
     /// Get pose from pixel coordinates of marker corners
     Pose_f getPose(const std::vector<Point2f> & imageMarkerCorners, const Eigen::Matrix3f & K);
 
+    /// Get image of marker interior rectified to square view (for reading of bits or debug view)
+    /// @param size - size of out image, marker is scaled to it
+    /// @return image of marker, pixels outside of gray image are zero
+    Image<uchar> rectifyMarker(const ImageRef<uchar> & grayImage, const std::vector<Point2f> & imageMarkerCorners,
+                               const Size2i & size) const;
+
 private:
     cv::Ptr<cv::aruco::Dictionary> m_dictionary;
     cv::Ptr<cv::aruco::DetectorParameters> m_detectorParameters;
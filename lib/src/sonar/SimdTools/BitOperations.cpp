@@ -0,0 +1,434 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "BitOperations.h"
+#include "CpuFeatures.h"
+
+#include <cassert>
+#include <cstring>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+// SIMD versions of packing and unpacking process whole words (64 pixels), the last partial word is done
+// by scalar code. Popcount of SSE2 is scalar, SSE2 has no byte shuffles for table of nibbles.
+
+using PackBitsFunction = void (*)(std::uint64_t * out, const uchar * in, int width, uchar threshold);
+using UnpackBitsFunction = void (*)(uchar * out, const std::uint64_t * in, int width, uchar zero, uchar one);
+using BitwiseFunction = void (*)(std::uint64_t * out, const std::uint64_t * a, const std::uint64_t * b,
+                                 int beginWord, int endWord, BitOperation operation);
+using CountBitsFunction = std::int64_t (*)(const std::uint64_t * in, int numberWords);
+
+int countBits(std::uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    word = word - ((word >> 1) & 0x5555555555555555ULL);
+    word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+    word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<int>((word * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+int trailingZeros(std::uint64_t word)
+{
+    assert(word != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    // The lowest set bit is isolated and counted as the number of ones below it
+    return countBits((word & (0 - word)) - 1);
+#endif
+}
+
+static void _packBits_scalar(std::uint64_t * out, const uchar * in, int beginWord, int width, uchar threshold)
+{
+    const int numberWords = (width + 63) >> 6;
+    for (int i = beginWord; i < numberWords; ++i)
+    {
+        const int endX = (((i + 1) << 6) < width) ? ((i + 1) << 6) : width;
+        std::uint64_t word = 0;
+        for (int x = i << 6; x < endX; ++x)
+            word |= static_cast<std::uint64_t>(in[x] > threshold) << (x & 63);
+        out[i] = word;
+    }
+}
+
+static void _packBits_scalar(std::uint64_t * out, const uchar * in, int width, uchar threshold)
+{
+    _packBits_scalar(out, in, 0, width, threshold);
+}
+
+static void _unpackBits_scalar(uchar * out, const std::uint64_t * in, int beginX, int endX, uchar zero, uchar one)
+{
+    for (int x = beginX; x < endX; ++x)
+        out[x] = ((in[x >> 6] >> (x & 63)) & 1) ? one : zero;
+}
+
+static void _unpackBits_scalar(uchar * out, const std::uint64_t * in, int width, uchar zero, uchar one)
+{
+    _unpackBits_scalar(out, in, 0, width, zero, one);
+}
+
+static void _bitwise_scalar(std::uint64_t * out, const std::uint64_t * a, const std::uint64_t * b,
+                            int beginWord, int endWord, BitOperation operation)
+{
+    switch (operation)
+    {
+    case BitOperation::And:
+        for (int i = beginWord; i < endWord; ++i)
+            out[i] = a[i] & b[i];
+        break;
+    case BitOperation::Or:
+        for (int i = beginWord; i < endWord; ++i)
+            out[i] = a[i] | b[i];
+        break;
+    case BitOperation::Xor:
+        for (int i = beginWord; i < endWord; ++i)
+            out[i] = a[i] ^ b[i];
+        break;
+    case BitOperation::AndNot:
+        for (int i = beginWord; i < endWord; ++i)
+            out[i] = a[i] & ~b[i];
+        break;
+    }
+}
+
+static std::int64_t _countBits_scalar(const std::uint64_t * in, int numberWords)
+{
+    std::int64_t count = 0;
+    for (int i = 0; i < numberWords; ++i)
+        count += countBits(in[i]);
+    return count;
+}
+
+#if defined(SONAR_SIMD_X86)
+
+SONAR_TARGET_SSE2
+static void _packBits_sse2(std::uint64_t * out, const uchar * in, int width, uchar threshold)
+{
+    // Unsigned comparison by signed comparison of values with inverted high bit
+    const __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m128i vThreshold = _mm_set1_epi8(static_cast<char>(threshold ^ 0x80));
+    const int numberFullWords = width >> 6;
+    for (int i = 0; i < numberFullWords; ++i)
+    {
+        std::uint64_t word = 0;
+        for (int k = 0; k < 4; ++k)
+        {
+            __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[(i << 6) + k * 16])), sign);
+            std::uint64_t bits = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, vThreshold)));
+            word |= bits << (k * 16);
+        }
+        out[i] = word;
+    }
+    _packBits_scalar(out, in, numberFullWords, width, threshold);
+}
+
+SONAR_TARGET_SSE2
+static void _unpackBits_sse2(uchar * out, const std::uint64_t * in, int width, uchar zero, uchar one)
+{
+    const __m128i bitMask = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i vZero = _mm_set1_epi8(static_cast<char>(zero));
+    const __m128i vOne = _mm_set1_epi8(static_cast<char>(one));
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        unsigned int bits = static_cast<unsigned int>(in[x >> 6] >> (x & 63));
+        // Bytes of first 8 pixels are the low byte of bits, bytes of next 8 pixels are the next byte
+        __m128i v = _mm_unpacklo_epi64(_mm_set1_epi8(static_cast<char>(bits & 0xFF)),
+                                       _mm_set1_epi8(static_cast<char>((bits >> 8) & 0xFF)));
+        __m128i m = _mm_cmpeq_epi8(_mm_and_si128(v, bitMask), bitMask);
+        __m128i r = _mm_or_si128(_mm_and_si128(m, vOne), _mm_andnot_si128(m, vZero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[x]), r);
+    }
+    _unpackBits_scalar(out, in, x, width, zero, one);
+}
+
+SONAR_TARGET_SSE2
+static void _bitwise_sse2(std::uint64_t * out, const std::uint64_t * a, const std::uint64_t * b,
+                          int beginWord, int endWord, BitOperation operation)
+{
+    int i = beginWord;
+    for (; i + 2 <= endWord; i += 2)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&a[i]));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&b[i]));
+        __m128i r;
+        switch (operation)
+        {
+        case BitOperation::And: r = _mm_and_si128(va, vb); break;
+        case BitOperation::Or: r = _mm_or_si128(va, vb); break;
+        case BitOperation::Xor: r = _mm_xor_si128(va, vb); break;
+        default: r = _mm_andnot_si128(vb, va); break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), r);
+    }
+    _bitwise_scalar(out, a, b, i, endWord, operation);
+}
+
+SONAR_TARGET_AVX2
+static void _packBits_avx2(std::uint64_t * out, const uchar * in, int width, uchar threshold)
+{
+    const __m256i sign = _mm256_set1_epi8(static_cast<char>(0x80));
+    const __m256i vThreshold = _mm256_set1_epi8(static_cast<char>(threshold ^ 0x80));
+    const int numberFullWords = width >> 6;
+    for (int i = 0; i < numberFullWords; ++i)
+    {
+        __m256i v0 = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&in[i << 6])), sign);
+        __m256i v1 = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&in[(i << 6) + 32])), sign);
+        std::uint64_t low = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(v0, vThreshold)));
+        std::uint64_t high = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(v1, vThreshold)));
+        out[i] = low | (high << 32);
+    }
+    _packBits_scalar(out, in, numberFullWords, width, threshold);
+}
+
+SONAR_TARGET_AVX2
+static void _unpackBits_avx2(uchar * out, const std::uint64_t * in, int width, uchar zero, uchar one)
+{
+    // Byte k of 32 bits is spread to bytes 8k..8k+7
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i bitMask = _mm256_set1_epi64x(static_cast<long long>(0x8040201008040201ULL));
+    const __m256i vZero = _mm256_set1_epi8(static_cast<char>(zero));
+    const __m256i vOne = _mm256_set1_epi8(static_cast<char>(one));
+    int x = 0;
+    for (; x + 32 <= width; x += 32)
+    {
+        int bits = static_cast<int>(static_cast<std::uint32_t>(in[x >> 6] >> (x & 63)));
+        // shuffle_epi8 works inside 128 bits lanes, so both lanes get all 4 bytes
+        __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32(bits), spread);
+        __m256i m = _mm256_cmpeq_epi8(_mm256_and_si256(v, bitMask), bitMask);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[x]), _mm256_blendv_epi8(vZero, vOne, m));
+    }
+    _unpackBits_scalar(out, in, x, width, zero, one);
+}
+
+SONAR_TARGET_AVX2
+static void _bitwise_avx2(std::uint64_t * out, const std::uint64_t * a, const std::uint64_t * b,
+                          int beginWord, int endWord, BitOperation operation)
+{
+    int i = beginWord;
+    for (; i + 4 <= endWord; i += 4)
+    {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&a[i]));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&b[i]));
+        __m256i r;
+        switch (operation)
+        {
+        case BitOperation::And: r = _mm256_and_si256(va, vb); break;
+        case BitOperation::Or: r = _mm256_or_si256(va, vb); break;
+        case BitOperation::Xor: r = _mm256_xor_si256(va, vb); break;
+        default: r = _mm256_andnot_si256(vb, va); break;
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[i]), r);
+    }
+    _bitwise_scalar(out, a, b, i, endWord, operation);
+}
+
+/// Popcount by table of nibbles, counts of bytes are summed by sad
+SONAR_TARGET_AVX2
+static std::int64_t _countBits_avx2(const std::uint64_t * in, int numberWords)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0F);
+    __m256i sum = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 4 <= numberWords; i += 4)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&in[i]));
+        __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(v, lowMask)),
+                                         _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask)));
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+    std::int64_t parts[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(parts), sum);
+    return parts[0] + parts[1] + parts[2] + parts[3] + _countBits_scalar(&in[i], numberWords - i);
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+static void _packBits_neon(std::uint64_t * out, const uchar * in, int width, uchar threshold)
+{
+    static const uint8_t weights[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    const uint8x16_t bitWeights = vld1q_u8(weights);
+    const uint8x16_t vThreshold = vdupq_n_u8(threshold);
+    const int numberFullWords = width >> 6;
+    for (int i = 0; i < numberFullWords; ++i)
+    {
+        std::uint64_t word = 0;
+        for (int k = 0; k < 4; ++k)
+        {
+            uint8x16_t m = vandq_u8(vcgtq_u8(vld1q_u8(&in[(i << 6) + k * 16]), vThreshold), bitWeights);
+            // Sums of weights of halves are the bytes of bits
+            uint8x8_t p = vpadd_u8(vget_low_u8(m), vget_high_u8(m));
+            p = vpadd_u8(p, p);
+            p = vpadd_u8(p, p);
+            word |= static_cast<std::uint64_t>(vget_lane_u16(vreinterpret_u16_u8(p), 0)) << (k * 16);
+        }
+        out[i] = word;
+    }
+    _packBits_scalar(out, in, numberFullWords, width, threshold);
+}
+
+static void _unpackBits_neon(uchar * out, const std::uint64_t * in, int width, uchar zero, uchar one)
+{
+    static const uint8_t masks[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+    const uint8x8_t bitMask = vld1_u8(masks);
+    const uint8x16_t vZero = vdupq_n_u8(zero);
+    const uint8x16_t vOne = vdupq_n_u8(one);
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        unsigned int bits = static_cast<unsigned int>(in[x >> 6] >> (x & 63));
+        uint8x16_t m = vcombine_u8(vtst_u8(vdup_n_u8(static_cast<uint8_t>(bits & 0xFF)), bitMask),
+                                   vtst_u8(vdup_n_u8(static_cast<uint8_t>((bits >> 8) & 0xFF)), bitMask));
+        vst1q_u8(&out[x], vbslq_u8(m, vOne, vZero));
+    }
+    _unpackBits_scalar(out, in, x, width, zero, one);
+}
+
+static void _bitwise_neon(std::uint64_t * out, const std::uint64_t * a, const std::uint64_t * b,
+                          int beginWord, int endWord, BitOperation operation)
+{
+    int i = beginWord;
+    for (; i + 2 <= endWord; i += 2)
+    {
+        uint64x2_t va = vld1q_u64(&a[i]);
+        uint64x2_t vb = vld1q_u64(&b[i]);
+        uint64x2_t r;
+        switch (operation)
+        {
+        case BitOperation::And: r = vandq_u64(va, vb); break;
+        case BitOperation::Or: r = vorrq_u64(va, vb); break;
+        case BitOperation::Xor: r = veorq_u64(va, vb); break;
+        default: r = vbicq_u64(va, vb); break;
+        }
+        vst1q_u64(&out[i], r);
+    }
+    _bitwise_scalar(out, a, b, i, endWord, operation);
+}
+
+static std::int64_t _countBits_neon(const std::uint64_t * in, int numberWords)
+{
+    uint64x2_t sum = vdupq_n_u64(0);
+    int i = 0;
+    for (; i + 2 <= numberWords; i += 2)
+    {
+        uint8x16_t counts = vcntq_u8(vreinterpretq_u8_u64(vld1q_u64(&in[i])));
+        sum = vaddq_u64(sum, vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(counts))));
+    }
+    return static_cast<std::int64_t>(vgetq_lane_u64(sum, 0) + vgetq_lane_u64(sum, 1)) +
+            _countBits_scalar(&in[i], numberWords - i);
+}
+
+#endif
+
+static PackBitsFunction _selectPackBits()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _packBits_avx2;
+    if (features.sse2)
+        return _packBits_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _packBits_neon;
+#endif
+    (void)features;
+    return _packBits_scalar;
+}
+
+static UnpackBitsFunction _selectUnpackBits()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _unpackBits_avx2;
+    if (features.sse2)
+        return _unpackBits_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _unpackBits_neon;
+#endif
+    (void)features;
+    return _unpackBits_scalar;
+}
+
+static BitwiseFunction _selectBitwise()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _bitwise_avx2;
+    if (features.sse2)
+        return _bitwise_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _bitwise_neon;
+#endif
+    (void)features;
+    return _bitwise_scalar;
+}
+
+static CountBitsFunction _selectCountBits()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _countBits_avx2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _countBits_neon;
+#endif
+    (void)features;
+    return _countBits_scalar;
+}
+
+void packBits_u(std::uint64_t * out, const uchar * in, int width, uchar threshold)
+{
+    static const KernelDispatch<PackBitsFunction> function(_selectPackBits);
+    assert(width >= 0);
+    function(out, in, width, threshold);
+}
+
+void unpackBits_u(uchar * out, const std::uint64_t * in, int width, uchar zero, uchar one)
+{
+    static const KernelDispatch<UnpackBitsFunction> function(_selectUnpackBits);
+    assert(width >= 0);
+    function(out, in, width, zero, one);
+}
+
+void bitwise_u64(std::uint64_t * out, const std::uint64_t * a, const std::uint64_t * b, int numberWords,
+                 BitOperation operation)
+{
+    static const KernelDispatch<BitwiseFunction> function(_selectBitwise);
+    function(out, a, b, 0, numberWords, operation);
+}
+
+std::int64_t countBits_u64(const std::uint64_t * in, int numberWords)
+{
+    static const KernelDispatch<CountBitsFunction> function(_selectCountBits);
+    return function(in, numberWords);
+}
+
+} // namespace simd
+
+} // namespace sonar
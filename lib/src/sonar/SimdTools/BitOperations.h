@@ -0,0 +1,51 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_BITOPERATIONS_H
+#define SONAR_SIMD_BITOPERATIONS_H
+
+#include <cstdint>
+
+namespace sonar {
+
+namespace simd {
+
+// Rows of binary images are stored in 64 bits words, pixel x is bit (x & 63) of word (x >> 6).
+// Implementations (SSE2, AVX2, NEON or scalar) are selected on first call by features of processor.
+
+enum class BitOperation
+{
+    And,
+    Or,
+    Xor,
+    AndNot // a & ~b
+};
+
+/// Packing of row of 8 bits image to bits: bit is set if in[x] > threshold.
+/// All (width + 63) / 64 words are written, bits after width are zero.
+void packBits_u(std::uint64_t * out, const unsigned char * in, int width, unsigned char threshold);
+
+/// Unpacking of row of bits to 8 bits values: zero for unset bits and one for set bits
+void unpackBits_u(unsigned char * out, const std::uint64_t * in, int width, unsigned char zero, unsigned char one);
+
+/// out[i] = a[i] op b[i], out can be the same as a or b
+void bitwise_u64(std::uint64_t * out, const std::uint64_t * a, const std::uint64_t * b, int numberWords,
+                 BitOperation operation);
+
+/// Number of set bits
+std::int64_t countBits_u64(const std::uint64_t * in, int numberWords);
+
+/// Number of set bits of one word, it is used for partial words of rows
+int countBits(std::uint64_t word);
+
+/// Index of the lowest set bit, word must not be zero
+int trailingZeros(std::uint64_t word);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_BITOPERATIONS_H
@@ -0,0 +1,121 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "CpuFeatures.h"
+
+#if defined(SONAR_SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+static CpuFeatures _detectCpuFeatures()
+{
+    CpuFeatures features;
+    features.sse2 = false;
+    features.sse41 = false;
+    features.avx2 = false;
+    features.f16c = false;
+    features.avx512 = false;
+    features.neon = false;
+#if defined(SONAR_SIMD_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int maxId = info[0];
+    __cpuid(info, 1);
+    features.sse2 = ((info[3] & (1 << 26)) != 0);
+    features.sse41 = ((info[2] & (1 << 19)) != 0);
+    bool osxsave = ((info[2] & (1 << 27)) != 0);
+    bool avx = ((info[2] & (1 << 28)) != 0);
+    // Registers ymm (and zmm with opmasks for AVX-512) must be saved by operating system
+    unsigned long long xcr0 = osxsave ? _xgetbv(0) : 0;
+    bool osYmm = ((xcr0 & 0x6) == 0x6);
+    bool osZmm = ((xcr0 & 0xe6) == 0xe6);
+    features.f16c = avx && osYmm && ((info[2] & (1 << 29)) != 0);
+    if (avx && osYmm && (maxId >= 7))
+    {
+        __cpuidex(info, 7, 0);
+        features.avx2 = ((info[1] & (1 << 5)) != 0);
+        features.avx512 = osZmm && ((info[1] & (1 << 16)) != 0) && ((info[1] & (1 << 30)) != 0);
+    }
+#else
+    __builtin_cpu_init();
+    features.sse2 = (__builtin_cpu_supports("sse2") != 0);
+    features.sse41 = (__builtin_cpu_supports("sse4.1") != 0);
+    features.avx2 = (__builtin_cpu_supports("avx2") != 0);
+    features.f16c = (__builtin_cpu_supports("avx") != 0) && (__builtin_cpu_supports("f16c") != 0);
+    features.avx512 = (__builtin_cpu_supports("avx512f") != 0) && (__builtin_cpu_supports("avx512bw") != 0);
+#endif
+#elif defined(SONAR_SIMD_NEON)
+    features.neon = true;
+#endif
+    return features;
+}
+
+enum FeatureBits: unsigned int
+{
+    Sse2Bit = 1 << 0,
+    Sse41Bit = 1 << 1,
+    Avx2Bit = 1 << 2,
+    F16cBit = 1 << 3,
+    Avx512Bit = 1 << 4,
+    NeonBit = 1 << 5,
+    AllBits = (1 << 6) - 1
+};
+
+static unsigned int _toBits(const CpuFeatures & features)
+{
+    return (features.sse2 ? Sse2Bit : 0u) | (features.sse41 ? Sse41Bit : 0u) |
+           (features.avx2 ? Avx2Bit : 0u) | (features.f16c ? F16cBit : 0u) |
+           (features.avx512 ? Avx512Bit : 0u) | (features.neon ? NeonBit : 0u);
+}
+
+static std::atomic<unsigned int> overrideBits(AllBits);
+static std::atomic_int generation(0);
+
+const CpuFeatures & supportedCpuFeatures()
+{
+    static const CpuFeatures features = _detectCpuFeatures();
+    return features;
+}
+
+CpuFeatures cpuFeatures()
+{
+    CpuFeatures features = supportedCpuFeatures();
+    unsigned int bits = overrideBits.load(std::memory_order_acquire);
+    features.sse2 = features.sse2 && ((bits & Sse2Bit) != 0);
+    features.sse41 = features.sse41 && ((bits & Sse41Bit) != 0);
+    features.avx2 = features.avx2 && ((bits & Avx2Bit) != 0);
+    features.f16c = features.f16c && ((bits & F16cBit) != 0);
+    features.avx512 = features.avx512 && ((bits & Avx512Bit) != 0);
+    features.neon = features.neon && ((bits & NeonBit) != 0);
+    return features;
+}
+
+void setCpuFeaturesOverride(const CpuFeatures & features)
+{
+    overrideBits.store(_toBits(features), std::memory_order_release);
+    generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void resetCpuFeaturesOverride()
+{
+    overrideBits.store(AllBits, std::memory_order_release);
+    generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+int cpuFeaturesGeneration()
+{
+    return generation.load(std::memory_order_acquire);
+}
+
+} // namespace simd
+
+} // namespace sonar
@@ -0,0 +1,108 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_CPUFEATURES_H
+#define SONAR_CPUFEATURES_H
+
+#include <atomic>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SONAR_SIMD_X86 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SONAR_SIMD_NEON 1
+#endif
+
+// Kernels for extended instruction sets are compiled per function, so the library is still built
+// for base architecture and these kernels are called only if processor supports them.
+#if defined(_MSC_VER) && !defined(__clang__)
+#define SONAR_TARGET_SSE2
+#define SONAR_TARGET_SSE41
+#define SONAR_TARGET_AVX2
+#define SONAR_TARGET_F16C
+#define SONAR_TARGET_AVX512
+#else
+#define SONAR_TARGET_SSE2 __attribute__((target("sse2")))
+#define SONAR_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define SONAR_TARGET_AVX2 __attribute__((target("avx2")))
+#define SONAR_TARGET_F16C __attribute__((target("avx,f16c")))
+#define SONAR_TARGET_AVX512 __attribute__((target("avx512f,avx512bw")))
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+/// Instruction sets which are supported by processor and operating system
+struct CpuFeatures
+{
+    bool sse2;
+    bool sse41;
+    bool avx2;
+    /// Conversions between half precision and float (VCVTPH2PS / VCVTPS2PH)
+    bool f16c;
+    /// AVX-512 Foundation with byte and word instructions (BW)
+    bool avx512;
+    bool neon;
+};
+
+/// Features of processor, they are detected once on first call
+const CpuFeatures & supportedCpuFeatures();
+
+/// Features used for selection of kernels: supported features limited by override
+CpuFeatures cpuFeatures();
+
+/// Limits features used by kernels (unsupported features stay disabled), so every implementation
+/// can be tested on one processor. Kernels select implementation again on the next call.
+/// Override must not be changed while kernels are running in other threads.
+void setCpuFeaturesOverride(const CpuFeatures & features);
+void resetCpuFeaturesOverride();
+
+/// Counter of changes of override
+int cpuFeaturesGeneration();
+
+/// Function pointer of kernel chosen by selector for cpuFeatures().
+/// Kernel is selected on first call and again after change of override of features.
+template <typename Function>
+class KernelDispatch
+{
+public:
+    using Selector = Function (*)();
+
+    explicit KernelDispatch(Selector selector):
+        m_selector(selector),
+        m_function(selector()),
+        m_generation(cpuFeaturesGeneration())
+    {}
+
+    Function get() const
+    {
+        int generation = cpuFeaturesGeneration();
+        if (m_generation.load(std::memory_order_acquire) != generation)
+        {
+            m_function.store(m_selector(), std::memory_order_relaxed);
+            m_generation.store(generation, std::memory_order_release);
+        }
+        return m_function.load(std::memory_order_relaxed);
+    }
+
+    template <typename ... Args>
+    auto operator () (Args && ... args) const
+    {
+        return get()(std::forward<Args>(args)...);
+    }
+
+private:
+    Selector m_selector;
+    mutable std::atomic<Function> m_function;
+    mutable std::atomic_int m_generation;
+};
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_CPUFEATURES_H
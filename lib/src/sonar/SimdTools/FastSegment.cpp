@@ -0,0 +1,329 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "FastSegment.h"
+#include "BitOperations.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+using FastRowFunction = int (*)(int * outX, const uchar * row, const int * ring,
+                                int beginX, int endX, int barrier);
+
+// Offsets of circle go around pixel, so contiguous segment of circle is contiguous range of indices
+// (with wrapping). Vector kernels find the longest segment by counters of length:
+// counter = (counter + 1) & mask for 16 + 9 pixels of circle.
+// Segment of 10 pixels contains pixel 0 or 8 and pixel 4 or 12, other pixels are rejected by these 4 pixels.
+static void _makeRing(int * ring, int widthStep)
+{
+    static const int offsets[16][2] = { { 0, 3 }, { 1, 3 }, { 2, 2 }, { 3, 1 }, { 3, 0 }, { 3, -1 }, { 2, -2 }, { 1, -3 },
+                                        { 0, -3 }, { -1, -3 }, { -2, -2 }, { -3, -1 }, { -3, 0 }, { -3, 1 }, { -2, 2 }, { -1, 3 } };
+    for (int k = 0; k < 16; ++k)
+        ring[k] = offsets[k][0] + offsets[k][1] * widthStep;
+}
+
+/// True if circular mask of 16 bits has 10 contiguous set bits
+static bool _hasSegment10(unsigned int mask)
+{
+    std::uint32_t m = mask | (mask << 16);
+    std::uint32_t m2 = m & (m >> 1);
+    std::uint32_t m4 = m2 & (m2 >> 2);
+    std::uint32_t m8 = m4 & (m4 >> 4);
+    return (m8 & (m2 >> 8)) != 0;
+}
+
+static int _fastRow_scalar(int * outX, const uchar * row, const int * ring, int beginX, int endX, int barrier)
+{
+    int count = 0;
+    for (int x = beginX; x < endX; ++x)
+    {
+        const uchar * p = &row[x];
+        const int high = p[0] + barrier, low = p[0] - barrier;
+        const int v0 = p[ring[0]], v4 = p[ring[4]], v8 = p[ring[8]], v12 = p[ring[12]];
+        const bool brighter = ((v0 > high) || (v8 > high)) && ((v4 > high) || (v12 > high));
+        const bool darker = ((v0 < low) || (v8 < low)) && ((v4 < low) || (v12 < low));
+        if (!brighter && !darker)
+            continue;
+        unsigned int brighterMask = 0, darkerMask = 0;
+        for (int k = 0; k < 16; ++k)
+        {
+            const int v = p[ring[k]];
+            brighterMask |= static_cast<unsigned int>(v > high) << k;
+            darkerMask |= static_cast<unsigned int>(v < low) << k;
+        }
+        if (_hasSegment10(brighterMask) || _hasSegment10(darkerMask))
+            outX[count++] = x;
+    }
+    return count;
+}
+
+/// Writes x of set bits of mask of block which begins at x
+static inline int _writeCorners(int * outX, std::uint64_t mask, int x)
+{
+    int count = 0;
+    while (mask != 0)
+    {
+        outX[count++] = x + trailingZeros(mask);
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+#if defined(SONAR_SIMD_X86)
+
+// Unsigned comparison a > b of bytes by signed comparison with flipped high bits
+SONAR_TARGET_SSE41
+static inline __m128i _cmpgt_epu8_sse41(__m128i a, __m128i b, __m128i flip)
+{
+    return _mm_cmpgt_epi8(_mm_xor_si128(a, flip), _mm_xor_si128(b, flip));
+}
+
+SONAR_TARGET_SSE41
+static int _fastRow_sse41(int * outX, const uchar * row, const int * ring, int beginX, int endX, int barrier)
+{
+    const __m128i flip = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m128i vBarrier = _mm_set1_epi8(static_cast<char>(barrier));
+    const __m128i nine = _mm_set1_epi8(9);
+    int count = 0;
+    int x = beginX;
+    for (; x + 16 <= endX; x += 16)
+    {
+        const uchar * p = &row[x];
+        const __m128i center = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i high = _mm_adds_epu8(center, vBarrier);
+        const __m128i low = _mm_subs_epu8(center, vBarrier);
+        __m128i v[16];
+        for (int k = 0; k < 16; k += 4)
+            v[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&p[ring[k]]));
+        __m128i brighter = _mm_and_si128(_mm_or_si128(_cmpgt_epu8_sse41(v[0], high, flip), _cmpgt_epu8_sse41(v[8], high, flip)),
+                                         _mm_or_si128(_cmpgt_epu8_sse41(v[4], high, flip), _cmpgt_epu8_sse41(v[12], high, flip)));
+        __m128i darker = _mm_and_si128(_mm_or_si128(_cmpgt_epu8_sse41(low, v[0], flip), _cmpgt_epu8_sse41(low, v[8], flip)),
+                                       _mm_or_si128(_cmpgt_epu8_sse41(low, v[4], flip), _cmpgt_epu8_sse41(low, v[12], flip)));
+        if (_mm_testz_si128(_mm_or_si128(brighter, darker), _mm_or_si128(brighter, darker)))
+            continue;
+        for (int k = 0; k < 16; ++k)
+        {
+            if ((k & 3) != 0)
+                v[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&p[ring[k]]));
+        }
+        __m128i brighterCount = _mm_setzero_si128(), darkerCount = _mm_setzero_si128();
+        __m128i brighterMax = _mm_setzero_si128(), darkerMax = _mm_setzero_si128();
+        for (int k = 0; k < 25; ++k)
+        {
+            const __m128i value = v[k & 15];
+            const __m128i b = _cmpgt_epu8_sse41(value, high, flip);
+            const __m128i d = _cmpgt_epu8_sse41(low, value, flip);
+            brighterCount = _mm_and_si128(_mm_sub_epi8(brighterCount, b), b);
+            darkerCount = _mm_and_si128(_mm_sub_epi8(darkerCount, d), d);
+            brighterMax = _mm_max_epu8(brighterMax, brighterCount);
+            darkerMax = _mm_max_epu8(darkerMax, darkerCount);
+        }
+        const __m128i corners = _mm_cmpgt_epi8(_mm_max_epu8(brighterMax, darkerMax), nine);
+        count += _writeCorners(&outX[count], static_cast<std::uint64_t>(_mm_movemask_epi8(corners)), x);
+    }
+    return count + _fastRow_scalar(&outX[count], row, ring, x, endX, barrier);
+}
+
+SONAR_TARGET_AVX2
+static inline __m256i _cmpgt_epu8_avx2(__m256i a, __m256i b, __m256i flip)
+{
+    return _mm256_cmpgt_epi8(_mm256_xor_si256(a, flip), _mm256_xor_si256(b, flip));
+}
+
+SONAR_TARGET_AVX2
+static int _fastRow_avx2(int * outX, const uchar * row, const int * ring, int beginX, int endX, int barrier)
+{
+    const __m256i flip = _mm256_set1_epi8(static_cast<char>(0x80));
+    const __m256i vBarrier = _mm256_set1_epi8(static_cast<char>(barrier));
+    const __m256i nine = _mm256_set1_epi8(9);
+    int count = 0;
+    int x = beginX;
+    for (; x + 32 <= endX; x += 32)
+    {
+        const uchar * p = &row[x];
+        const __m256i center = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        const __m256i high = _mm256_adds_epu8(center, vBarrier);
+        const __m256i low = _mm256_subs_epu8(center, vBarrier);
+        __m256i v[16];
+        for (int k = 0; k < 16; k += 4)
+            v[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&p[ring[k]]));
+        __m256i brighter = _mm256_and_si256(_mm256_or_si256(_cmpgt_epu8_avx2(v[0], high, flip), _cmpgt_epu8_avx2(v[8], high, flip)),
+                                            _mm256_or_si256(_cmpgt_epu8_avx2(v[4], high, flip), _cmpgt_epu8_avx2(v[12], high, flip)));
+        __m256i darker = _mm256_and_si256(_mm256_or_si256(_cmpgt_epu8_avx2(low, v[0], flip), _cmpgt_epu8_avx2(low, v[8], flip)),
+                                          _mm256_or_si256(_cmpgt_epu8_avx2(low, v[4], flip), _cmpgt_epu8_avx2(low, v[12], flip)));
+        if (_mm256_testz_si256(_mm256_or_si256(brighter, darker), _mm256_or_si256(brighter, darker)))
+            continue;
+        for (int k = 0; k < 16; ++k)
+        {
+            if ((k & 3) != 0)
+                v[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&p[ring[k]]));
+        }
+        __m256i brighterCount = _mm256_setzero_si256(), darkerCount = _mm256_setzero_si256();
+        __m256i brighterMax = _mm256_setzero_si256(), darkerMax = _mm256_setzero_si256();
+        for (int k = 0; k < 25; ++k)
+        {
+            const __m256i value = v[k & 15];
+            const __m256i b = _cmpgt_epu8_avx2(value, high, flip);
+            const __m256i d = _cmpgt_epu8_avx2(low, value, flip);
+            brighterCount = _mm256_and_si256(_mm256_sub_epi8(brighterCount, b), b);
+            darkerCount = _mm256_and_si256(_mm256_sub_epi8(darkerCount, d), d);
+            brighterMax = _mm256_max_epu8(brighterMax, brighterCount);
+            darkerMax = _mm256_max_epu8(darkerMax, darkerCount);
+        }
+        const __m256i corners = _mm256_cmpgt_epi8(_mm256_max_epu8(brighterMax, darkerMax), nine);
+        count += _writeCorners(&outX[count], static_cast<std::uint32_t>(_mm256_movemask_epi8(corners)), x);
+    }
+    return count + _fastRow_sse41(&outX[count], row, ring, x, endX, barrier);
+}
+
+SONAR_TARGET_AVX512
+static int _fastRow_avx512(int * outX, const uchar * row, const int * ring, int beginX, int endX, int barrier)
+{
+    // Comparisons give masks, counters are incremented and reset by one masked addition
+    const __m512i vBarrier = _mm512_set1_epi8(static_cast<char>(barrier));
+    const __m512i one = _mm512_set1_epi8(1);
+    const __m512i nine = _mm512_set1_epi8(9);
+    int count = 0;
+    int x = beginX;
+    for (; x + 64 <= endX; x += 64)
+    {
+        const uchar * p = &row[x];
+        const __m512i center = _mm512_loadu_si512(p);
+        const __m512i high = _mm512_adds_epu8(center, vBarrier);
+        const __m512i low = _mm512_subs_epu8(center, vBarrier);
+        __m512i v[16];
+        for (int k = 0; k < 16; k += 4)
+            v[k] = _mm512_loadu_si512(&p[ring[k]]);
+        __mmask64 brighter = (_mm512_cmpgt_epu8_mask(v[0], high) | _mm512_cmpgt_epu8_mask(v[8], high)) &
+                             (_mm512_cmpgt_epu8_mask(v[4], high) | _mm512_cmpgt_epu8_mask(v[12], high));
+        __mmask64 darker = (_mm512_cmplt_epu8_mask(v[0], low) | _mm512_cmplt_epu8_mask(v[8], low)) &
+                           (_mm512_cmplt_epu8_mask(v[4], low) | _mm512_cmplt_epu8_mask(v[12], low));
+        if ((brighter | darker) == 0)
+            continue;
+        for (int k = 0; k < 16; ++k)
+        {
+            if ((k & 3) != 0)
+                v[k] = _mm512_loadu_si512(&p[ring[k]]);
+        }
+        __m512i brighterCount = _mm512_setzero_si512(), darkerCount = _mm512_setzero_si512();
+        __m512i brighterMax = _mm512_setzero_si512(), darkerMax = _mm512_setzero_si512();
+        for (int k = 0; k < 25; ++k)
+        {
+            const __m512i value = v[k & 15];
+            brighterCount = _mm512_maskz_add_epi8(_mm512_cmpgt_epu8_mask(value, high), brighterCount, one);
+            darkerCount = _mm512_maskz_add_epi8(_mm512_cmplt_epu8_mask(value, low), darkerCount, one);
+            brighterMax = _mm512_max_epu8(brighterMax, brighterCount);
+            darkerMax = _mm512_max_epu8(darkerMax, darkerCount);
+        }
+        count += _writeCorners(&outX[count], _mm512_cmpgt_epu8_mask(_mm512_max_epu8(brighterMax, darkerMax), nine), x);
+    }
+    return count + _fastRow_avx2(&outX[count], row, ring, x, endX, barrier);
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+static int _fastRow_neon(int * outX, const uchar * row, const int * ring, int beginX, int endX, int barrier)
+{
+    const uint8x16_t vBarrier = vdupq_n_u8(static_cast<uchar>(barrier));
+    const uint8x16_t nine = vdupq_n_u8(9);
+    int count = 0;
+    int x = beginX;
+    for (; x + 16 <= endX; x += 16)
+    {
+        const uchar * p = &row[x];
+        const uint8x16_t center = vld1q_u8(p);
+        const uint8x16_t high = vqaddq_u8(center, vBarrier);
+        const uint8x16_t low = vqsubq_u8(center, vBarrier);
+        uint8x16_t v[16];
+        for (int k = 0; k < 16; k += 4)
+            v[k] = vld1q_u8(&p[ring[k]]);
+        uint8x16_t brighter = vandq_u8(vorrq_u8(vcgtq_u8(v[0], high), vcgtq_u8(v[8], high)),
+                                       vorrq_u8(vcgtq_u8(v[4], high), vcgtq_u8(v[12], high)));
+        uint8x16_t darker = vandq_u8(vorrq_u8(vcltq_u8(v[0], low), vcltq_u8(v[8], low)),
+                                     vorrq_u8(vcltq_u8(v[4], low), vcltq_u8(v[12], low)));
+        uint8x16_t any = vorrq_u8(brighter, darker);
+        uint64x2_t any64 = vreinterpretq_u64_u8(any);
+        if ((vgetq_lane_u64(any64, 0) | vgetq_lane_u64(any64, 1)) == 0)
+            continue;
+        for (int k = 0; k < 16; ++k)
+        {
+            if ((k & 3) != 0)
+                v[k] = vld1q_u8(&p[ring[k]]);
+        }
+        uint8x16_t brighterCount = vdupq_n_u8(0), darkerCount = vdupq_n_u8(0);
+        uint8x16_t brighterMax = vdupq_n_u8(0), darkerMax = vdupq_n_u8(0);
+        for (int k = 0; k < 25; ++k)
+        {
+            const uint8x16_t value = v[k & 15];
+            const uint8x16_t b = vcgtq_u8(value, high);
+            const uint8x16_t d = vcltq_u8(value, low);
+            brighterCount = vandq_u8(vsubq_u8(brighterCount, b), b);
+            darkerCount = vandq_u8(vsubq_u8(darkerCount, d), d);
+            brighterMax = vmaxq_u8(brighterMax, brighterCount);
+            darkerMax = vmaxq_u8(darkerMax, darkerCount);
+        }
+        const uint8x16_t corners = vcgtq_u8(vmaxq_u8(brighterMax, darkerMax), nine);
+        // Every byte of mask gives 4 bits
+        std::uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(corners), 4)), 0);
+        while (mask != 0)
+        {
+            outX[count++] = x + (trailingZeros(mask) >> 2);
+            mask &= ~(std::uint64_t(0xf) << (trailingZeros(mask) & ~3));
+        }
+    }
+    return count + _fastRow_scalar(&outX[count], row, ring, x, endX, barrier);
+}
+
+#endif
+
+static FastRowFunction _selectFastRow()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx512 && features.avx2 && features.sse41)
+        return _fastRow_avx512;
+    if (features.avx2 && features.sse41)
+        return _fastRow_avx2;
+    if (features.sse41)
+        return _fastRow_sse41;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _fastRow_neon;
+#endif
+    (void)features;
+    return _fastRow_scalar;
+}
+
+int fastCorners10Row_u(int * outX, const uchar * row, int widthStep, int beginX, int endX, int barrier)
+{
+    static const KernelDispatch<FastRowFunction> function(_selectFastRow);
+    assert(barrier >= 0);
+    if (beginX >= endX)
+        return 0;
+    int ring[16];
+    _makeRing(ring, widthStep);
+    // Thresholds are saturated in bytes, with barrier 255 and more no pixel passes
+    return function(outX, row, ring, beginX, endX, std::min(barrier, 255));
+}
+
+} // namespace simd
+
+} // namespace sonar
@@ -0,0 +1,27 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_FASTSEGMENT_H
+#define SONAR_SIMD_FASTSEGMENT_H
+
+namespace sonar {
+
+namespace simd {
+
+/// Segment test of FAST-10 for pixels [beginX, endX) of row: pixel is corner if 10 contiguous pixels
+/// of circle with radius 3 are all brighter than pixel + barrier or all darker than pixel - barrier.
+/// row points to the first pixel of row, rows from y - 3 to y + 3 and columns from beginX - 3 to endX + 2
+/// must be inside image, widthStep is in bytes.
+/// Coordinates x of corners are written into outX in increasing order, outX must have endX - beginX elements.
+/// Implementation (AVX-512BW, AVX2, SSE4.1, NEON or scalar) is selected by features of processor.
+/// @return number of corners
+int fastCorners10Row_u(int * outX, const unsigned char * row, int widthStep, int beginX, int endX, int barrier);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_FASTSEGMENT_H
@@ -0,0 +1,309 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "GaussianBlur.h"
+#include "CpuFeatures.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+std::shared_ptr<const GaussianKernel_u> gaussianKernel_u(int halfSize, float sigma)
+{
+    assert((halfSize >= 0) && (sigma > 0.0f));
+
+    static std::mutex mutex;
+    static std::map<std::pair<int, float>, std::shared_ptr<const GaussianKernel_u>> kernels;
+
+    std::lock_guard<std::mutex> locker(mutex); (void)locker;
+    auto it = kernels.find(std::make_pair(halfSize, sigma));
+    if (it != kernels.end())
+        return it->second;
+
+    std::vector<double> g(static_cast<std::size_t>(halfSize + 1));
+    double sumG = 0.0;
+    for (int i = 0; i <= halfSize; ++i)
+    {
+        g[i] = std::exp(- (i * i) / (2.0 * sigma * sigma));
+        sumG += (i == 0) ? g[i] : (2.0 * g[i]);
+    }
+    std::shared_ptr<GaussianKernel_u> kernel = std::make_shared<GaussianKernel_u>();
+    kernel->halfSize = halfSize;
+    kernel->sigma = sigma;
+    kernel->weights.resize(static_cast<std::size_t>(halfSize + 1));
+    // Tails of one side are rounded cumulatively from the edge of kernel, so weights are not negative
+    // and the sum of side weights can't exceed 128 even for big halfSize with tiny weights.
+    // Error of rounding goes to center, so the sum is exact and flat image stays flat
+    double tail = 0.0;
+    long previousRounded = 0;
+    for (int i = halfSize; i >= 1; --i)
+    {
+        tail += g[i];
+        long rounded = std::min(std::lround(tail * 256.0 / sumG), 128L);
+        kernel->weights[i] = static_cast<std::uint16_t>(rounded - previousRounded);
+        previousRounded = rounded;
+    }
+    assert(previousRounded <= 128);
+    kernel->weights[0] = static_cast<std::uint16_t>(256 - previousRounded * 2);
+    // Set of different parameters is small in practice, the limit only protects from unbounded growth
+    if (kernels.size() >= 64)
+        kernels.clear();
+    kernels[std::make_pair(halfSize, sigma)] = kernel;
+    return kernel;
+}
+
+// Every output pixel is a weighted sum of 2 * halfSize + 1 lines: out[x] = sum(w[|i - halfSize|] * in[i][x]).
+// Rows (for Y) or shifted pointers into padded row (for X) are passed as lines, so one kernel does both passes.
+// The sum is <= 256 * 255 + 128, so it's computed in 16 bits without overflow.
+using BlurLineFunction = void (*)(uchar * out, const uchar * const * in,
+                                  const std::uint16_t * weights, int halfSize, int width);
+
+static void _blurLine_scalar(uchar * out, const uchar * const * in,
+                             const std::uint16_t * weights, int halfSize, int beginX, int endX)
+{
+    const uchar * center = in[halfSize];
+    for (int x = beginX; x < endX; ++x)
+    {
+        unsigned int sum = weights[0] * center[x] + 128u;
+        for (int k = 1; k <= halfSize; ++k)
+            sum += weights[k] * static_cast<unsigned int>(in[halfSize - k][x] + in[halfSize + k][x]);
+        out[x] = static_cast<uchar>(sum >> 8);
+    }
+}
+
+static void _blurLine_scalar(uchar * out, const uchar * const * in,
+                             const std::uint16_t * weights, int halfSize, int width)
+{
+    _blurLine_scalar(out, in, weights, halfSize, 0, width);
+}
+
+#if defined(SONAR_SIMD_X86)
+
+SONAR_TARGET_SSE2
+static void _blurLine_sse2(uchar * out, const uchar * const * in,
+                           const std::uint16_t * weights, int halfSize, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rounding = _mm_set1_epi16(128);
+    const __m128i w0 = _mm_set1_epi16(static_cast<short>(weights[0]));
+    const uchar * center = in[halfSize];
+    int endX16 = width & ~15;
+    for (int x = 0; x < endX16; x += 16)
+    {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&center[x]));
+        __m128i sumLo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), w0), rounding);
+        __m128i sumHi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), w0), rounding);
+        for (int k = 1; k <= halfSize; ++k)
+        {
+            __m128i w = _mm_set1_epi16(static_cast<short>(weights[k]));
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[halfSize - k][x]));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[halfSize + k][x]));
+            __m128i pairLo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            __m128i pairHi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+            sumLo = _mm_add_epi16(sumLo, _mm_mullo_epi16(pairLo, w));
+            sumHi = _mm_add_epi16(sumHi, _mm_mullo_epi16(pairHi, w));
+        }
+        __m128i result = _mm_packus_epi16(_mm_srli_epi16(sumLo, 8), _mm_srli_epi16(sumHi, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[x]), result);
+    }
+    _blurLine_scalar(out, in, weights, halfSize, endX16, width);
+}
+
+SONAR_TARGET_AVX2
+static void _blurLine_avx2(uchar * out, const uchar * const * in,
+                           const std::uint16_t * weights, int halfSize, int width)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i rounding = _mm256_set1_epi16(128);
+    const __m256i w0 = _mm256_set1_epi16(static_cast<short>(weights[0]));
+    const uchar * center = in[halfSize];
+    int endX32 = width & ~31;
+    for (int x = 0; x < endX32; x += 32)
+    {
+        // unpacking and packing work inside of the same 128 bits lanes, so order of pixels is kept
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&center[x]));
+        __m256i sumLo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(c, zero), w0), rounding);
+        __m256i sumHi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(c, zero), w0), rounding);
+        for (int k = 1; k <= halfSize; ++k)
+        {
+            __m256i w = _mm256_set1_epi16(static_cast<short>(weights[k]));
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&in[halfSize - k][x]));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&in[halfSize + k][x]));
+            __m256i pairLo = _mm256_add_epi16(_mm256_unpacklo_epi8(a, zero), _mm256_unpacklo_epi8(b, zero));
+            __m256i pairHi = _mm256_add_epi16(_mm256_unpackhi_epi8(a, zero), _mm256_unpackhi_epi8(b, zero));
+            sumLo = _mm256_add_epi16(sumLo, _mm256_mullo_epi16(pairLo, w));
+            sumHi = _mm256_add_epi16(sumHi, _mm256_mullo_epi16(pairHi, w));
+        }
+        __m256i result = _mm256_packus_epi16(_mm256_srli_epi16(sumLo, 8), _mm256_srli_epi16(sumHi, 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(&out[x]), result);
+    }
+    _blurLine_scalar(out, in, weights, halfSize, endX32, width);
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+static void _blurLine_neon(uchar * out, const uchar * const * in,
+                           const std::uint16_t * weights, int halfSize, int width)
+{
+    const uchar * center = in[halfSize];
+    int endX16 = width & ~15;
+    for (int x = 0; x < endX16; x += 16)
+    {
+        uint8x16_t c = vld1q_u8(&center[x]);
+        uint16x8_t sumLo = vmulq_n_u16(vmovl_u8(vget_low_u8(c)), weights[0]);
+        uint16x8_t sumHi = vmulq_n_u16(vmovl_u8(vget_high_u8(c)), weights[0]);
+        for (int k = 1; k <= halfSize; ++k)
+        {
+            uint8x16_t a = vld1q_u8(&in[halfSize - k][x]);
+            uint8x16_t b = vld1q_u8(&in[halfSize + k][x]);
+            sumLo = vmlaq_n_u16(sumLo, vaddl_u8(vget_low_u8(a), vget_low_u8(b)), weights[k]);
+            sumHi = vmlaq_n_u16(sumHi, vaddl_u8(vget_high_u8(a), vget_high_u8(b)), weights[k]);
+        }
+        // rounding shift doesn't overflow, it's the same as (sum + 128) >> 8
+        vst1q_u8(&out[x], vcombine_u8(vrshrn_n_u16(sumLo, 8), vrshrn_n_u16(sumHi, 8)));
+    }
+    _blurLine_scalar(out, in, weights, halfSize, endX16, width);
+}
+
+#endif
+
+static BlurLineFunction _selectBlurLine()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _blurLine_avx2;
+    if (features.sse2)
+        return _blurLine_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _blurLine_neon;
+#endif
+    (void)features;
+    return _blurLine_scalar;
+}
+
+static BlurLineFunction _blurLine()
+{
+    static const KernelDispatch<BlurLineFunction> function(_selectBlurLine);
+    return function.get();
+}
+
+/// Row with replicated borders: padded[halfSize + x] = in[clamp(beginX + x)] for x from -halfSize to width + halfSize
+static void _padRow(uchar * padded, const uchar * in, int inWidth, int beginX, int width, int halfSize)
+{
+    int x = beginX - halfSize;
+    int endX = beginX + width + halfSize;
+    uchar * outStr = padded;
+    for (; (x < 0) && (x < endX); ++x, ++outStr)
+        *outStr = in[0];
+    int endCopy = std::min(endX, inWidth);
+    if (endCopy > x)
+    {
+        std::memcpy(outStr, &in[x], static_cast<std::size_t>(endCopy - x));
+        outStr = &outStr[endCopy - x];
+        x = endCopy;
+    }
+    for (; x < endX; ++x, ++outStr)
+        *outStr = in[inWidth - 1];
+}
+
+static void _blurRow(BlurLineFunction function, uchar * out, uchar * padded, std::vector<const uchar*> & lines,
+                     const uchar * in, int inWidth, int beginX, int width, const GaussianKernel_u & kernel)
+{
+    _padRow(padded, in, inWidth, beginX, width, kernel.halfSize);
+    for (std::size_t i = 0; i < lines.size(); ++i)
+        lines[i] = &padded[i];
+    function(out, lines.data(), kernel.weights.data(), kernel.halfSize, width);
+}
+
+void gaussianBlurX_u(uchar * out, int outWidthStep, const uchar * in, int inWidthStep, int width, int height,
+                     const GaussianKernel_u & kernel, int beginRow, int endRow)
+{
+    (void)height;
+    if ((width <= 0) || (beginRow >= endRow))
+        return;
+    BlurLineFunction function = _blurLine();
+    std::vector<uchar> padded(static_cast<std::size_t>(width + kernel.halfSize * 2));
+    std::vector<const uchar*> lines(static_cast<std::size_t>(kernel.halfSize * 2 + 1));
+    for (int y = beginRow; y < endRow; ++y)
+        _blurRow(function, &out[y * outWidthStep], padded.data(), lines,
+                 &in[y * inWidthStep], width, 0, width, kernel);
+}
+
+void gaussianBlurY_u(uchar * out, int outWidthStep, const uchar * in, int inWidthStep, int width, int height,
+                     const GaussianKernel_u & kernel, int beginRow, int endRow)
+{
+    if ((width <= 0) || (beginRow >= endRow))
+        return;
+    BlurLineFunction function = _blurLine();
+    std::vector<const uchar*> lines(static_cast<std::size_t>(kernel.halfSize * 2 + 1));
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        for (int i = 0; i < static_cast<int>(lines.size()); ++i)
+            lines[i] = &in[std::min(std::max(y + i - kernel.halfSize, 0), height - 1) * inWidthStep];
+        function(&out[y * outWidthStep], lines.data(), kernel.weights.data(), kernel.halfSize, width);
+    }
+}
+
+void gaussianBlur_u(uchar * out, int outWidthStep, const uchar * in, int inWidthStep, int width, int height,
+                    const GaussianKernel_u & kernel, int beginRow, int endRow)
+{
+    if ((width <= 0) || (beginRow >= endRow))
+        return;
+    BlurLineFunction function = _blurLine();
+    int sizeKernel = kernel.halfSize * 2 + 1;
+    // Ring buffer of strip takes about half of L1 cache, strips have nearly equal widths
+    int maxStripWidth = std::max((16 * 1024 / sizeKernel) & ~63, 64);
+    int numberStrips = (width + maxStripWidth - 1) / maxStripWidth;
+    int stripWidth = std::min(((width + numberStrips - 1) / numberStrips + 31) & ~31, width);
+    std::vector<uchar> ring(static_cast<std::size_t>(sizeKernel * stripWidth));
+    std::vector<uchar> padded(static_cast<std::size_t>(stripWidth + kernel.halfSize * 2));
+    std::vector<const uchar*> lines(static_cast<std::size_t>(sizeKernel));
+    std::vector<const uchar*> columnLines(static_cast<std::size_t>(sizeKernel));
+    for (int beginX = 0; beginX < width; beginX += stripWidth)
+    {
+        int stripEnd = std::min(beginX + stripWidth, width);
+        int currentWidth = stripEnd - beginX;
+        // Rows of window are consecutive rows of image, so index of row modulo size of kernel is unique
+        int nextRow = std::max(beginRow - kernel.halfSize, 0);
+        for (int y = beginRow; y < endRow; ++y)
+        {
+            int lastRow = std::min(y + kernel.halfSize, height - 1);
+            for (; nextRow <= lastRow; ++nextRow)
+                _blurRow(function, &ring[(nextRow % sizeKernel) * stripWidth], padded.data(), lines,
+                         &in[nextRow * inWidthStep], width, beginX, currentWidth, kernel);
+            for (int i = 0; i < sizeKernel; ++i)
+            {
+                int row = std::min(std::max(y + i - kernel.halfSize, 0), height - 1);
+                columnLines[i] = &ring[(row % sizeKernel) * stripWidth];
+            }
+            function(&out[y * outWidthStep + beginX], columnLines.data(),
+                     kernel.weights.data(), kernel.halfSize, currentWidth);
+        }
+    }
+}
+
+} // namespace simd
+
+} // namespace sonar
@@ -0,0 +1,52 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_GAUSSIANBLUR_H
+#define SONAR_SIMD_GAUSSIANBLUR_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sonar {
+
+namespace simd {
+
+/// Symmetric gaussian kernel in fixed point with 8 bits of fraction, sum of all weights is exactly 256.
+/// weights[0] is weight of center, weights[i] is weight of offsets -i and +i.
+struct GaussianKernel_u
+{
+    int halfSize;
+    float sigma;
+    std::vector<std::uint16_t> weights;
+};
+
+/// Kernel is computed once for every pair of halfSize and sigma, next calls return the cached kernel
+std::shared_ptr<const GaussianKernel_u> gaussianKernel_u(int halfSize, float sigma);
+
+/// Gaussian blur of 8 bits image by rows (X) or by columns (Y), results are rounded to nearest,
+/// borders are replicated. Only rows of out image from beginRow to endRow are computed,
+/// so image can be split between threads. Out and in must not overlap.
+/// Implementation (SSE2, AVX2, NEON or scalar) is selected on first call by features of processor.
+void gaussianBlurX_u(unsigned char * out, int outWidthStep,
+                     const unsigned char * in, int inWidthStep, int width, int height,
+                     const GaussianKernel_u & kernel, int beginRow, int endRow);
+void gaussianBlurY_u(unsigned char * out, int outWidthStep,
+                     const unsigned char * in, int inWidthStep, int width, int height,
+                     const GaussianKernel_u & kernel, int beginRow, int endRow);
+
+/// Both passes in one: image is processed by vertical strips, rows of strip filtered by X are kept
+/// in small ring buffer (it stays in L1 cache) and are filtered by Y from there.
+/// Result is the same as gaussianBlurY_u(gaussianBlurX_u(in)).
+void gaussianBlur_u(unsigned char * out, int outWidthStep,
+                    const unsigned char * in, int inWidthStep, int width, int height,
+                    const GaussianKernel_u & kernel, int beginRow, int endRow);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_GAUSSIANBLUR_H
@@ -0,0 +1,372 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "Gradients.h"
+#include "CpuFeatures.h"
+
+#include <cassert>
+#include <algorithm>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+// Values of gradients are <= 16 * 255 by module (Scharr), so they are computed in 16 bits,
+// products of structure tensor are computed in 32 bits.
+// Row functions compute pixels from 1 to width - 2, pixels of border are set by caller.
+
+using GradientsRowFunction = void (*)(short * out, const uchar * prev, const uchar * cur, const uchar * next,
+                                      int width, int a, int b);
+using TensorRowFunction = void (*)(int * outXX, int * outXY, int * outYY,
+                                   const uchar * prev, const uchar * cur, const uchar * next,
+                                   int width, int a, int b);
+
+static void _coefficients(GradientOperator gradientOperator, int & a, int & b)
+{
+    switch (gradientOperator)
+    {
+    case GradientOperator::CentralDifferences:
+        a = 0; b = 1;
+        break;
+    case GradientOperator::Sobel:
+        a = 1; b = 2;
+        break;
+    case GradientOperator::Scharr:
+        a = 3; b = 10;
+        break;
+    }
+}
+
+static inline void _gradient_scalar(int & dx, int & dy, const uchar * prev, const uchar * cur, const uchar * next,
+                                    int x, int a, int b)
+{
+    dx = a * ((prev[x + 1] - prev[x - 1]) + (next[x + 1] - next[x - 1])) + b * (cur[x + 1] - cur[x - 1]);
+    dy = a * ((next[x - 1] - prev[x - 1]) + (next[x + 1] - prev[x + 1])) + b * (next[x] - prev[x]);
+}
+
+static void _gradientsRow_scalar(short * out, const uchar * prev, const uchar * cur, const uchar * next,
+                                 int a, int b, int beginX, int endX)
+{
+    int dx, dy;
+    for (int x = beginX; x < endX; ++x)
+    {
+        _gradient_scalar(dx, dy, prev, cur, next, x, a, b);
+        out[x * 2] = static_cast<short>(dx);
+        out[x * 2 + 1] = static_cast<short>(dy);
+    }
+}
+
+static void _gradientsRow_scalar(short * out, const uchar * prev, const uchar * cur, const uchar * next,
+                                 int width, int a, int b)
+{
+    _gradientsRow_scalar(out, prev, cur, next, a, b, 1, width - 1);
+}
+
+static void _tensorRow_scalar(int * outXX, int * outXY, int * outYY,
+                              const uchar * prev, const uchar * cur, const uchar * next,
+                              int a, int b, int beginX, int endX)
+{
+    int dx, dy;
+    for (int x = beginX; x < endX; ++x)
+    {
+        _gradient_scalar(dx, dy, prev, cur, next, x, a, b);
+        outXX[x] = dx * dx;
+        outXY[x] = dx * dy;
+        outYY[x] = dy * dy;
+    }
+}
+
+static void _tensorRow_scalar(int * outXX, int * outXY, int * outYY,
+                              const uchar * prev, const uchar * cur, const uchar * next,
+                              int width, int a, int b)
+{
+    _tensorRow_scalar(outXX, outXY, outYY, prev, cur, next, a, b, 1, width - 1);
+}
+
+#if defined(SONAR_SIMD_X86)
+
+/// Gradients of 8 pixels from x
+SONAR_TARGET_SSE2
+static inline void _gradients8_sse2(__m128i & dx, __m128i & dy,
+                                    const uchar * prev, const uchar * cur, const uchar * next,
+                                    int x, __m128i a, __m128i b)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i pL = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&prev[x - 1])), zero);
+    __m128i pC = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&prev[x])), zero);
+    __m128i pR = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&prev[x + 1])), zero);
+    __m128i cL = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&cur[x - 1])), zero);
+    __m128i cR = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&cur[x + 1])), zero);
+    __m128i nL = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&next[x - 1])), zero);
+    __m128i nC = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&next[x])), zero);
+    __m128i nR = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&next[x + 1])), zero);
+    dx = _mm_add_epi16(_mm_mullo_epi16(_mm_add_epi16(_mm_sub_epi16(pR, pL), _mm_sub_epi16(nR, nL)), a),
+                       _mm_mullo_epi16(_mm_sub_epi16(cR, cL), b));
+    dy = _mm_add_epi16(_mm_mullo_epi16(_mm_add_epi16(_mm_sub_epi16(nL, pL), _mm_sub_epi16(nR, pR)), a),
+                       _mm_mullo_epi16(_mm_sub_epi16(nC, pC), b));
+}
+
+SONAR_TARGET_SSE2
+static void _gradientsRow_sse2(short * out, const uchar * prev, const uchar * cur, const uchar * next,
+                               int width, int a, int b)
+{
+    const __m128i va = _mm_set1_epi16(static_cast<short>(a));
+    const __m128i vb = _mm_set1_epi16(static_cast<short>(b));
+    __m128i dx, dy;
+    int x = 1;
+    for (; (x + 9) <= width; x += 8)
+    {
+        _gradients8_sse2(dx, dy, prev, cur, next, x, va, vb);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[x * 2]), _mm_unpacklo_epi16(dx, dy));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[x * 2 + 8]), _mm_unpackhi_epi16(dx, dy));
+    }
+    _gradientsRow_scalar(out, prev, cur, next, a, b, x, width - 1);
+}
+
+/// Products of 16 bits values as 32 bits values, first and second halves of 8 values
+SONAR_TARGET_SSE2
+static inline void _mul32_sse2(int * out, __m128i u, __m128i v)
+{
+    __m128i lo = _mm_mullo_epi16(u, v);
+    __m128i hi = _mm_mulhi_epi16(u, v);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi16(lo, hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[4]), _mm_unpackhi_epi16(lo, hi));
+}
+
+SONAR_TARGET_SSE2
+static void _tensorRow_sse2(int * outXX, int * outXY, int * outYY,
+                            const uchar * prev, const uchar * cur, const uchar * next,
+                            int width, int a, int b)
+{
+    const __m128i va = _mm_set1_epi16(static_cast<short>(a));
+    const __m128i vb = _mm_set1_epi16(static_cast<short>(b));
+    __m128i dx, dy;
+    int x = 1;
+    for (; (x + 9) <= width; x += 8)
+    {
+        _gradients8_sse2(dx, dy, prev, cur, next, x, va, vb);
+        _mul32_sse2(&outXX[x], dx, dx);
+        _mul32_sse2(&outXY[x], dx, dy);
+        _mul32_sse2(&outYY[x], dy, dy);
+    }
+    _tensorRow_scalar(outXX, outXY, outYY, prev, cur, next, a, b, x, width - 1);
+}
+
+/// Gradients of 16 pixels from x
+SONAR_TARGET_AVX2
+static inline void _gradients16_avx2(__m256i & dx, __m256i & dy,
+                                     const uchar * prev, const uchar * cur, const uchar * next,
+                                     int x, __m256i a, __m256i b)
+{
+    __m256i pL = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&prev[x - 1])));
+    __m256i pC = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&prev[x])));
+    __m256i pR = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&prev[x + 1])));
+    __m256i cL = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&cur[x - 1])));
+    __m256i cR = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&cur[x + 1])));
+    __m256i nL = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&next[x - 1])));
+    __m256i nC = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&next[x])));
+    __m256i nR = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&next[x + 1])));
+    dx = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_add_epi16(_mm256_sub_epi16(pR, pL),
+                                                              _mm256_sub_epi16(nR, nL)), a),
+                          _mm256_mullo_epi16(_mm256_sub_epi16(cR, cL), b));
+    dy = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_add_epi16(_mm256_sub_epi16(nL, pL),
+                                                              _mm256_sub_epi16(nR, pR)), a),
+                          _mm256_mullo_epi16(_mm256_sub_epi16(nC, pC), b));
+}
+
+/// Interleaving works inside of 128 bits lanes, so halves are restored by permutation
+SONAR_TARGET_AVX2
+static inline void _storeInterleaved_avx2(void * out, __m256i u, __m256i v)
+{
+    __m256i lo = _mm256_unpacklo_epi16(u, v);
+    __m256i hi = _mm256_unpackhi_epi16(u, v);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(lo, hi, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out) + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+}
+
+SONAR_TARGET_AVX2
+static void _gradientsRow_avx2(short * out, const uchar * prev, const uchar * cur, const uchar * next,
+                               int width, int a, int b)
+{
+    const __m256i va = _mm256_set1_epi16(static_cast<short>(a));
+    const __m256i vb = _mm256_set1_epi16(static_cast<short>(b));
+    __m256i dx, dy;
+    int x = 1;
+    for (; (x + 17) <= width; x += 16)
+    {
+        _gradients16_avx2(dx, dy, prev, cur, next, x, va, vb);
+        _storeInterleaved_avx2(&out[x * 2], dx, dy);
+    }
+    _gradientsRow_scalar(out, prev, cur, next, a, b, x, width - 1);
+}
+
+SONAR_TARGET_AVX2
+static void _tensorRow_avx2(int * outXX, int * outXY, int * outYY,
+                            const uchar * prev, const uchar * cur, const uchar * next,
+                            int width, int a, int b)
+{
+    const __m256i va = _mm256_set1_epi16(static_cast<short>(a));
+    const __m256i vb = _mm256_set1_epi16(static_cast<short>(b));
+    __m256i dx, dy;
+    int x = 1;
+    for (; (x + 17) <= width; x += 16)
+    {
+        _gradients16_avx2(dx, dy, prev, cur, next, x, va, vb);
+        // low and high 16 bits of products are interleaved into 32 bits values
+        _storeInterleaved_avx2(&outXX[x], _mm256_mullo_epi16(dx, dx), _mm256_mulhi_epi16(dx, dx));
+        _storeInterleaved_avx2(&outXY[x], _mm256_mullo_epi16(dx, dy), _mm256_mulhi_epi16(dx, dy));
+        _storeInterleaved_avx2(&outYY[x], _mm256_mullo_epi16(dy, dy), _mm256_mulhi_epi16(dy, dy));
+    }
+    _tensorRow_scalar(outXX, outXY, outYY, prev, cur, next, a, b, x, width - 1);
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+static inline int16x8_t _load8_neon(const uchar * data)
+{
+    return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(data)));
+}
+
+/// Gradients of 8 pixels from x
+static inline void _gradients8_neon(int16x8_t & dx, int16x8_t & dy,
+                                    const uchar * prev, const uchar * cur, const uchar * next,
+                                    int x, short a, short b)
+{
+    int16x8_t pL = _load8_neon(&prev[x - 1]), pC = _load8_neon(&prev[x]), pR = _load8_neon(&prev[x + 1]);
+    int16x8_t cL = _load8_neon(&cur[x - 1]), cR = _load8_neon(&cur[x + 1]);
+    int16x8_t nL = _load8_neon(&next[x - 1]), nC = _load8_neon(&next[x]), nR = _load8_neon(&next[x + 1]);
+    dx = vmlaq_n_s16(vmulq_n_s16(vaddq_s16(vsubq_s16(pR, pL), vsubq_s16(nR, nL)), a), vsubq_s16(cR, cL), b);
+    dy = vmlaq_n_s16(vmulq_n_s16(vaddq_s16(vsubq_s16(nL, pL), vsubq_s16(nR, pR)), a), vsubq_s16(nC, pC), b);
+}
+
+static void _gradientsRow_neon(short * out, const uchar * prev, const uchar * cur, const uchar * next,
+                               int width, int a, int b)
+{
+    int16x8x2_t d;
+    int x = 1;
+    for (; (x + 9) <= width; x += 8)
+    {
+        _gradients8_neon(d.val[0], d.val[1], prev, cur, next, x, static_cast<short>(a), static_cast<short>(b));
+        vst2q_s16(&out[x * 2], d);
+    }
+    _gradientsRow_scalar(out, prev, cur, next, a, b, x, width - 1);
+}
+
+static inline void _mul32_neon(int * out, int16x8_t u, int16x8_t v)
+{
+    vst1q_s32(out, vmull_s16(vget_low_s16(u), vget_low_s16(v)));
+    vst1q_s32(&out[4], vmull_s16(vget_high_s16(u), vget_high_s16(v)));
+}
+
+static void _tensorRow_neon(int * outXX, int * outXY, int * outYY,
+                            const uchar * prev, const uchar * cur, const uchar * next,
+                            int width, int a, int b)
+{
+    int16x8_t dx, dy;
+    int x = 1;
+    for (; (x + 9) <= width; x += 8)
+    {
+        _gradients8_neon(dx, dy, prev, cur, next, x, static_cast<short>(a), static_cast<short>(b));
+        _mul32_neon(&outXX[x], dx, dx);
+        _mul32_neon(&outXY[x], dx, dy);
+        _mul32_neon(&outYY[x], dy, dy);
+    }
+    _tensorRow_scalar(outXX, outXY, outYY, prev, cur, next, a, b, x, width - 1);
+}
+
+#endif
+
+static GradientsRowFunction _selectGradientsRow()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _gradientsRow_avx2;
+    if (features.sse2)
+        return _gradientsRow_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _gradientsRow_neon;
+#endif
+    (void)features;
+    return _gradientsRow_scalar;
+}
+
+static TensorRowFunction _selectTensorRow()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _tensorRow_avx2;
+    if (features.sse2)
+        return _tensorRow_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _tensorRow_neon;
+#endif
+    (void)features;
+    return _tensorRow_scalar;
+}
+
+void gradients_s(short * out, int outWidthStep, const uchar * in, int inWidthStep, int width, int height,
+                 GradientOperator gradientOperator, int beginRow, int endRow)
+{
+    static const KernelDispatch<GradientsRowFunction> function(_selectGradientsRow);
+    int a = 0, b = 0;
+    _coefficients(gradientOperator, a, b);
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        short * outStr = &out[y * outWidthStep * 2];
+        if ((y == 0) || (y == (height - 1)) || (width < 3))
+        {
+            std::fill(outStr, &outStr[width * 2], static_cast<short>(0));
+            continue;
+        }
+        outStr[0] = outStr[1] = 0;
+        function(outStr, &in[(y - 1) * inWidthStep], &in[y * inWidthStep], &in[(y + 1) * inWidthStep],
+                 width, a, b);
+        outStr[(width - 1) * 2] = outStr[(width - 1) * 2 + 1] = 0;
+    }
+}
+
+void structureTensor_i(int * outXX, int * outXY, int * outYY, int outWidthStep,
+                       const uchar * in, int inWidthStep, int width, int height,
+                       GradientOperator gradientOperator, int beginRow, int endRow)
+{
+    static const KernelDispatch<TensorRowFunction> function(_selectTensorRow);
+    int a = 0, b = 0;
+    _coefficients(gradientOperator, a, b);
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        int * strXX = &outXX[y * outWidthStep];
+        int * strXY = &outXY[y * outWidthStep];
+        int * strYY = &outYY[y * outWidthStep];
+        if ((y == 0) || (y == (height - 1)) || (width < 3))
+        {
+            std::fill(strXX, &strXX[width], 0);
+            std::fill(strXY, &strXY[width], 0);
+            std::fill(strYY, &strYY[width], 0);
+            continue;
+        }
+        strXX[0] = strXY[0] = strYY[0] = 0;
+        function(strXX, strXY, strYY, &in[(y - 1) * inWidthStep], &in[y * inWidthStep], &in[(y + 1) * inWidthStep],
+                 width, a, b);
+        strXX[width - 1] = strXY[width - 1] = strYY[width - 1] = 0;
+    }
+}
+
+} // namespace simd
+
+} // namespace sonar
@@ -0,0 +1,41 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_GRADIENTS_H
+#define SONAR_SIMD_GRADIENTS_H
+
+namespace sonar {
+
+namespace simd {
+
+/// Operators of gradients 3x3, dx is positive to the right, dy is positive to the bottom.
+/// All of them are written as dx = a * (d(row - 1) + d(row + 1)) + b * d(row), d(row) = I(x + 1) - I(x - 1).
+enum class GradientOperator
+{
+    CentralDifferences, // a = 0, b = 1
+    Sobel,              // a = 1, b = 2
+    Scharr              // a = 3, b = 10
+};
+
+/// Gradients of 8 bits image, dx and dy are interleaved: out[x * 2] = dx, out[x * 2 + 1] = dy,
+/// outWidthStep is in pixels (pairs of values). Pixels of border are zero.
+/// Only rows of out image from beginRow to endRow are computed, so image can be split between threads.
+/// Implementation (SSE2, AVX2, NEON or scalar) is selected on first call by features of processor.
+void gradients_s(short * out, int outWidthStep,
+                 const unsigned char * in, int inWidthStep, int width, int height,
+                 GradientOperator gradientOperator, int beginRow, int endRow);
+
+/// Planes of structure tensor dx * dx, dx * dy, dy * dy, which are computed from gradients in the same pass
+/// (gradients aren't stored). outWidthStep is the same for all planes. Pixels of border are zero.
+void structureTensor_i(int * outXX, int * outXY, int * outYY, int outWidthStep,
+                       const unsigned char * in, int inWidthStep, int width, int height,
+                       GradientOperator gradientOperator, int beginRow, int endRow);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_GRADIENTS_H
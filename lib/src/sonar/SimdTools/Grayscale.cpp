@@ -0,0 +1,231 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "Grayscale.h"
+#include "CpuFeatures.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+// out = (w[0] * p[0] + w[1] * p[1] + w[2] * p[2] + 2^13) >> 14, weights are given for positions of channels
+// in memory, so the order of channels doesn't change kernels. Sum of weights is 2^14, so out <= 255.
+// x86 versions bring pixels to 4 bytes (fourth byte has zero weight) and use madd of 16 bits pairs.
+
+using GrayscaleRowFunction = void (*)(uchar * out, const uchar * in, int width, const short * weights);
+
+template <int NumberChannels>
+static void _grayscaleRow_scalar(uchar * out, const uchar * in, int beginX, int endX, const short * weights)
+{
+    for (int x = beginX; x < endX; ++x)
+    {
+        const uchar * p = &in[x * NumberChannels];
+        out[x] = static_cast<uchar>((weights[0] * p[0] + weights[1] * p[1] + weights[2] * p[2] + (1 << 13)) >> 14);
+    }
+}
+
+template <int NumberChannels>
+static void _grayscaleRow_scalar(uchar * out, const uchar * in, int width, const short * weights)
+{
+    _grayscaleRow_scalar<NumberChannels>(out, in, 0, width, weights);
+}
+
+#if defined(SONAR_SIMD_X86)
+
+/// Luma of 4 pixels with 4 bytes
+SONAR_TARGET_SSE2
+static inline __m128i _luma4_sse2(__m128i v, __m128i weights)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = _mm_madd_epi16(_mm_unpacklo_epi8(v, zero), weights);
+    __m128i b = _mm_madd_epi16(_mm_unpackhi_epi8(v, zero), weights);
+    // Sums of pairs are in even 32 bits values
+    a = _mm_add_epi32(a, _mm_srli_epi64(a, 32));
+    b = _mm_add_epi32(b, _mm_srli_epi64(b, 32));
+    __m128i sum = _mm_unpacklo_epi64(_mm_shuffle_epi32(a, _MM_SHUFFLE(3, 1, 2, 0)),
+                                     _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 1, 2, 0)));
+    return _mm_srli_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1 << 13)), 14);
+}
+
+/// 4 pixels with 3 bytes are loaded as 4 values of 32 bits, so 1 byte after them is read too
+SONAR_TARGET_SSE2
+static inline __m128i _load4_rgb_sse2(const uchar * in)
+{
+    int p[4];
+    for (int k = 0; k < 4; ++k)
+        std::memcpy(&p[k], &in[k * 3], 4);
+    return _mm_setr_epi32(p[0], p[1], p[2], p[3]);
+}
+
+template <int NumberChannels>
+SONAR_TARGET_SSE2
+static void _grayscaleRow_sse2(uchar * out, const uchar * in, int width, const short * weights)
+{
+    const __m128i w = _mm_setr_epi16(weights[0], weights[1], weights[2], 0, weights[0], weights[1], weights[2], 0);
+    // Reading of 3 channels pixels goes 1 byte beyond the last pixel of iteration
+    const int endX = (NumberChannels == 4) ? (width - 8) : (width - 9);
+    int x = 0;
+    for (; x <= endX; x += 8)
+    {
+        __m128i a, b;
+        if (NumberChannels == 4)
+        {
+            a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[x * 4]));
+            b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[x * 4 + 16]));
+        }
+        else
+        {
+            a = _load4_rgb_sse2(&in[x * 3]);
+            b = _load4_rgb_sse2(&in[x * 3 + 12]);
+        }
+        __m128i v = _mm_packs_epi32(_luma4_sse2(a, w), _luma4_sse2(b, w));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x]), _mm_packus_epi16(v, v));
+    }
+    _grayscaleRow_scalar<NumberChannels>(out, in, x, width, weights);
+}
+
+template <int NumberChannels>
+SONAR_TARGET_AVX2
+static void _grayscaleRow_avx2(uchar * out, const uchar * in, int width, const short * weights)
+{
+    const __m256i w = _mm256_setr_epi16(weights[0], weights[1], weights[2], 0, weights[0], weights[1], weights[2], 0,
+                                        weights[0], weights[1], weights[2], 0, weights[0], weights[1], weights[2], 0);
+    // 3 bytes of pixels are spread to 4 bytes inside of every 128 bits lane
+    const __m256i spread = _mm256_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+                                            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i rounding = _mm256_set1_epi32(1 << 13);
+    const __m256i order = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+    // Loading of 3 channels pixels reads 4 bytes after the last pixel of iteration
+    const int endX = (NumberChannels == 4) ? (width - 8) : (width - 10);
+    int x = 0;
+    for (; x <= endX; x += 8)
+    {
+        __m256i v;
+        if (NumberChannels == 4)
+        {
+            v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&in[x * 4]));
+        }
+        else
+        {
+            v = _mm256_inserti128_si256(
+                        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[x * 3]))),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[x * 3 + 12])), 1);
+            v = _mm256_shuffle_epi8(v, spread);
+        }
+        __m256i a = _mm256_madd_epi16(_mm256_unpacklo_epi8(v, zero), w);
+        __m256i b = _mm256_madd_epi16(_mm256_unpackhi_epi8(v, zero), w);
+        // unpack and hadd work inside 128 bits lanes, together they keep the order of pixels
+        __m256i sum = _mm256_srli_epi32(_mm256_add_epi32(_mm256_hadd_epi32(a, b), rounding), 14);
+        sum = _mm256_packs_epi32(sum, sum);
+        sum = _mm256_permutevar8x32_epi32(_mm256_packus_epi16(sum, sum), order);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x]), _mm256_castsi256_si128(sum));
+    }
+    _grayscaleRow_scalar<NumberChannels>(out, in, x, width, weights);
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+template <int NumberChannels>
+static void _grayscaleRow_neon(uchar * out, const uchar * in, int width, const short * weights)
+{
+    const uint16_t w0 = static_cast<uint16_t>(weights[0]);
+    const uint16_t w1 = static_cast<uint16_t>(weights[1]);
+    const uint16_t w2 = static_cast<uint16_t>(weights[2]);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        uint8x8_t c0, c1, c2;
+        if (NumberChannels == 4)
+        {
+            uint8x8x4_t v = vld4_u8(&in[x * 4]);
+            c0 = v.val[0];
+            c1 = v.val[1];
+            c2 = v.val[2];
+        }
+        else
+        {
+            uint8x8x3_t v = vld3_u8(&in[x * 3]);
+            c0 = v.val[0];
+            c1 = v.val[1];
+            c2 = v.val[2];
+        }
+        uint16x8_t v0 = vmovl_u8(c0), v1 = vmovl_u8(c1), v2 = vmovl_u8(c2);
+        uint32x4_t lo = vmull_n_u16(vget_low_u16(v0), w0);
+        uint32x4_t hi = vmull_n_u16(vget_high_u16(v0), w0);
+        lo = vmlal_n_u16(lo, vget_low_u16(v1), w1);
+        hi = vmlal_n_u16(hi, vget_high_u16(v1), w1);
+        lo = vmlal_n_u16(lo, vget_low_u16(v2), w2);
+        hi = vmlal_n_u16(hi, vget_high_u16(v2), w2);
+        vst1_u8(&out[x], vmovn_u16(vcombine_u16(vrshrn_n_u32(lo, 14), vrshrn_n_u32(hi, 14))));
+    }
+    _grayscaleRow_scalar<NumberChannels>(out, in, x, width, weights);
+}
+
+#endif
+
+template <int NumberChannels>
+static GrayscaleRowFunction _selectGrayscaleRow()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _grayscaleRow_avx2<NumberChannels>;
+    if (features.sse2)
+        return _grayscaleRow_sse2<NumberChannels>;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _grayscaleRow_neon<NumberChannels>;
+#endif
+    (void)features;
+    return _grayscaleRow_scalar<NumberChannels>;
+}
+
+static void _weights(short * weights, ChannelOrder order, LumaStandard standard)
+{
+    // Rounded values of kr, kg, kb * 2^14 with sum 2^14
+    short kr = 4899, kg = 9617, kb = 1868;
+    if (standard == LumaStandard::Bt709)
+    {
+        kr = 3483;
+        kg = 11718;
+        kb = 1183;
+    }
+    weights[0] = (order == ChannelOrder::Rgb) ? kr : kb;
+    weights[1] = kg;
+    weights[2] = (order == ChannelOrder::Rgb) ? kb : kr;
+}
+
+void grayscale_u(uchar * out, int outWidthStep, const uchar * in, int inWidthStep,
+                 int width, int numberChannels, ChannelOrder order, LumaStandard standard,
+                 int beginRow, int endRow)
+{
+    static const KernelDispatch<GrayscaleRowFunction> function3(_selectGrayscaleRow<3>);
+    static const KernelDispatch<GrayscaleRowFunction> function4(_selectGrayscaleRow<4>);
+    assert((numberChannels == 3) || (numberChannels == 4));
+    short weights[3];
+    _weights(weights, order, standard);
+    GrayscaleRowFunction function = (numberChannels == 3) ? function3.get() : function4.get();
+    for (int y = beginRow; y < endRow; ++y)
+        function(&out[y * outWidthStep], &in[y * inWidthStep], width, weights);
+}
+
+} // namespace simd
+
+} // namespace sonar
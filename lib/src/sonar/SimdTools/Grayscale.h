@@ -0,0 +1,40 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_GRAYSCALE_H
+#define SONAR_SIMD_GRAYSCALE_H
+
+namespace sonar {
+
+namespace simd {
+
+/// Weights of luma Y = kr * R + kg * G + kb * B
+enum class LumaStandard
+{
+    Bt601, // kr = 0.299, kg = 0.587, kb = 0.114 (SD video, JPEG)
+    Bt709  // kr = 0.2126, kg = 0.7152, kb = 0.0722 (HD video)
+};
+
+/// Order of channels of color pixel in memory, alpha is always the last channel
+enum class ChannelOrder
+{
+    Rgb, // RGB and RGBA
+    Bgr  // BGR and BGRA (for example, frames of OpenCV)
+};
+
+/// Luma of 8 bits color image with 3 or 4 channels, weights are in fixed point with 14 bits of fraction,
+/// results are rounded to nearest. inWidthStep is in bytes.
+/// Only rows from beginRow to endRow are computed, so image can be split between threads.
+/// Implementation (SSE2, AVX2, NEON or scalar) is selected on first call by features of processor.
+void grayscale_u(unsigned char * out, int outWidthStep, const unsigned char * in, int inWidthStep,
+                 int width, int numberChannels, ChannelOrder order, LumaStandard standard,
+                 int beginRow, int endRow);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_GRAYSCALE_H
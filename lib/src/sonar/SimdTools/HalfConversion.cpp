@@ -0,0 +1,230 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "HalfConversion.h"
+#include "CpuFeatures.h"
+
+#include <algorithm>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+using ToHalfFunction = void (*)(std::uint16_t * out, const float * in, int count);
+using FromHalfFunction = void (*)(float * out, const std::uint16_t * in, int count);
+
+static void _convertToHalf_scalar(std::uint16_t * out, const float * in, int begin, int end)
+{
+    for (int i = begin; i < end; ++i)
+        out[i] = floatToHalf(in[i]);
+}
+
+static void _convertFromHalf_scalar(float * out, const std::uint16_t * in, int begin, int end)
+{
+    for (int i = begin; i < end; ++i)
+        out[i] = halfToFloat(in[i]);
+}
+
+static void _convertToHalf_scalar(std::uint16_t * out, const float * in, int count)
+{
+    _convertToHalf_scalar(out, in, 0, count);
+}
+
+static void _convertFromHalf_scalar(float * out, const std::uint16_t * in, int count)
+{
+    _convertFromHalf_scalar(out, in, 0, count);
+}
+
+#if defined(SONAR_SIMD_X86)
+
+// SSE2 versions repeat scalar bit tricks for 4 values, so results are the same as of F16C
+SONAR_TARGET_SSE2
+static __m128i _toHalf4_sse2(__m128 value)
+{
+    const __m128i f = _mm_castps_si128(value);
+    const __m128i sign = _mm_and_si128(f, _mm_set1_epi32(static_cast<int>(0x80000000u)));
+    const __m128i absF = _mm_xor_si128(f, sign);
+    // Subnormal results
+    const __m128i magic = _mm_set1_epi32(126 << 23);
+    const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(absF),
+                                                                        _mm_castsi128_ps(magic))), magic);
+    // Normal results
+    const __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(absF, 13), _mm_set1_epi32(1));
+    const __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(absF, _mm_set1_epi32(static_cast<int>(0xc8000fffu))),
+                                                        mantissaOdd), 13);
+    // Infinities and NaNs
+    const __m128i isNan = _mm_cmpgt_epi32(absF, _mm_set1_epi32(0x7f800000));
+    const __m128i nan = _mm_and_si128(isNan, _mm_or_si128(_mm_set1_epi32(0x200),
+                                                          _mm_and_si128(_mm_srli_epi32(absF, 13), _mm_set1_epi32(0x3ff))));
+    const __m128i infNan = _mm_or_si128(_mm_set1_epi32(0x7c00), nan);
+    const __m128i isSubnormal = _mm_cmpgt_epi32(_mm_set1_epi32(0x38800000), absF);
+    const __m128i isRegular = _mm_cmpgt_epi32(_mm_set1_epi32(0x47800000), absF);
+    __m128i h = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+    h = _mm_or_si128(_mm_and_si128(isRegular, h), _mm_andnot_si128(isRegular, infNan));
+    h = _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+    // Sign extension of 16 bits values, so signed packing doesn't saturate them
+    return _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+}
+
+SONAR_TARGET_SSE2
+static __m128 _fromHalf4_sse2(__m128i h)
+{
+    const __m128i expMantissa = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+    const __m128i sign = _mm_slli_epi32(_mm_xor_si128(h, expMantissa), 16);
+    const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expMantissa, 13)),
+                                     _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23)));
+    const __m128i isInfNan = _mm_cmpgt_epi32(expMantissa, _mm_set1_epi32(0x7bff));
+    const __m128i isNan = _mm_cmpgt_epi32(expMantissa, _mm_set1_epi32(0x7c00));
+    __m128i infNanBits = _mm_or_si128(_mm_and_si128(isInfNan, _mm_set1_epi32(0x7f800000)),
+                                      _mm_and_si128(isNan, _mm_set1_epi32(0x00400000)));
+    return _mm_or_ps(scaled, _mm_castsi128_ps(_mm_or_si128(sign, infNanBits)));
+}
+
+SONAR_TARGET_SSE2
+static void _convertToHalf_sse2(std::uint16_t * out, const float * in, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i a = _toHalf4_sse2(_mm_loadu_ps(&in[i]));
+        __m128i b = _toHalf4_sse2(_mm_loadu_ps(&in[i + 4]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]), _mm_packs_epi32(a, b));
+    }
+    _convertToHalf_scalar(out, in, i, count);
+}
+
+SONAR_TARGET_SSE2
+static void _convertFromHalf_sse2(float * out, const std::uint16_t * in, int count)
+{
+    int i = 0;
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]));
+        _mm_storeu_ps(&out[i], _fromHalf4_sse2(_mm_unpacklo_epi16(h, zero)));
+        _mm_storeu_ps(&out[i + 4], _fromHalf4_sse2(_mm_unpackhi_epi16(h, zero)));
+    }
+    _convertFromHalf_scalar(out, in, i, count);
+}
+
+SONAR_TARGET_F16C
+static void _convertToHalf_f16c(std::uint16_t * out, const float * in, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[i]),
+                         _mm256_cvtps_ph(_mm256_loadu_ps(&in[i]), _MM_FROUND_TO_NEAREST_INT));
+    _convertToHalf_scalar(out, in, i, count);
+}
+
+SONAR_TARGET_F16C
+static void _convertFromHalf_f16c(float * out, const std::uint16_t * in, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(&out[i], _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i]))));
+    _convertFromHalf_scalar(out, in, i, count);
+}
+
+#elif defined(SONAR_SIMD_NEON) && defined(__aarch64__)
+
+static void _convertToHalf_neon(std::uint16_t * out, const float * in, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        float16x4_t a = vcvt_f16_f32(vld1q_f32(&in[i]));
+        float16x4_t b = vcvt_f16_f32(vld1q_f32(&in[i + 4]));
+        vst1q_u16(&out[i], vcombine_u16(vreinterpret_u16_f16(a), vreinterpret_u16_f16(b)));
+    }
+    _convertToHalf_scalar(out, in, i, count);
+}
+
+static void _convertFromHalf_neon(float * out, const std::uint16_t * in, int count)
+{
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint16x8_t h = vld1q_u16(&in[i]);
+        vst1q_f32(&out[i], vcvt_f32_f16(vreinterpret_f16_u16(vget_low_u16(h))));
+        vst1q_f32(&out[i + 4], vcvt_f32_f16(vreinterpret_f16_u16(vget_high_u16(h))));
+    }
+    _convertFromHalf_scalar(out, in, i, count);
+}
+
+#endif
+
+static ToHalfFunction _selectConvertToHalf()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.f16c)
+        return _convertToHalf_f16c;
+    if (features.sse2)
+        return _convertToHalf_sse2;
+#elif defined(SONAR_SIMD_NEON) && defined(__aarch64__)
+    if (features.neon)
+        return _convertToHalf_neon;
+#endif
+    (void)features;
+    return _convertToHalf_scalar;
+}
+
+static FromHalfFunction _selectConvertFromHalf()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.f16c)
+        return _convertFromHalf_f16c;
+    if (features.sse2)
+        return _convertFromHalf_sse2;
+#elif defined(SONAR_SIMD_NEON) && defined(__aarch64__)
+    if (features.neon)
+        return _convertFromHalf_neon;
+#endif
+    (void)features;
+    return _convertFromHalf_scalar;
+}
+
+void convertToHalf_f(std::uint16_t * out, const float * in, int count)
+{
+    static const KernelDispatch<ToHalfFunction> function(_selectConvertToHalf);
+    function(out, in, count);
+}
+
+void convertToHalf_u(std::uint16_t * out, const uchar * in, int count)
+{
+    // Values are widened to floats by blocks on stack (this loop is vectorized by compiler),
+    // blocks are converted by the selected kernel
+    const int blockSize = 256;
+    float block[blockSize];
+    for (int i = 0; i < count; i += blockSize)
+    {
+        int size = std::min(blockSize, count - i);
+        for (int j = 0; j < size; ++j)
+            block[j] = static_cast<float>(in[i + j]);
+        convertToHalf_f(&out[i], block, size);
+    }
+}
+
+void convertFromHalf_f(float * out, const std::uint16_t * in, int count)
+{
+    static const KernelDispatch<FromHalfFunction> function(_selectConvertFromHalf);
+    function(out, in, count);
+}
+
+} // namespace simd
+
+} // namespace sonar
@@ -0,0 +1,94 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_HALFCONVERSION_H
+#define SONAR_SIMD_HALFCONVERSION_H
+
+#include <cstdint>
+#include <cstring>
+
+namespace sonar {
+
+namespace simd {
+
+/// Conversion of float to IEEE 754 half precision (binary16) with rounding to nearest even.
+/// Values greater than max of half become infinity, NaN stays quiet NaN with the high bits of payload.
+inline std::uint16_t floatToHalf(float value)
+{
+    std::uint32_t f;
+    std::memcpy(&f, &value, sizeof(f));
+    const std::uint32_t sign = f & 0x80000000u;
+    f ^= sign;
+    std::uint16_t h;
+    if (f >= 0x47800000u) // 65536 and greater, infinity and NaN
+    {
+        h = (f > 0x7f800000u) ? static_cast<std::uint16_t>(0x7e00u | ((f >> 13) & 0x3ffu)) : 0x7c00u;
+    }
+    else if (f < 0x38800000u) // result is subnormal or zero
+    {
+        // Adding of 0.5 shifts mantissa to the position of subnormal half, rounding is done by the float adder
+        const std::uint32_t magicBits = 126u << 23;
+        float magic, sum;
+        std::memcpy(&magic, &magicBits, sizeof(magic));
+        std::memcpy(&sum, &f, sizeof(sum));
+        sum += magic;
+        std::uint32_t sumBits;
+        std::memcpy(&sumBits, &sum, sizeof(sumBits));
+        h = static_cast<std::uint16_t>(sumBits - magicBits);
+    }
+    else
+    {
+        const std::uint32_t mantissaOdd = (f >> 13) & 1u;
+        f += 0xc8000fffu + mantissaOdd; // rebias of exponent and rounding of the lowest 13 bits
+        h = static_cast<std::uint16_t>(f >> 13);
+    }
+    return static_cast<std::uint16_t>(h | (sign >> 16));
+}
+
+/// Exact conversion of half precision to float, NaN becomes quiet NaN.
+inline float halfToFloat(std::uint16_t value)
+{
+    const std::uint32_t sign = static_cast<std::uint32_t>(value & 0x8000u) << 16;
+    const std::uint32_t expMantissa = value & 0x7fffu;
+    std::uint32_t f;
+    if (expMantissa >= 0x7c00u)
+    {
+        f = 0x7f800000u | (expMantissa << 13);
+        if (expMantissa > 0x7c00u)
+            f |= 0x00400000u;
+    }
+    else
+    {
+        // Multiplication by 2^112 rebiases exponent and normalizes subnormals
+        const std::uint32_t magicBits = (254u - 15u) << 23;
+        float magic, shifted;
+        std::uint32_t shiftedBits = expMantissa << 13;
+        std::memcpy(&magic, &magicBits, sizeof(magic));
+        std::memcpy(&shifted, &shiftedBits, sizeof(shifted));
+        shifted *= magic;
+        std::memcpy(&f, &shifted, sizeof(f));
+    }
+    f |= sign;
+    float result;
+    std::memcpy(&result, &f, sizeof(result));
+    return result;
+}
+
+/// Conversion of array of floats to half precision, results are equal to floatToHalf.
+/// Implementation (F16C, SSE2, NEON or scalar) is selected on first call by features of processor.
+void convertToHalf_f(std::uint16_t * out, const float * in, int count);
+
+/// Conversion of array of 8 bits values to half precision (all of them are exact in half).
+void convertToHalf_u(std::uint16_t * out, const unsigned char * in, int count);
+
+/// Conversion of array of half precision values to floats, results are equal to halfToFloat.
+void convertFromHalf_f(float * out, const std::uint16_t * in, int count);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_HALFCONVERSION_H
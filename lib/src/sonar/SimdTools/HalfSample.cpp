@@ -0,0 +1,352 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "HalfSample.h"
+#include "CpuFeatures.h"
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+using HalfSampleFunction = void (*)(uchar * out, int outWidthStep, const uchar * in, int inWidthStep,
+                                    int outWidth, int outHeight);
+
+// Sums are computed in 16 bits, rounding averages of bytes (pavgb, vrhadd) round up twice
+// and don't give the same result as scalar version.
+
+static void _halfSampleRow_scalar(uchar * out, const uchar * inA, const uchar * inB, int beginX, int endX)
+{
+    for (int x = beginX; x < endX; ++x)
+    {
+        int inX = x * 2;
+        out[x] = static_cast<uchar>((inA[inX] + inA[inX + 1] + inB[inX] + inB[inX + 1]) >> 2);
+    }
+}
+
+static void _halfSample_scalar(uchar * out, int outWidthStep, const uchar * in, int inWidthStep,
+                               int outWidth, int outHeight)
+{
+    for (int y = 0; y < outHeight; ++y)
+    {
+        const uchar * inA = &in[(y * 2) * inWidthStep];
+        _halfSampleRow_scalar(&out[y * outWidthStep], inA, &inA[inWidthStep], 0, outWidth);
+    }
+}
+
+#if defined(SONAR_SIMD_X86)
+
+SONAR_TARGET_SSE2
+static void _halfSample_sse2(uchar * out, int outWidthStep, const uchar * in, int inWidthStep,
+                             int outWidth, int outHeight)
+{
+    const __m128i mask = _mm_set1_epi16(0x00FF);
+    int endX16 = outWidth & ~15;
+    for (int y = 0; y < outHeight; ++y)
+    {
+        const uchar * inA = &in[(y * 2) * inWidthStep];
+        const uchar * inB = &inA[inWidthStep];
+        uchar * outStr = &out[y * outWidthStep];
+        for (int x = 0; x < endX16; x += 16)
+        {
+            __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inA[x * 2]));
+            __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inA[x * 2 + 16]));
+            __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inB[x * 2]));
+            __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inB[x * 2 + 16]));
+            __m128i sum0 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a0, mask), _mm_srli_epi16(a0, 8)),
+                                         _mm_add_epi16(_mm_and_si128(b0, mask), _mm_srli_epi16(b0, 8)));
+            __m128i sum1 = _mm_add_epi16(_mm_add_epi16(_mm_and_si128(a1, mask), _mm_srli_epi16(a1, 8)),
+                                         _mm_add_epi16(_mm_and_si128(b1, mask), _mm_srli_epi16(b1, 8)));
+            __m128i result = _mm_packus_epi16(_mm_srli_epi16(sum0, 2), _mm_srli_epi16(sum1, 2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&outStr[x]), result);
+        }
+        _halfSampleRow_scalar(outStr, inA, inB, endX16, outWidth);
+    }
+}
+
+SONAR_TARGET_AVX2
+static void _halfSample_avx2(uchar * out, int outWidthStep, const uchar * in, int inWidthStep,
+                             int outWidth, int outHeight)
+{
+    const __m256i mask = _mm256_set1_epi16(0x00FF);
+    int endX32 = outWidth & ~31;
+    for (int y = 0; y < outHeight; ++y)
+    {
+        const uchar * inA = &in[(y * 2) * inWidthStep];
+        const uchar * inB = &inA[inWidthStep];
+        uchar * outStr = &out[y * outWidthStep];
+        for (int x = 0; x < endX32; x += 32)
+        {
+            __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&inA[x * 2]));
+            __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&inA[x * 2 + 32]));
+            __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&inB[x * 2]));
+            __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&inB[x * 2 + 32]));
+            __m256i sum0 = _mm256_add_epi16(_mm256_add_epi16(_mm256_and_si256(a0, mask),
+                                                             _mm256_srli_epi16(a0, 8)),
+                                            _mm256_add_epi16(_mm256_and_si256(b0, mask),
+                                                             _mm256_srli_epi16(b0, 8)));
+            __m256i sum1 = _mm256_add_epi16(_mm256_add_epi16(_mm256_and_si256(a1, mask),
+                                                             _mm256_srli_epi16(a1, 8)),
+                                            _mm256_add_epi16(_mm256_and_si256(b1, mask),
+                                                             _mm256_srli_epi16(b1, 8)));
+            // packing works inside of 128 bits lanes, so order of quarters is restored by permutation
+            __m256i result = _mm256_packus_epi16(_mm256_srli_epi16(sum0, 2), _mm256_srli_epi16(sum1, 2));
+            result = _mm256_permute4x64_epi64(result, 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(&outStr[x]), result);
+        }
+        _halfSampleRow_scalar(outStr, inA, inB, endX32, outWidth);
+    }
+}
+
+SONAR_TARGET_AVX512
+static void _halfSample_avx512(uchar * out, int outWidthStep, const uchar * in, int inWidthStep,
+                               int outWidth, int outHeight)
+{
+    // Pairs of bytes are summed by multiplication with ones (vpmaddubsw)
+    const __m512i ones = _mm512_set1_epi8(1);
+    const __m512i order = _mm512_set_epi64(7, 5, 3, 1, 6, 4, 2, 0);
+    int endX64 = outWidth & ~63;
+    for (int y = 0; y < outHeight; ++y)
+    {
+        const uchar * inA = &in[(y * 2) * inWidthStep];
+        const uchar * inB = &inA[inWidthStep];
+        uchar * outStr = &out[y * outWidthStep];
+        for (int x = 0; x < endX64; x += 64)
+        {
+            __m512i sum0 = _mm512_add_epi16(_mm512_maddubs_epi16(_mm512_loadu_si512(&inA[x * 2]), ones),
+                                            _mm512_maddubs_epi16(_mm512_loadu_si512(&inB[x * 2]), ones));
+            __m512i sum1 = _mm512_add_epi16(_mm512_maddubs_epi16(_mm512_loadu_si512(&inA[x * 2 + 64]), ones),
+                                            _mm512_maddubs_epi16(_mm512_loadu_si512(&inB[x * 2 + 64]), ones));
+            __m512i result = _mm512_packus_epi16(_mm512_srli_epi16(sum0, 2), _mm512_srli_epi16(sum1, 2));
+            // packing works inside of 128 bits lanes (maskz form avoids undefined source of unmasked version)
+            _mm512_storeu_si512(&outStr[x], _mm512_maskz_permutexvar_epi64(0xFF, order, result));
+        }
+        _halfSampleRow_scalar(outStr, inA, inB, endX64, outWidth);
+    }
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+static void _halfSample_neon(uchar * out, int outWidthStep, const uchar * in, int inWidthStep,
+                             int outWidth, int outHeight)
+{
+    int endX16 = outWidth & ~15;
+    for (int y = 0; y < outHeight; ++y)
+    {
+        const uchar * inA = &in[(y * 2) * inWidthStep];
+        const uchar * inB = &inA[inWidthStep];
+        uchar * outStr = &out[y * outWidthStep];
+        for (int x = 0; x < endX16; x += 16)
+        {
+            uint16x8_t sum0 = vpaddlq_u8(vld1q_u8(&inA[x * 2]));
+            uint16x8_t sum1 = vpaddlq_u8(vld1q_u8(&inA[x * 2 + 16]));
+            sum0 = vpadalq_u8(sum0, vld1q_u8(&inB[x * 2]));
+            sum1 = vpadalq_u8(sum1, vld1q_u8(&inB[x * 2 + 16]));
+            vst1q_u8(&outStr[x], vcombine_u8(vshrn_n_u16(sum0, 2), vshrn_n_u16(sum1, 2)));
+        }
+        _halfSampleRow_scalar(outStr, inA, inB, endX16, outWidth);
+    }
+}
+
+#endif
+
+using HalfSampleGauss5Function = void (*)(uchar * out, const uchar * const * in, int inWidth,
+                                          std::uint16_t * row);
+
+// Filter is computed by columns into 16 bits buffer (sums are <= 16 * 255), then by rows with
+// decimation (sums are <= 256 * 255 + 128), so all values fit into 16 bits without overflow.
+// Buffer has 2 replicated elements before and after the row.
+
+static void _gauss5Column_scalar(std::uint16_t * row, const uchar * const * in, int beginX, int endX)
+{
+    for (int x = beginX; x < endX; ++x)
+    {
+        row[x] = static_cast<std::uint16_t>(in[0][x] + in[4][x] + ((in[1][x] + in[3][x]) << 2) + in[2][x] * 6);
+    }
+}
+
+static void _gauss5Row_scalar(uchar * out, const std::uint16_t * row, int beginX, int endX)
+{
+    for (int x = beginX; x < endX; ++x)
+    {
+        const std::uint16_t * r = &row[x * 2];
+        out[x] = static_cast<uchar>((r[-2] + r[2] + ((r[-1] + r[1]) << 2) + r[0] * 6 + 128) >> 8);
+    }
+}
+
+static void _halfSampleGauss5_scalar(uchar * out, const uchar * const * in, int inWidth,
+                                     std::uint16_t * row)
+{
+    _gauss5Column_scalar(row, in, 0, inWidth);
+    row[-2] = row[-1] = row[0];
+    row[inWidth] = row[inWidth + 1] = row[inWidth - 1];
+    _gauss5Row_scalar(out, row, 0, inWidth / 2);
+}
+
+#if defined(SONAR_SIMD_X86)
+
+SONAR_TARGET_SSE2
+static void _halfSampleGauss5_sse2(uchar * out, const uchar * const * in, int inWidth,
+                                   std::uint16_t * row)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int endX16 = inWidth & ~15;
+    for (int x = 0; x < endX16; x += 16)
+    {
+        __m128i s[5];
+        for (int i = 0; i < 5; ++i)
+            s[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[i][x]));
+        for (int half = 0; half < 2; ++half)
+        {
+            __m128i v[5];
+            for (int i = 0; i < 5; ++i)
+                v[i] = (half == 0) ? _mm_unpacklo_epi8(s[i], zero) : _mm_unpackhi_epi8(s[i], zero);
+            __m128i sum = _mm_add_epi16(_mm_add_epi16(v[0], v[4]),
+                                        _mm_slli_epi16(_mm_add_epi16(v[1], v[3]), 2));
+            sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_slli_epi16(v[2], 2), _mm_slli_epi16(v[2], 1)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&row[x + half * 8]), sum);
+        }
+    }
+    _gauss5Column_scalar(row, in, endX16, inWidth);
+    row[-2] = row[-1] = row[0];
+    row[inWidth] = row[inWidth + 1] = row[inWidth - 1];
+
+    const __m128i mask = _mm_set1_epi32(0xFFFF);
+    const __m128i half = _mm_set1_epi16(128);
+    int outWidth = inWidth / 2;
+    // The last pixels are computed by scalar code, so loads don't go outside of buffer
+    int endX8 = ((outWidth - 1) / 8) * 8;
+    for (int x = 0; x < endX8; x += 8)
+    {
+        const std::uint16_t * r = &row[x * 2];
+        __m128i even[3], odd[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&r[i * 2 - 2]));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&r[i * 2 + 6]));
+            // values are less than 2^15, so signed packing doesn't saturate
+            even[i] = _mm_packs_epi32(_mm_and_si128(a, mask), _mm_and_si128(b, mask));
+            odd[i] = _mm_packs_epi32(_mm_srli_epi32(a, 16), _mm_srli_epi32(b, 16));
+        }
+        __m128i sum = _mm_add_epi16(_mm_add_epi16(even[0], even[2]),
+                                    _mm_slli_epi16(_mm_add_epi16(odd[0], odd[1]), 2));
+        sum = _mm_add_epi16(sum, _mm_add_epi16(_mm_slli_epi16(even[1], 2), _mm_slli_epi16(even[1], 1)));
+        sum = _mm_srli_epi16(_mm_add_epi16(sum, half), 8);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x]), _mm_packus_epi16(sum, sum));
+    }
+    _gauss5Row_scalar(out, row, endX8, outWidth);
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+static void _halfSampleGauss5_neon(uchar * out, const uchar * const * in, int inWidth,
+                                   std::uint16_t * row)
+{
+    const uint8x8_t four = vdup_n_u8(4);
+    const uint8x8_t six = vdup_n_u8(6);
+    int endX8 = inWidth & ~7;
+    for (int x = 0; x < endX8; x += 8)
+    {
+        uint16x8_t sum = vaddl_u8(vld1_u8(&in[0][x]), vld1_u8(&in[4][x]));
+        sum = vmlal_u8(sum, vld1_u8(&in[1][x]), four);
+        sum = vmlal_u8(sum, vld1_u8(&in[3][x]), four);
+        sum = vmlal_u8(sum, vld1_u8(&in[2][x]), six);
+        vst1q_u16(&row[x], sum);
+    }
+    _gauss5Column_scalar(row, in, endX8, inWidth);
+    row[-2] = row[-1] = row[0];
+    row[inWidth] = row[inWidth + 1] = row[inWidth - 1];
+
+    const uint16x8_t six16 = vdupq_n_u16(6);
+    int outWidth = inWidth / 2;
+    int endOutX8 = ((outWidth - 1) / 8) * 8;
+    for (int x = 0; x < endOutX8; x += 8)
+    {
+        const std::uint16_t * r = &row[x * 2];
+        uint16x8x2_t a = vld2q_u16(&r[-2]);
+        uint16x8x2_t b = vld2q_u16(&r[0]);
+        uint16x8x2_t c = vld2q_u16(&r[2]);
+        uint16x8_t sum = vaddq_u16(a.val[0], c.val[0]);
+        sum = vaddq_u16(sum, vshlq_n_u16(vaddq_u16(a.val[1], b.val[1]), 2));
+        sum = vmlaq_u16(sum, b.val[0], six16);
+        vst1_u8(&out[x], vrshrn_n_u16(sum, 8));
+    }
+    _gauss5Row_scalar(out, row, endOutX8, outWidth);
+}
+
+#endif
+
+static HalfSampleGauss5Function _selectHalfSampleGauss5()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.sse2)
+        return _halfSampleGauss5_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _halfSampleGauss5_neon;
+#endif
+    (void)features;
+    return _halfSampleGauss5_scalar;
+}
+
+static HalfSampleFunction _selectHalfSample()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx512)
+        return _halfSample_avx512;
+    if (features.avx2)
+        return _halfSample_avx2;
+    if (features.sse2)
+        return _halfSample_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _halfSample_neon;
+#endif
+    (void)features;
+    return _halfSample_scalar;
+}
+
+void halfSample_u(uchar * out, int outWidthStep, const uchar * in, int inWidthStep,
+                  int outWidth, int outHeight)
+{
+    static const KernelDispatch<HalfSampleFunction> function(_selectHalfSample);
+    function(out, outWidthStep, in, inWidthStep, outWidth, outHeight);
+}
+
+void halfSampleGauss5_u(uchar * out, int outWidthStep,
+                        const uchar * in, int inWidthStep, int inWidth, int inHeight,
+                        int beginRow, int endRow)
+{
+    static const KernelDispatch<HalfSampleGauss5Function> function(_selectHalfSampleGauss5);
+    if ((inWidth < 2) || (beginRow >= endRow))
+        return;
+    std::vector<std::uint16_t> rowBuffer(static_cast<std::size_t>(inWidth + 4));
+    const uchar * rows[5];
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        for (int i = 0; i < 5; ++i)
+            rows[i] = &in[std::min(std::max(y * 2 + i - 2, 0), inHeight - 1) * inWidthStep];
+        function(&out[y * outWidthStep], rows, inWidth, &rowBuffer[2]);
+    }
+}
+
+} // namespace simd
+
+} // namespace sonar
@@ -0,0 +1,32 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_HALFSAMPLE_H
+#define SONAR_SIMD_HALFSAMPLE_H
+
+namespace sonar {
+
+namespace simd {
+
+/// Averaging of blocks 2x2 of 8 bits image: out = (a + b + c + d) / 4 with rounding down,
+/// so the result is the same as image_utils::halfSample<Sampler_avg<int>, uchar>.
+/// Implementation (SSE2, AVX2, NEON or scalar) is selected on first call by features of processor.
+void halfSample_u(unsigned char * out, int outWidthStep,
+                  const unsigned char * in, int inWidthStep,
+                  int outWidth, int outHeight);
+
+/// Binomial filter 5x5 ([1 4 6 4 1] / 16 by both axes) with decimation of 8 bits image in one pass,
+/// result is rounded to nearest. Borders are replicated.
+/// Only rows of out image from beginRow to endRow are computed, so image can be split between threads.
+void halfSampleGauss5_u(unsigned char * out, int outWidthStep,
+                        const unsigned char * in, int inWidthStep, int inWidth, int inHeight,
+                        int beginRow, int endRow);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_HALFSAMPLE_H
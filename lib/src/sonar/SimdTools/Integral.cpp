@@ -0,0 +1,211 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "Integral.h"
+#include "CpuFeatures.h"
+
+#include <cassert>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+// Row is integrated by prefix sums and sums of previous row (prevSum, prevSquaredSum) are added to it.
+// prevSum is nullptr for the first row of band, outSquaredSum is nullptr if squares aren't needed.
+
+using IntegralRowFunction = void (*)(int * outSum, std::int64_t * outSquaredSum,
+                                     const int * prevSum, const std::int64_t * prevSquaredSum,
+                                     const uchar * in, int width);
+
+static void _integralRow_scalar(int * outSum, std::int64_t * outSquaredSum,
+                                const int * prevSum, const std::int64_t * prevSquaredSum,
+                                const uchar * in, int beginX, int endX, int rowSum, std::uint32_t rowSquaredSum)
+{
+    for (int x = beginX; x < endX; ++x)
+    {
+        rowSum += in[x];
+        outSum[x] = (prevSum != nullptr) ? (rowSum + prevSum[x]) : rowSum;
+    }
+    if (outSquaredSum == nullptr)
+        return;
+    for (int x = beginX; x < endX; ++x)
+    {
+        rowSquaredSum += static_cast<std::uint32_t>(in[x] * in[x]);
+        outSquaredSum[x] = (prevSquaredSum != nullptr) ? (rowSquaredSum + prevSquaredSum[x]) :
+                                                         static_cast<std::int64_t>(rowSquaredSum);
+    }
+}
+
+static void _integralRow_scalar(int * outSum, std::int64_t * outSquaredSum,
+                                const int * prevSum, const std::int64_t * prevSquaredSum,
+                                const uchar * in, int width)
+{
+    _integralRow_scalar(outSum, outSquaredSum, prevSum, prevSquaredSum, in, 0, width, 0, 0u);
+}
+
+#if defined(SONAR_SIMD_X86)
+
+/// Inclusive prefix sum of 4 values of 32 bits plus carry, carry becomes the last sum
+SONAR_TARGET_SSE2
+static inline __m128i _prefixSum4_sse2(__m128i v, __m128i & carry)
+{
+    v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+    v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+    v = _mm_add_epi32(v, carry);
+    carry = _mm_shuffle_epi32(v, 0xFF);
+    return v;
+}
+
+SONAR_TARGET_SSE2
+static void _integralRow_sse2(int * outSum, std::int64_t * outSquaredSum,
+                              const int * prevSum, const std::int64_t * prevSquaredSum,
+                              const uchar * in, int width)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i carry = zero, carrySquared = zero;
+    int endX16 = width & ~15;
+    for (int x = 0; x < endX16; x += 16)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&in[x]));
+        __m128i v16[2] = { _mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero) };
+        for (int i = 0; i < 4; ++i)
+        {
+            int cx = x + i * 4;
+            __m128i v32 = ((i & 1) == 0) ? _mm_unpacklo_epi16(v16[i >> 1], zero) :
+                                           _mm_unpackhi_epi16(v16[i >> 1], zero);
+            __m128i sum = _prefixSum4_sse2(v32, carry);
+            if (prevSum != nullptr)
+                sum = _mm_add_epi32(sum, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&prevSum[cx])));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&outSum[cx]), sum);
+            if (outSquaredSum == nullptr)
+                continue;
+            // high halves of 32 bits values are zero, so madd gives squares
+            __m128i squaredSum = _prefixSum4_sse2(_mm_madd_epi16(v32, v32), carrySquared);
+            __m128i lo = _mm_unpacklo_epi32(squaredSum, zero);
+            __m128i hi = _mm_unpackhi_epi32(squaredSum, zero);
+            if (prevSquaredSum != nullptr)
+            {
+                lo = _mm_add_epi64(lo, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&prevSquaredSum[cx])));
+                hi = _mm_add_epi64(hi, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&prevSquaredSum[cx + 2])));
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&outSquaredSum[cx]), lo);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&outSquaredSum[cx + 2]), hi);
+        }
+    }
+    _integralRow_scalar(outSum, outSquaredSum, prevSum, prevSquaredSum, in, endX16, width,
+                        _mm_cvtsi128_si32(carry), static_cast<std::uint32_t>(_mm_cvtsi128_si32(carrySquared)));
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+static inline uint32x4_t _prefixSum4_neon(uint32x4_t v, uint32x4_t & carry)
+{
+    const uint32x4_t zero = vdupq_n_u32(0);
+    v = vaddq_u32(v, vextq_u32(zero, v, 3));
+    v = vaddq_u32(v, vextq_u32(zero, v, 2));
+    v = vaddq_u32(v, carry);
+    carry = vdupq_n_u32(vgetq_lane_u32(v, 3));
+    return v;
+}
+
+static void _integralRow_neon(int * outSum, std::int64_t * outSquaredSum,
+                              const int * prevSum, const std::int64_t * prevSquaredSum,
+                              const uchar * in, int width)
+{
+    uint32x4_t carry = vdupq_n_u32(0), carrySquared = vdupq_n_u32(0);
+    int endX8 = width & ~7;
+    for (int x = 0; x < endX8; x += 8)
+    {
+        uint16x8_t v16 = vmovl_u8(vld1_u8(&in[x]));
+        for (int i = 0; i < 2; ++i)
+        {
+            int cx = x + i * 4;
+            uint16x4_t v = (i == 0) ? vget_low_u16(v16) : vget_high_u16(v16);
+            int32x4_t sum = vreinterpretq_s32_u32(_prefixSum4_neon(vmovl_u16(v), carry));
+            if (prevSum != nullptr)
+                sum = vaddq_s32(sum, vld1q_s32(&prevSum[cx]));
+            vst1q_s32(&outSum[cx], sum);
+            if (outSquaredSum == nullptr)
+                continue;
+            uint32x4_t squaredSum = _prefixSum4_neon(vmull_u16(v, v), carrySquared);
+            int64x2_t lo = vreinterpretq_s64_u64(vmovl_u32(vget_low_u32(squaredSum)));
+            int64x2_t hi = vreinterpretq_s64_u64(vmovl_u32(vget_high_u32(squaredSum)));
+            if (prevSquaredSum != nullptr)
+            {
+                lo = vaddq_s64(lo, vld1q_s64(reinterpret_cast<const int64_t*>(&prevSquaredSum[cx])));
+                hi = vaddq_s64(hi, vld1q_s64(reinterpret_cast<const int64_t*>(&prevSquaredSum[cx + 2])));
+            }
+            vst1q_s64(reinterpret_cast<int64_t*>(&outSquaredSum[cx]), lo);
+            vst1q_s64(reinterpret_cast<int64_t*>(&outSquaredSum[cx + 2]), hi);
+        }
+    }
+    _integralRow_scalar(outSum, outSquaredSum, prevSum, prevSquaredSum, in, endX8, width,
+                        static_cast<int>(vgetq_lane_u32(carry, 0)), vgetq_lane_u32(carrySquared, 0));
+}
+
+#endif
+
+static IntegralRowFunction _selectIntegralRow()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.sse2)
+        return _integralRow_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _integralRow_neon;
+#endif
+    (void)features;
+    return _integralRow_scalar;
+}
+
+void integralBand_u(int * outSum, int outSumWidthStep,
+                    std::int64_t * outSquaredSum, int outSquaredSumWidthStep,
+                    const uchar * in, int inWidthStep, int width, int beginRow, int endRow)
+{
+    static const KernelDispatch<IntegralRowFunction> function(_selectIntegralRow);
+    assert(width <= 66000);
+    const int * prevSum = nullptr;
+    const std::int64_t * prevSquaredSum = nullptr;
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        int * sumStr = &outSum[y * outSumWidthStep];
+        std::int64_t * squaredSumStr = (outSquaredSum != nullptr) ? &outSquaredSum[y * outSquaredSumWidthStep] : nullptr;
+        function(sumStr, squaredSumStr, prevSum, prevSquaredSum, &in[y * inWidthStep], width);
+        prevSum = sumStr;
+        prevSquaredSum = squaredSumStr;
+    }
+}
+
+void addRowToBand_i(int * outSum, int outSumWidthStep,
+                    std::int64_t * outSquaredSum, int outSquaredSumWidthStep,
+                    const int * sumRow, const std::int64_t * squaredSumRow,
+                    int width, int beginRow, int endRow)
+{
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        int * sumStr = &outSum[y * outSumWidthStep];
+        for (int x = 0; x < width; ++x)
+            sumStr[x] += sumRow[x];
+        if ((outSquaredSum == nullptr) || (squaredSumRow == nullptr))
+            continue;
+        std::int64_t * squaredSumStr = &outSquaredSum[y * outSquaredSumWidthStep];
+        for (int x = 0; x < width; ++x)
+            squaredSumStr[x] += squaredSumRow[x];
+    }
+}
+
+} // namespace simd
+
+} // namespace sonar
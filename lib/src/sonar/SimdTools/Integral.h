@@ -0,0 +1,35 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_INTEGRAL_H
+#define SONAR_SIMD_INTEGRAL_H
+
+#include <cstdint>
+
+namespace sonar {
+
+namespace simd {
+
+/// Integral image and integral image of squares of band of rows [beginRow, endRow) of 8 bits image,
+/// band is integrated as separate image: outSum(x, y) = sum of in(i, j) for i <= x and beginRow <= j <= y.
+/// outSquaredSum can be nullptr. Sums of squares of row are accumulated in 32 bits, so width must be <= 66000.
+/// Implementation (SSE2, NEON or scalar) is selected on first call by features of processor.
+void integralBand_u(int * outSum, int outSumWidthStep,
+                    std::int64_t * outSquaredSum, int outSquaredSumWidthStep,
+                    const unsigned char * in, int inWidthStep, int width, int beginRow, int endRow);
+
+/// Adds sums of rows above band to rows of band [beginRow, endRow), it joins bands computed separately.
+/// squaredSumRow and outSquaredSum can be nullptr.
+void addRowToBand_i(int * outSum, int outSumWidthStep,
+                    std::int64_t * outSquaredSum, int outSquaredSumWidthStep,
+                    const int * sumRow, const std::int64_t * squaredSumRow,
+                    int width, int beginRow, int endRow);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_INTEGRAL_H
@@ -0,0 +1,449 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "Interpolation.h"
+#include "CpuFeatures.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+// All implementations compute weights and sums with the same order of operations in floats (without fma),
+// so results are equal to results of scalar code.
+// Points are non negative, so truncation is used as floor.
+
+using PointsFunction = void (*)(float * out, const float * points, int beginIndex, int endIndex,
+                                const uchar * in, int inWidthStep, int width, int height);
+
+// Weights of patch: top left, top right, bottom left, bottom right
+using PatchRowFunction_f = void (*)(float * out, const uchar * top, const uchar * bottom,
+                                    int width, const float * weights);
+using PatchRowFunction_u = void (*)(uchar * out, const uchar * top, const uchar * bottom,
+                                    int width, const float * weights);
+
+static void _bilinearPoints_scalar(float * out, const float * points, int beginIndex, int endIndex,
+                                   const uchar * in, int inWidthStep, int, int)
+{
+    for (int i = beginIndex; i < endIndex; ++i)
+    {
+        float x = points[i * 2], y = points[i * 2 + 1];
+        int ix = static_cast<int>(x), iy = static_cast<int>(y);
+        float dx = x - static_cast<float>(ix), dy = y - static_cast<float>(iy);
+        float idx = 1.0f - dx, idy = 1.0f - dy;
+        const uchar * top = &in[iy * inWidthStep + ix];
+        const uchar * bottom = &top[inWidthStep];
+        out[i] = static_cast<float>(top[0]) * (idx * idy) + static_cast<float>(top[1]) * (dx * idy) +
+                 static_cast<float>(bottom[0]) * (idx * dy) + static_cast<float>(bottom[1]) * (dx * dy);
+    }
+}
+
+static void _bilinearPatchRow_scalar(float * out, const uchar * top, const uchar * bottom,
+                                     int beginX, int endX, const float * weights)
+{
+    for (int x = beginX; x < endX; ++x)
+        out[x] = weights[0] * top[x] + weights[1] * top[x + 1] + weights[2] * bottom[x] + weights[3] * bottom[x + 1];
+}
+
+static void _bilinearPatchRow_scalar(uchar * out, const uchar * top, const uchar * bottom,
+                                     int beginX, int endX, const float * weights)
+{
+    for (int x = beginX; x < endX; ++x)
+        out[x] = static_cast<uchar>(weights[0] * top[x] + weights[1] * top[x + 1] +
+                                    weights[2] * bottom[x] + weights[3] * bottom[x + 1]);
+}
+
+static void _bilinearPatchRow_f_scalar(float * out, const uchar * top, const uchar * bottom,
+                                       int width, const float * weights)
+{
+    _bilinearPatchRow_scalar(out, top, bottom, 0, width, weights);
+}
+
+static void _bilinearPatchRow_u_scalar(uchar * out, const uchar * top, const uchar * bottom,
+                                       int width, const float * weights)
+{
+    _bilinearPatchRow_scalar(out, top, bottom, 0, width, weights);
+}
+
+#if defined(SONAR_SIMD_X86)
+
+SONAR_TARGET_SSE2
+static inline __m128 _sum4_sse2(__m128 tl, __m128 tr, __m128 bl, __m128 br,
+                                __m128 wTL, __m128 wTR, __m128 wBL, __m128 wBR)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(tl, wTL), _mm_mul_ps(tr, wTR)),
+                                 _mm_mul_ps(bl, wBL)), _mm_mul_ps(br, wBR));
+}
+
+SONAR_TARGET_SSE2
+static void _bilinearPoints_sse2(float * out, const float * points, int beginIndex, int endIndex,
+                                 const uchar * in, int inWidthStep, int width, int height)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128i mask8 = _mm_set1_epi32(0xFF);
+    alignas(16) int ixs[4], iys[4];
+    int i = beginIndex;
+    for (; i + 4 <= endIndex; i += 4)
+    {
+        __m128 p0 = _mm_loadu_ps(&points[i * 2]);
+        __m128 p1 = _mm_loadu_ps(&points[i * 2 + 4]);
+        __m128 x = _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 y = _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128i ix = _mm_cvttps_epi32(x), iy = _mm_cvttps_epi32(y);
+        __m128 dx = _mm_sub_ps(x, _mm_cvtepi32_ps(ix)), dy = _mm_sub_ps(y, _mm_cvtepi32_ps(iy));
+        __m128 idx = _mm_sub_ps(one, dx), idy = _mm_sub_ps(one, dy);
+        _mm_store_si128(reinterpret_cast<__m128i*>(ixs), ix);
+        _mm_store_si128(reinterpret_cast<__m128i*>(iys), iy);
+        // Pairs of neighbour pixels are loaded as 16 bits values and then split
+        std::uint16_t top[4], bottom[4];
+        for (int k = 0; k < 4; ++k)
+        {
+            const uchar * str = &in[iys[k] * inWidthStep + ixs[k]];
+            std::memcpy(&top[k], str, 2);
+            std::memcpy(&bottom[k], &str[inWidthStep], 2);
+        }
+        __m128i t = _mm_set_epi32(top[3], top[2], top[1], top[0]);
+        __m128i b = _mm_set_epi32(bottom[3], bottom[2], bottom[1], bottom[0]);
+        __m128 tl = _mm_cvtepi32_ps(_mm_and_si128(t, mask8)), tr = _mm_cvtepi32_ps(_mm_srli_epi32(t, 8));
+        __m128 bl = _mm_cvtepi32_ps(_mm_and_si128(b, mask8)), br = _mm_cvtepi32_ps(_mm_srli_epi32(b, 8));
+        _mm_storeu_ps(&out[i], _sum4_sse2(tl, tr, bl, br, _mm_mul_ps(idx, idy), _mm_mul_ps(dx, idy),
+                                          _mm_mul_ps(idx, dy), _mm_mul_ps(dx, dy)));
+    }
+    _bilinearPoints_scalar(out, points, i, endIndex, in, inWidthStep, width, height);
+}
+
+/// Converts 8 pixels of 8 bits to 2 vectors of floats
+SONAR_TARGET_SSE2
+static inline void _load8_sse2(__m128 & lo, __m128 & hi, const uchar * in)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in)), zero);
+    lo = _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero));
+    hi = _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero));
+}
+
+SONAR_TARGET_SSE2
+static inline void _bilinear8_sse2(__m128 & lo, __m128 & hi, const uchar * top, const uchar * bottom,
+                                   __m128 wTL, __m128 wTR, __m128 wBL, __m128 wBR)
+{
+    __m128 tl[2], tr[2], bl[2], br[2];
+    _load8_sse2(tl[0], tl[1], top);
+    _load8_sse2(tr[0], tr[1], &top[1]);
+    _load8_sse2(bl[0], bl[1], bottom);
+    _load8_sse2(br[0], br[1], &bottom[1]);
+    lo = _sum4_sse2(tl[0], tr[0], bl[0], br[0], wTL, wTR, wBL, wBR);
+    hi = _sum4_sse2(tl[1], tr[1], bl[1], br[1], wTL, wTR, wBL, wBR);
+}
+
+SONAR_TARGET_SSE2
+static void _bilinearPatchRow_f_sse2(float * out, const uchar * top, const uchar * bottom,
+                                     int width, const float * weights)
+{
+    const __m128 wTL = _mm_set1_ps(weights[0]), wTR = _mm_set1_ps(weights[1]);
+    const __m128 wBL = _mm_set1_ps(weights[2]), wBR = _mm_set1_ps(weights[3]);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m128 lo, hi;
+        _bilinear8_sse2(lo, hi, &top[x], &bottom[x], wTL, wTR, wBL, wBR);
+        _mm_storeu_ps(&out[x], lo);
+        _mm_storeu_ps(&out[x + 4], hi);
+    }
+    _bilinearPatchRow_scalar(out, top, bottom, x, width, weights);
+}
+
+SONAR_TARGET_SSE2
+static void _bilinearPatchRow_u_sse2(uchar * out, const uchar * top, const uchar * bottom,
+                                     int width, const float * weights)
+{
+    const __m128 wTL = _mm_set1_ps(weights[0]), wTR = _mm_set1_ps(weights[1]);
+    const __m128 wBL = _mm_set1_ps(weights[2]), wBR = _mm_set1_ps(weights[3]);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m128 lo, hi;
+        _bilinear8_sse2(lo, hi, &top[x], &bottom[x], wTL, wTR, wBL, wBR);
+        __m128i v = _mm_packs_epi32(_mm_cvttps_epi32(lo), _mm_cvttps_epi32(hi));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x]), _mm_packus_epi16(v, v));
+    }
+    _bilinearPatchRow_scalar(out, top, bottom, x, width, weights);
+}
+
+SONAR_TARGET_AVX2
+static inline __m256 _sum8_avx2(__m256 tl, __m256 tr, __m256 bl, __m256 br,
+                                __m256 wTL, __m256 wTR, __m256 wBL, __m256 wBR)
+{
+    return _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(tl, wTL), _mm256_mul_ps(tr, wTR)),
+                                       _mm256_mul_ps(bl, wBL)), _mm256_mul_ps(br, wBR));
+}
+
+SONAR_TARGET_AVX2
+static void _bilinearPoints_avx2(float * out, const float * points, int beginIndex, int endIndex,
+                                 const uchar * in, int inWidthStep, int width, int height)
+{
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256i mask8 = _mm256_set1_epi32(0xFF);
+    const __m256i step = _mm256_set1_epi32(inWidthStep);
+    // Gathers read 4 bytes from every offset, so the last of them must be inside image
+    const __m256i endOffset = _mm256_set1_epi32((height - 1) * inWidthStep + width - 4);
+    int i = beginIndex;
+    for (; i + 8 <= endIndex; i += 8)
+    {
+        __m256 p0 = _mm256_loadu_ps(&points[i * 2]);
+        __m256 p1 = _mm256_loadu_ps(&points[i * 2 + 8]);
+        // shuffle works inside 128 bits lanes, so pairs of 64 bits are reordered after it
+        __m256 x = _mm256_castpd_ps(_mm256_permute4x64_pd(
+                                        _mm256_castps_pd(_mm256_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0))), 0xD8));
+        __m256 y = _mm256_castpd_ps(_mm256_permute4x64_pd(
+                                        _mm256_castps_pd(_mm256_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1))), 0xD8));
+        __m256i ix = _mm256_cvttps_epi32(x), iy = _mm256_cvttps_epi32(y);
+        __m256i topOffset = _mm256_add_epi32(_mm256_mullo_epi32(iy, step), ix);
+        __m256i bottomOffset = _mm256_add_epi32(topOffset, step);
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi32(bottomOffset, endOffset)) != 0)
+        {
+            _bilinearPoints_scalar(out, points, i, i + 8, in, inWidthStep, width, height);
+            continue;
+        }
+        __m256 dx = _mm256_sub_ps(x, _mm256_cvtepi32_ps(ix)), dy = _mm256_sub_ps(y, _mm256_cvtepi32_ps(iy));
+        __m256 idx = _mm256_sub_ps(one, dx), idy = _mm256_sub_ps(one, dy);
+        __m256i t = _mm256_i32gather_epi32(reinterpret_cast<const int*>(in), topOffset, 1);
+        __m256i b = _mm256_i32gather_epi32(reinterpret_cast<const int*>(in), bottomOffset, 1);
+        __m256 tl = _mm256_cvtepi32_ps(_mm256_and_si256(t, mask8));
+        __m256 tr = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(t, 8), mask8));
+        __m256 bl = _mm256_cvtepi32_ps(_mm256_and_si256(b, mask8));
+        __m256 br = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(b, 8), mask8));
+        _mm256_storeu_ps(&out[i], _sum8_avx2(tl, tr, bl, br, _mm256_mul_ps(idx, idy), _mm256_mul_ps(dx, idy),
+                                             _mm256_mul_ps(idx, dy), _mm256_mul_ps(dx, dy)));
+    }
+    _bilinearPoints_scalar(out, points, i, endIndex, in, inWidthStep, width, height);
+}
+
+SONAR_TARGET_AVX2
+static inline __m256 _load8_avx2(const uchar * in)
+{
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(in))));
+}
+
+SONAR_TARGET_AVX2
+static inline __m256 _bilinear8_avx2(const uchar * top, const uchar * bottom,
+                                     __m256 wTL, __m256 wTR, __m256 wBL, __m256 wBR)
+{
+    return _sum8_avx2(_load8_avx2(top), _load8_avx2(&top[1]), _load8_avx2(bottom), _load8_avx2(&bottom[1]),
+                      wTL, wTR, wBL, wBR);
+}
+
+SONAR_TARGET_AVX2
+static void _bilinearPatchRow_f_avx2(float * out, const uchar * top, const uchar * bottom,
+                                     int width, const float * weights)
+{
+    const __m256 wTL = _mm256_set1_ps(weights[0]), wTR = _mm256_set1_ps(weights[1]);
+    const __m256 wBL = _mm256_set1_ps(weights[2]), wBR = _mm256_set1_ps(weights[3]);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+        _mm256_storeu_ps(&out[x], _bilinear8_avx2(&top[x], &bottom[x], wTL, wTR, wBL, wBR));
+    _bilinearPatchRow_scalar(out, top, bottom, x, width, weights);
+}
+
+SONAR_TARGET_AVX2
+static void _bilinearPatchRow_u_avx2(uchar * out, const uchar * top, const uchar * bottom,
+                                     int width, const float * weights)
+{
+    const __m256 wTL = _mm256_set1_ps(weights[0]), wTR = _mm256_set1_ps(weights[1]);
+    const __m256 wBL = _mm256_set1_ps(weights[2]), wBR = _mm256_set1_ps(weights[3]);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m256i v = _mm256_cvttps_epi32(_bilinear8_avx2(&top[x], &bottom[x], wTL, wTR, wBL, wBR));
+        __m128i v16 = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x]), _mm_packus_epi16(v16, v16));
+    }
+    _bilinearPatchRow_scalar(out, top, bottom, x, width, weights);
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+static inline float32x4_t _sum4_neon(float32x4_t tl, float32x4_t tr, float32x4_t bl, float32x4_t br,
+                                     float32x4_t wTL, float32x4_t wTR, float32x4_t wBL, float32x4_t wBR)
+{
+    return vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(tl, wTL), vmulq_f32(tr, wTR)),
+                               vmulq_f32(bl, wBL)), vmulq_f32(br, wBR));
+}
+
+static void _bilinearPoints_neon(float * out, const float * points, int beginIndex, int endIndex,
+                                 const uchar * in, int inWidthStep, int width, int height)
+{
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    int32_t ixs[4], iys[4];
+    int i = beginIndex;
+    for (; i + 4 <= endIndex; i += 4)
+    {
+        float32x4x2_t p = vld2q_f32(&points[i * 2]);
+        int32x4_t ix = vcvtq_s32_f32(p.val[0]), iy = vcvtq_s32_f32(p.val[1]);
+        float32x4_t dx = vsubq_f32(p.val[0], vcvtq_f32_s32(ix)), dy = vsubq_f32(p.val[1], vcvtq_f32_s32(iy));
+        float32x4_t idx = vsubq_f32(one, dx), idy = vsubq_f32(one, dy);
+        vst1q_s32(ixs, ix);
+        vst1q_s32(iys, iy);
+        uint32_t tl[4], tr[4], bl[4], br[4];
+        for (int k = 0; k < 4; ++k)
+        {
+            const uchar * str = &in[iys[k] * inWidthStep + ixs[k]];
+            tl[k] = str[0];
+            tr[k] = str[1];
+            bl[k] = str[inWidthStep];
+            br[k] = str[inWidthStep + 1];
+        }
+        vst1q_f32(&out[i], _sum4_neon(vcvtq_f32_u32(vld1q_u32(tl)), vcvtq_f32_u32(vld1q_u32(tr)),
+                                      vcvtq_f32_u32(vld1q_u32(bl)), vcvtq_f32_u32(vld1q_u32(br)),
+                                      vmulq_f32(idx, idy), vmulq_f32(dx, idy),
+                                      vmulq_f32(idx, dy), vmulq_f32(dx, dy)));
+    }
+    _bilinearPoints_scalar(out, points, i, endIndex, in, inWidthStep, width, height);
+}
+
+static inline void _bilinear8_neon(float32x4_t & lo, float32x4_t & hi, const uchar * top, const uchar * bottom,
+                                   const float * weights)
+{
+    const float32x4_t wTL = vdupq_n_f32(weights[0]), wTR = vdupq_n_f32(weights[1]);
+    const float32x4_t wBL = vdupq_n_f32(weights[2]), wBR = vdupq_n_f32(weights[3]);
+    uint16x8_t tl = vmovl_u8(vld1_u8(top)), tr = vmovl_u8(vld1_u8(&top[1]));
+    uint16x8_t bl = vmovl_u8(vld1_u8(bottom)), br = vmovl_u8(vld1_u8(&bottom[1]));
+    lo = _sum4_neon(vcvtq_f32_u32(vmovl_u16(vget_low_u16(tl))), vcvtq_f32_u32(vmovl_u16(vget_low_u16(tr))),
+                    vcvtq_f32_u32(vmovl_u16(vget_low_u16(bl))), vcvtq_f32_u32(vmovl_u16(vget_low_u16(br))),
+                    wTL, wTR, wBL, wBR);
+    hi = _sum4_neon(vcvtq_f32_u32(vmovl_u16(vget_high_u16(tl))), vcvtq_f32_u32(vmovl_u16(vget_high_u16(tr))),
+                    vcvtq_f32_u32(vmovl_u16(vget_high_u16(bl))), vcvtq_f32_u32(vmovl_u16(vget_high_u16(br))),
+                    wTL, wTR, wBL, wBR);
+}
+
+static void _bilinearPatchRow_f_neon(float * out, const uchar * top, const uchar * bottom,
+                                     int width, const float * weights)
+{
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        float32x4_t lo, hi;
+        _bilinear8_neon(lo, hi, &top[x], &bottom[x], weights);
+        vst1q_f32(&out[x], lo);
+        vst1q_f32(&out[x + 4], hi);
+    }
+    _bilinearPatchRow_scalar(out, top, bottom, x, width, weights);
+}
+
+static void _bilinearPatchRow_u_neon(uchar * out, const uchar * top, const uchar * bottom,
+                                     int width, const float * weights)
+{
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        float32x4_t lo, hi;
+        _bilinear8_neon(lo, hi, &top[x], &bottom[x], weights);
+        uint16x8_t v = vcombine_u16(vmovn_u32(vcvtq_u32_f32(lo)), vmovn_u32(vcvtq_u32_f32(hi)));
+        vst1_u8(&out[x], vqmovn_u16(v));
+    }
+    _bilinearPatchRow_scalar(out, top, bottom, x, width, weights);
+}
+
+#endif
+
+static PointsFunction _selectBilinearPoints()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _bilinearPoints_avx2;
+    if (features.sse2)
+        return _bilinearPoints_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _bilinearPoints_neon;
+#endif
+    (void)features;
+    return _bilinearPoints_scalar;
+}
+
+static PatchRowFunction_f _selectBilinearPatchRow_f()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _bilinearPatchRow_f_avx2;
+    if (features.sse2)
+        return _bilinearPatchRow_f_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _bilinearPatchRow_f_neon;
+#endif
+    (void)features;
+    return _bilinearPatchRow_f_scalar;
+}
+
+static PatchRowFunction_u _selectBilinearPatchRow_u()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _bilinearPatchRow_u_avx2;
+    if (features.sse2)
+        return _bilinearPatchRow_u_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _bilinearPatchRow_u_neon;
+#endif
+    (void)features;
+    return _bilinearPatchRow_u_scalar;
+}
+
+static void _patchWeights(float * weights, float subPixelX, float subPixelY)
+{
+    assert((subPixelX >= 0.0f) && (subPixelX < 1.0f) && (subPixelY >= 0.0f) && (subPixelY < 1.0f));
+    weights[0] = (1.0f - subPixelX) * (1.0f - subPixelY);
+    weights[1] = subPixelX * (1.0f - subPixelY);
+    weights[2] = (1.0f - subPixelX) * subPixelY;
+    weights[3] = subPixelX * subPixelY;
+}
+
+void bilinearPoints_f(float * out, const float * points, int numberPoints,
+                      const uchar * in, int inWidthStep, int width, int height)
+{
+    static const KernelDispatch<PointsFunction> function(_selectBilinearPoints);
+    function(out, points, 0, numberPoints, in, inWidthStep, width, height);
+}
+
+void bilinearPatch_f(float * out, int outWidthStep, int width, int height,
+                     const uchar * in, int inWidthStep, float subPixelX, float subPixelY)
+{
+    static const KernelDispatch<PatchRowFunction_f> function(_selectBilinearPatchRow_f);
+    float weights[4];
+    _patchWeights(weights, subPixelX, subPixelY);
+    for (int y = 0; y < height; ++y)
+        function(&out[y * outWidthStep], &in[y * inWidthStep], &in[(y + 1) * inWidthStep], width, weights);
+}
+
+void bilinearPatch_u(uchar * out, int outWidthStep, int width, int height,
+                     const uchar * in, int inWidthStep, float subPixelX, float subPixelY)
+{
+    static const KernelDispatch<PatchRowFunction_u> function(_selectBilinearPatchRow_u);
+    float weights[4];
+    _patchWeights(weights, subPixelX, subPixelY);
+    for (int y = 0; y < height; ++y)
+        function(&out[y * outWidthStep], &in[y * inWidthStep], &in[(y + 1) * inWidthStep], width, weights);
+}
+
+} // namespace simd
+
+} // namespace sonar
@@ -0,0 +1,35 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_INTERPOLATION_H
+#define SONAR_SIMD_INTERPOLATION_H
+
+namespace sonar {
+
+namespace simd {
+
+/// Bilinear sampling of many points of 8 bits image, points are interleaved: points[i * 2] = x, points[i * 2 + 1] = y.
+/// Every point must be in [0, width - 1) x [0, height - 1).
+/// Results are the same as of scalar formula I00 * (1 - dx) * (1 - dy) + I10 * dx * (1 - dy) +
+/// I01 * (1 - dx) * dy + I11 * dx * dy in floats.
+/// Implementation (SSE2, AVX2 with gathers, NEON or scalar) is selected on first call by features of processor.
+void bilinearPoints_f(float * out, const float * points, int numberPoints,
+                      const unsigned char * in, int inWidthStep, int width, int height);
+
+/// Bilinear sampling of patch with shift (subPixelX, subPixelY) in [0, 1) from point in:
+/// out(x, y) is image at (x + subPixelX, y + subPixelY), input must have width + 1 columns and height + 1 rows.
+void bilinearPatch_f(float * out, int outWidthStep, int width, int height,
+                     const unsigned char * in, int inWidthStep, float subPixelX, float subPixelY);
+
+/// The same as bilinearPatch_f, values are truncated to 8 bits.
+void bilinearPatch_u(unsigned char * out, int outWidthStep, int width, int height,
+                     const unsigned char * in, int inWidthStep, float subPixelX, float subPixelY);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_INTERPOLATION_H
@@ -0,0 +1,318 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "Planar.h"
+#include "CpuFeatures.h"
+
+#include <cassert>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+// Kernels process 16 pixels per iteration and leave the tail of row to scalar code.
+
+using DeinterleaveFunction = void (*)(uchar * const * outPlanes, const uchar * in, int width);
+using InterleaveFunction = void (*)(uchar * out, const uchar * const * inPlanes, int width);
+
+static void _deinterleave_scalar(uchar * const * outPlanes, const uchar * in, int beginX, int endX,
+                                 int numberChannels)
+{
+    for (int c = 0; c < numberChannels; ++c)
+    {
+        uchar * plane = outPlanes[c];
+        for (int x = beginX; x < endX; ++x)
+            plane[x] = in[x * numberChannels + c];
+    }
+}
+
+static void _interleave_scalar(uchar * out, const uchar * const * inPlanes, int beginX, int endX,
+                               int numberChannels)
+{
+    for (int c = 0; c < numberChannels; ++c)
+    {
+        const uchar * plane = inPlanes[c];
+        for (int x = beginX; x < endX; ++x)
+            out[x * numberChannels + c] = plane[x];
+    }
+}
+
+template <int NumberChannels>
+static void _deinterleave_scalar(uchar * const * outPlanes, const uchar * in, int width)
+{
+    _deinterleave_scalar(outPlanes, in, 0, width, NumberChannels);
+}
+
+template <int NumberChannels>
+static void _interleave_scalar(uchar * out, const uchar * const * inPlanes, int width)
+{
+    _interleave_scalar(out, inPlanes, 0, width, NumberChannels);
+}
+
+#if defined(SONAR_SIMD_X86)
+
+SONAR_TARGET_SSE2
+static void _deinterleave4_sse2(uchar * const * outPlanes, const uchar * in, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m128i * p = reinterpret_cast<const __m128i*>(&in[x * 4]);
+        __m128i a = _mm_loadu_si128(&p[0]), b = _mm_loadu_si128(&p[1]);
+        __m128i c = _mm_loadu_si128(&p[2]), d = _mm_loadu_si128(&p[3]);
+        // Every unpack halves distance between values of the same channel
+        __m128i u0 = _mm_unpacklo_epi8(a, b), u1 = _mm_unpackhi_epi8(a, b);
+        __m128i u2 = _mm_unpacklo_epi8(c, d), u3 = _mm_unpackhi_epi8(c, d);
+        __m128i v0 = _mm_unpacklo_epi8(u0, u1), v1 = _mm_unpackhi_epi8(u0, u1);
+        __m128i v2 = _mm_unpacklo_epi8(u2, u3), v3 = _mm_unpackhi_epi8(u2, u3);
+        // w0 = r0..r7 g0..g7, w1 = b0..b7 a0..a7, w2 and w3 are the same for pixels 8..15
+        __m128i w0 = _mm_unpacklo_epi8(v0, v1), w1 = _mm_unpackhi_epi8(v0, v1);
+        __m128i w2 = _mm_unpacklo_epi8(v2, v3), w3 = _mm_unpackhi_epi8(v2, v3);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&outPlanes[0][x]), _mm_unpacklo_epi64(w0, w2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&outPlanes[1][x]), _mm_unpackhi_epi64(w0, w2));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&outPlanes[2][x]), _mm_unpacklo_epi64(w1, w3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&outPlanes[3][x]), _mm_unpackhi_epi64(w1, w3));
+    }
+    _deinterleave_scalar(outPlanes, in, x, width, 4);
+}
+
+SONAR_TARGET_SSE2
+static void _interleave4_sse2(uchar * out, const uchar * const * inPlanes, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inPlanes[0][x]));
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inPlanes[1][x]));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inPlanes[2][x]));
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inPlanes[3][x]));
+        __m128i rgLow = _mm_unpacklo_epi8(r, g), rgHigh = _mm_unpackhi_epi8(r, g);
+        __m128i baLow = _mm_unpacklo_epi8(b, a), baHigh = _mm_unpackhi_epi8(b, a);
+        __m128i * p = reinterpret_cast<__m128i*>(&out[x * 4]);
+        _mm_storeu_si128(&p[0], _mm_unpacklo_epi16(rgLow, baLow));
+        _mm_storeu_si128(&p[1], _mm_unpackhi_epi16(rgLow, baLow));
+        _mm_storeu_si128(&p[2], _mm_unpacklo_epi16(rgHigh, baHigh));
+        _mm_storeu_si128(&p[3], _mm_unpackhi_epi16(rgHigh, baHigh));
+    }
+    _interleave_scalar(out, inPlanes, x, width, 4);
+}
+
+// Masks of byte shuffles for 16 pixels with 3 channels (48 bytes in 3 registers), -1 gives zero byte.
+// deinterleaveMasks[channel][register], interleaveMasks[register][channel]
+alignas(16) static const signed char deinterleaveMasks[3][3][16] = {
+    { { 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13 } },
+    { { 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14 } },
+    { { 2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1 },
+      { -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15 } } };
+
+alignas(16) static const signed char interleaveMasks[3][3][16] = {
+    { { 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5 },
+      { -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1 },
+      { -1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1 } },
+    { { -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1 },
+      { 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10 },
+      { -1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1 } },
+    { { -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1 },
+      { -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1 },
+      { 10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15 } } };
+
+SONAR_TARGET_AVX2
+static inline __m128i _shuffle3_avx2(__m128i a, __m128i b, __m128i c, const signed char (&masks)[3][16])
+{
+    __m128i r = _mm_shuffle_epi8(a, _mm_load_si128(reinterpret_cast<const __m128i*>(masks[0])));
+    r = _mm_or_si128(r, _mm_shuffle_epi8(b, _mm_load_si128(reinterpret_cast<const __m128i*>(masks[1]))));
+    return _mm_or_si128(r, _mm_shuffle_epi8(c, _mm_load_si128(reinterpret_cast<const __m128i*>(masks[2]))));
+}
+
+SONAR_TARGET_AVX2
+static void _deinterleave3_avx2(uchar * const * outPlanes, const uchar * in, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        const __m128i * p = reinterpret_cast<const __m128i*>(&in[x * 3]);
+        __m128i a = _mm_loadu_si128(&p[0]), b = _mm_loadu_si128(&p[1]), c = _mm_loadu_si128(&p[2]);
+        for (int k = 0; k < 3; ++k)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&outPlanes[k][x]), _shuffle3_avx2(a, b, c, deinterleaveMasks[k]));
+    }
+    _deinterleave_scalar(outPlanes, in, x, width, 3);
+}
+
+SONAR_TARGET_AVX2
+static void _interleave3_avx2(uchar * out, const uchar * const * inPlanes, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inPlanes[0][x]));
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inPlanes[1][x]));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&inPlanes[2][x]));
+        __m128i * p = reinterpret_cast<__m128i*>(&out[x * 3]);
+        for (int k = 0; k < 3; ++k)
+            _mm_storeu_si128(&p[k], _shuffle3_avx2(r, g, b, interleaveMasks[k]));
+    }
+    _interleave_scalar(out, inPlanes, x, width, 3);
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+static void _deinterleave3_neon(uchar * const * outPlanes, const uchar * in, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x3_t v = vld3q_u8(&in[x * 3]);
+        vst1q_u8(&outPlanes[0][x], v.val[0]);
+        vst1q_u8(&outPlanes[1][x], v.val[1]);
+        vst1q_u8(&outPlanes[2][x], v.val[2]);
+    }
+    _deinterleave_scalar(outPlanes, in, x, width, 3);
+}
+
+static void _deinterleave4_neon(uchar * const * outPlanes, const uchar * in, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x4_t v = vld4q_u8(&in[x * 4]);
+        vst1q_u8(&outPlanes[0][x], v.val[0]);
+        vst1q_u8(&outPlanes[1][x], v.val[1]);
+        vst1q_u8(&outPlanes[2][x], v.val[2]);
+        vst1q_u8(&outPlanes[3][x], v.val[3]);
+    }
+    _deinterleave_scalar(outPlanes, in, x, width, 4);
+}
+
+static void _interleave3_neon(uchar * out, const uchar * const * inPlanes, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x3_t v;
+        v.val[0] = vld1q_u8(&inPlanes[0][x]);
+        v.val[1] = vld1q_u8(&inPlanes[1][x]);
+        v.val[2] = vld1q_u8(&inPlanes[2][x]);
+        vst3q_u8(&out[x * 3], v);
+    }
+    _interleave_scalar(out, inPlanes, x, width, 3);
+}
+
+static void _interleave4_neon(uchar * out, const uchar * const * inPlanes, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16x4_t v;
+        v.val[0] = vld1q_u8(&inPlanes[0][x]);
+        v.val[1] = vld1q_u8(&inPlanes[1][x]);
+        v.val[2] = vld1q_u8(&inPlanes[2][x]);
+        v.val[3] = vld1q_u8(&inPlanes[3][x]);
+        vst4q_u8(&out[x * 4], v);
+    }
+    _interleave_scalar(out, inPlanes, x, width, 4);
+}
+
+#endif
+
+static DeinterleaveFunction _selectDeinterleave3()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _deinterleave3_avx2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _deinterleave3_neon;
+#endif
+    (void)features;
+    return _deinterleave_scalar<3>;
+}
+
+static DeinterleaveFunction _selectDeinterleave4()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.sse2)
+        return _deinterleave4_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _deinterleave4_neon;
+#endif
+    (void)features;
+    return _deinterleave_scalar<4>;
+}
+
+static InterleaveFunction _selectInterleave3()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _interleave3_avx2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _interleave3_neon;
+#endif
+    (void)features;
+    return _interleave_scalar<3>;
+}
+
+static InterleaveFunction _selectInterleave4()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.sse2)
+        return _interleave4_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _interleave4_neon;
+#endif
+    (void)features;
+    return _interleave_scalar<4>;
+}
+
+void deinterleave_u(uchar * const * outPlanes, const uchar * in, int width, int numberChannels)
+{
+    static const KernelDispatch<DeinterleaveFunction> function3(_selectDeinterleave3);
+    static const KernelDispatch<DeinterleaveFunction> function4(_selectDeinterleave4);
+    assert(numberChannels > 0);
+    if (numberChannels == 3)
+        function3(outPlanes, in, width);
+    else if (numberChannels == 4)
+        function4(outPlanes, in, width);
+    else
+        _deinterleave_scalar(outPlanes, in, 0, width, numberChannels);
+}
+
+void interleave_u(uchar * out, const uchar * const * inPlanes, int width, int numberChannels)
+{
+    static const KernelDispatch<InterleaveFunction> function3(_selectInterleave3);
+    static const KernelDispatch<InterleaveFunction> function4(_selectInterleave4);
+    assert(numberChannels > 0);
+    if (numberChannels == 3)
+        function3(out, inPlanes, width);
+    else if (numberChannels == 4)
+        function4(out, inPlanes, width);
+    else
+        _interleave_scalar(out, inPlanes, 0, width, numberChannels);
+}
+
+} // namespace simd
+
+} // namespace sonar
@@ -0,0 +1,26 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_PLANAR_H
+#define SONAR_SIMD_PLANAR_H
+
+namespace sonar {
+
+namespace simd {
+
+/// Splitting of row of interleaved 8 bits pixels with numberChannels channels into planes (one row per plane).
+/// Kernels are vectorized for 3 and 4 channels: 4 channels by SSE2 unpacks, 3 channels by byte shuffles
+/// (selected with AVX2), NEON by vld3/vld4. Other numbers of channels are processed by scalar code.
+void deinterleave_u(unsigned char * const * outPlanes, const unsigned char * in, int width, int numberChannels);
+
+/// Joining of rows of planes into row of interleaved pixels
+void interleave_u(unsigned char * out, const unsigned char * const * inPlanes, int width, int numberChannels);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_PLANAR_H
@@ -0,0 +1,273 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "Resize.h"
+#include "CpuFeatures.h"
+
+#include <cassert>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+/// Weights of input indices for one output index
+using Taps = std::vector<std::pair<int, double>>;
+
+static Taps _areaTaps(int inSize, int outSize, int index)
+{
+    double scale = inSize / static_cast<double>(outSize);
+    double begin = index * scale, end = (index + 1) * scale;
+    Taps taps;
+    for (int i = static_cast<int>(std::floor(begin)); i < std::min(static_cast<int>(std::ceil(end)), inSize); ++i)
+    {
+        double coverage = std::min(i + 1.0, end) - std::max(static_cast<double>(i), begin);
+        if (coverage > 1e-9)
+            taps.emplace_back(i, coverage / scale);
+    }
+    return taps;
+}
+
+static Taps _bilinearTaps(int inSize, int outSize, int index)
+{
+    double x = (index + 0.5) * inSize / static_cast<double>(outSize) - 0.5;
+    x = std::max(0.0, std::min(x, static_cast<double>(inSize - 1)));
+    int ix = static_cast<int>(std::floor(x));
+    double dx = x - ix;
+    Taps taps;
+    taps.emplace_back(ix, 1.0 - dx);
+    if ((ix + 1) < inSize)
+        taps.emplace_back(ix + 1, dx);
+    return taps;
+}
+
+std::shared_ptr<const ResizeCoefficients> resizeCoefficients(int inSize, int outSize)
+{
+    assert((inSize > 0) && (outSize > 0));
+
+    static std::mutex mutex;
+    static std::map<std::pair<int, int>, std::shared_ptr<const ResizeCoefficients>> cache;
+
+    std::lock_guard<std::mutex> locker(mutex); (void)locker;
+    auto it = cache.find(std::make_pair(inSize, outSize));
+    if (it != cache.end())
+        return it->second;
+
+    std::vector<Taps> taps(static_cast<std::size_t>(outSize));
+    int numberTaps = 1;
+    for (int i = 0; i < outSize; ++i)
+    {
+        taps[i] = (outSize < inSize) ? _areaTaps(inSize, outSize, i) : _bilinearTaps(inSize, outSize, i);
+        numberTaps = std::max(numberTaps, static_cast<int>(taps[i].size()));
+    }
+    std::shared_ptr<ResizeCoefficients> coefficients = std::make_shared<ResizeCoefficients>();
+    coefficients->inSize = inSize;
+    coefficients->outSize = outSize;
+    coefficients->numberTaps = numberTaps;
+    coefficients->offsets.resize(static_cast<std::size_t>(outSize));
+    coefficients->weights.assign(static_cast<std::size_t>(outSize * numberTaps), 0);
+    for (int i = 0; i < outSize; ++i)
+    {
+        // Window is shifted back near the end, so all taps are inside, extra taps have zero weights
+        int offset = std::min(taps[i].front().first, inSize - numberTaps);
+        coefficients->offsets[i] = offset;
+        std::uint16_t * weights = &coefficients->weights[i * numberTaps];
+        // Cumulative sums of weights are rounded instead of weights themselves, so errors of rounding
+        // don't accumulate on big ratios of downscale: weights sum to 256 and each is in [0, 256]
+        double cumulative = 0.0;
+        int prevRounded = 0;
+        for (std::size_t j = 0; j < taps[i].size(); ++j)
+        {
+            cumulative += taps[i][j].second;
+            int rounded = ((j + 1) == taps[i].size()) ? 256 :
+                                                         std::min(static_cast<int>(std::lround(cumulative * 256.0)), 256);
+            int k = taps[i][j].first - offset;
+            assert((rounded >= prevRounded) && ((rounded - prevRounded) <= 256));
+            weights[k] = static_cast<std::uint16_t>(rounded - prevRounded);
+            prevRounded = rounded;
+        }
+    }
+    if (cache.size() >= 64)
+        cache.clear();
+    cache[std::make_pair(inSize, outSize)] = coefficients;
+    return coefficients;
+}
+
+// Filtered by X rows have values sum(w * in) <= 255 * 256 in 16 bits,
+// out[x] = (sum(w[k] * rows[k][x]) + 2^15) >> 16 is computed in 32 bits.
+
+using VerticalFunction = void (*)(uchar * out, const std::uint16_t * const * rows, const std::uint16_t * weights,
+                                  int numberTaps, int width);
+
+static void _resizeRowX(std::uint16_t * out, const uchar * in, const ResizeCoefficients & coefficients)
+{
+    const int numberTaps = coefficients.numberTaps;
+    const std::uint16_t * weights = coefficients.weights.data();
+    for (int x = 0; x < coefficients.outSize; ++x, weights += numberTaps)
+    {
+        const uchar * str = &in[coefficients.offsets[x]];
+        std::uint32_t sum = 0;
+        for (int k = 0; k < numberTaps; ++k)
+            sum += static_cast<std::uint32_t>(str[k]) * weights[k];
+        out[x] = static_cast<std::uint16_t>(sum);
+    }
+}
+
+static void _resizeRowY_scalar(uchar * out, const std::uint16_t * const * rows, const std::uint16_t * weights,
+                               int numberTaps, int beginX, int endX)
+{
+    for (int x = beginX; x < endX; ++x)
+    {
+        std::uint32_t sum = 1u << 15;
+        for (int k = 0; k < numberTaps; ++k)
+            sum += static_cast<std::uint32_t>(rows[k][x]) * weights[k];
+        out[x] = static_cast<uchar>(sum >> 16);
+    }
+}
+
+static void _resizeRowY_scalar(uchar * out, const std::uint16_t * const * rows, const std::uint16_t * weights,
+                               int numberTaps, int width)
+{
+    _resizeRowY_scalar(out, rows, weights, numberTaps, 0, width);
+}
+
+#if defined(SONAR_SIMD_X86)
+
+SONAR_TARGET_SSE2
+static void _resizeRowY_sse2(uchar * out, const std::uint16_t * const * rows, const std::uint16_t * weights,
+                             int numberTaps, int width)
+{
+    const __m128i rounding = _mm_set1_epi32(1 << 15);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m128i sumLo = rounding, sumHi = rounding;
+        for (int k = 0; k < numberTaps; ++k)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&rows[k][x]));
+            __m128i w = _mm_set1_epi16(static_cast<short>(weights[k]));
+            // Unsigned products of 16 bits are assembled from low and high halves
+            __m128i lo = _mm_mullo_epi16(v, w), hi = _mm_mulhi_epu16(v, w);
+            sumLo = _mm_add_epi32(sumLo, _mm_unpacklo_epi16(lo, hi));
+            sumHi = _mm_add_epi32(sumHi, _mm_unpackhi_epi16(lo, hi));
+        }
+        __m128i v = _mm_packs_epi32(_mm_srli_epi32(sumLo, 16), _mm_srli_epi32(sumHi, 16));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x]), _mm_packus_epi16(v, v));
+    }
+    _resizeRowY_scalar(out, rows, weights, numberTaps, x, width);
+}
+
+SONAR_TARGET_AVX2
+static void _resizeRowY_avx2(uchar * out, const std::uint16_t * const * rows, const std::uint16_t * weights,
+                             int numberTaps, int width)
+{
+    const __m256i rounding = _mm256_set1_epi32(1 << 15);
+    int x = 0;
+    for (; x + 16 <= width; x += 16)
+    {
+        __m256i sumLo = rounding, sumHi = rounding;
+        for (int k = 0; k < numberTaps; ++k)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&rows[k][x]));
+            __m256i w = _mm256_set1_epi16(static_cast<short>(weights[k]));
+            __m256i lo = _mm256_mullo_epi16(v, w), hi = _mm256_mulhi_epu16(v, w);
+            sumLo = _mm256_add_epi32(sumLo, _mm256_unpacklo_epi16(lo, hi));
+            sumHi = _mm256_add_epi32(sumHi, _mm256_unpackhi_epi16(lo, hi));
+        }
+        // unpack and pack work inside 128 bits lanes, so the order of values is restored by them
+        __m256i v = _mm256_packs_epi32(_mm256_srli_epi32(sumLo, 16), _mm256_srli_epi32(sumHi, 16));
+        v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v, v), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(&out[x]), _mm256_castsi256_si128(v));
+    }
+    _resizeRowY_scalar(out, rows, weights, numberTaps, x, width);
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+static void _resizeRowY_neon(uchar * out, const std::uint16_t * const * rows, const std::uint16_t * weights,
+                             int numberTaps, int width)
+{
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        uint32x4_t sumLo = vdupq_n_u32(0), sumHi = vdupq_n_u32(0);
+        for (int k = 0; k < numberTaps; ++k)
+        {
+            uint16x8_t v = vld1q_u16(&rows[k][x]);
+            sumLo = vmlal_n_u16(sumLo, vget_low_u16(v), weights[k]);
+            sumHi = vmlal_n_u16(sumHi, vget_high_u16(v), weights[k]);
+        }
+        vst1_u8(&out[x], vmovn_u16(vcombine_u16(vrshrn_n_u32(sumLo, 16), vrshrn_n_u32(sumHi, 16))));
+    }
+    _resizeRowY_scalar(out, rows, weights, numberTaps, x, width);
+}
+
+#endif
+
+static VerticalFunction _selectResizeRowY()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _resizeRowY_avx2;
+    if (features.sse2)
+        return _resizeRowY_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _resizeRowY_neon;
+#endif
+    (void)features;
+    return _resizeRowY_scalar;
+}
+
+void resize_u(uchar * out, int outWidthStep, const uchar * in, int inWidthStep,
+              const ResizeCoefficients & xCoefficients, const ResizeCoefficients & yCoefficients,
+              int beginRow, int endRow)
+{
+    static const KernelDispatch<VerticalFunction> function(_selectResizeRowY);
+    assert((beginRow >= 0) && (endRow <= yCoefficients.outSize));
+
+    const int width = xCoefficients.outSize;
+    const int numberTaps = yCoefficients.numberTaps;
+    // Window of input rows moves only down, so ring buffer of numberTaps rows holds all rows of window
+    std::vector<std::uint16_t> buffer(static_cast<std::size_t>(numberTaps * width));
+    std::vector<int> bufferRows(static_cast<std::size_t>(numberTaps), -1);
+    std::vector<const std::uint16_t*> rows(static_cast<std::size_t>(numberTaps));
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        int offset = yCoefficients.offsets[y];
+        for (int k = 0; k < numberTaps; ++k)
+        {
+            int inRow = offset + k;
+            int slot = inRow % numberTaps;
+            std::uint16_t * row = &buffer[slot * width];
+            if (bufferRows[slot] != inRow)
+            {
+                _resizeRowX(row, &in[inRow * inWidthStep], xCoefficients);
+                bufferRows[slot] = inRow;
+            }
+            rows[k] = row;
+        }
+        function(&out[y * outWidthStep], rows.data(), &yCoefficients.weights[y * numberTaps], numberTaps, width);
+    }
+}
+
+} // namespace simd
+
+} // namespace sonar
@@ -0,0 +1,47 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_RESIZE_H
+#define SONAR_SIMD_RESIZE_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace sonar {
+
+namespace simd {
+
+/// Coefficients of resize by one dimension in fixed point with 8 bits of fraction.
+/// Output index i is sum of numberTaps input values from offsets[i] with weights[i * numberTaps + k],
+/// sum of weights of every output index is exactly 256.
+/// If size decreases, weights are areas of overlapping (area averaging),
+/// otherwise they are weights of bilinear interpolation between centers of pixels.
+struct ResizeCoefficients
+{
+    int inSize;
+    int outSize;
+    int numberTaps;
+    std::vector<int> offsets;
+    std::vector<std::uint16_t> weights;
+};
+
+/// Coefficients are computed once for every pair of sizes, next calls return the cached coefficients,
+/// so frames of stream with the same size reuse them.
+std::shared_ptr<const ResizeCoefficients> resizeCoefficients(int inSize, int outSize);
+
+/// Resize of 8 bits image: rows are filtered by X with table of coefficients, filtered rows are kept
+/// in small ring buffer and are combined by Y with SIMD (SSE2, AVX2 or NEON). Results are rounded to nearest.
+/// Only rows of out image from beginRow to endRow are computed, so image can be split between threads.
+void resize_u(unsigned char * out, int outWidthStep, const unsigned char * in, int inWidthStep,
+              const ResizeCoefficients & xCoefficients, const ResizeCoefficients & yCoefficients,
+              int beginRow, int endRow);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_RESIZE_H
@@ -0,0 +1,35 @@
+add_definitions(-DMODULE_SIMD_TOOLS)
+
+set(SONAR_SOURCES_FILES
+    ${SONAR_SOURCES_FILES}
+    ${CMAKE_CURRENT_LIST_DIR}/BitOperations.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/CpuFeatures.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/FastSegment.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/GaussianBlur.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/Gradients.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/Grayscale.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/HalfConversion.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/HalfSample.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/Integral.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/Interpolation.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/Planar.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/Resize.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/Threshold.cpp
+    ${CMAKE_CURRENT_LIST_DIR}/Warp.cpp)
+
+set(SONAR_HEADER_FILES
+    ${SONAR_HEADER_FILES}
+    ${CMAKE_CURRENT_LIST_DIR}/BitOperations.h
+    ${CMAKE_CURRENT_LIST_DIR}/CpuFeatures.h
+    ${CMAKE_CURRENT_LIST_DIR}/FastSegment.h
+    ${CMAKE_CURRENT_LIST_DIR}/GaussianBlur.h
+    ${CMAKE_CURRENT_LIST_DIR}/Gradients.h
+    ${CMAKE_CURRENT_LIST_DIR}/Grayscale.h
+    ${CMAKE_CURRENT_LIST_DIR}/HalfConversion.h
+    ${CMAKE_CURRENT_LIST_DIR}/HalfSample.h
+    ${CMAKE_CURRENT_LIST_DIR}/Integral.h
+    ${CMAKE_CURRENT_LIST_DIR}/Interpolation.h
+    ${CMAKE_CURRENT_LIST_DIR}/Planar.h
+    ${CMAKE_CURRENT_LIST_DIR}/Resize.h
+    ${CMAKE_CURRENT_LIST_DIR}/Threshold.h
+    ${CMAKE_CURRENT_LIST_DIR}/Warp.h)
@@ -0,0 +1,33 @@
+HEADERS += \
+    $$PWD/BitOperations.h \
+    $$PWD/CpuFeatures.h \
+    $$PWD/FastSegment.h \
+    $$PWD/GaussianBlur.h \
+    $$PWD/Gradients.h \
+    $$PWD/Grayscale.h \
+    $$PWD/HalfConversion.h \
+    $$PWD/HalfSample.h \
+    $$PWD/Integral.h \
+    $$PWD/Interpolation.h \
+    $$PWD/Planar.h \
+    $$PWD/Resize.h \
+    $$PWD/Threshold.h \
+    $$PWD/Warp.h
+
+SOURCES += \
+    $$PWD/BitOperations.cpp \
+    $$PWD/CpuFeatures.cpp \
+    $$PWD/FastSegment.cpp \
+    $$PWD/GaussianBlur.cpp \
+    $$PWD/Gradients.cpp \
+    $$PWD/Grayscale.cpp \
+    $$PWD/HalfConversion.cpp \
+    $$PWD/HalfSample.cpp \
+    $$PWD/Integral.cpp \
+    $$PWD/Interpolation.cpp \
+    $$PWD/Planar.cpp \
+    $$PWD/Resize.cpp \
+    $$PWD/Threshold.cpp \
+    $$PWD/Warp.cpp
+
+DEFINES += MODULE_SIMD_TOOLS
@@ -0,0 +1,494 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "Threshold.h"
+#include "CpuFeatures.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+// Sum of window [x - halfSize, x + halfSize] of row is (b[x1] - b[x0]) - (a[x1] - a[x0]), where a is row
+// of integral image above window (row of zeros for the top of image), b is the last row of window,
+// x0 = x - halfSize - 1 and x1 = x + halfSize. Kernels get only the inner range of x, where x0 >= 0 and
+// x1 < width, so the area of window is the same for the whole range. Other pixels are computed by scalar
+// code with clamped window. SIMD versions repeat operations of scalar code, results are the same.
+
+struct ThresholdRow
+{
+    uchar * out;
+    const uchar * in;
+    const int * a;
+    const int * b;
+    const std::int64_t * squaredA;
+    const std::int64_t * squaredB;
+    int width;
+    int halfSize;
+    int numberRows;
+    uchar mask;
+};
+
+struct SauvolaParameters
+{
+    double k;
+    double invR;
+};
+
+using ThresholdMeanRowFunction = void (*)(const ThresholdRow & row, float delta, int beginX, int endX);
+using ThresholdSauvolaRowFunction = void (*)(const ThresholdRow & row, const SauvolaParameters & parameters,
+                                             int beginX, int endX);
+
+/// Sum and area of window which is clamped by borders of row
+static inline int _windowSum(const ThresholdRow & row, int x, int & area)
+{
+    int x0 = x - row.halfSize - 1;
+    int x1 = std::min(x + row.halfSize, row.width - 1);
+    if (x0 < 0)
+    {
+        area = (x1 + 1) * row.numberRows;
+        return row.b[x1] - row.a[x1];
+    }
+    area = (x1 - x0) * row.numberRows;
+    return (row.b[x1] - row.b[x0]) - (row.a[x1] - row.a[x0]);
+}
+
+static inline std::int64_t _windowSquaredSum(const ThresholdRow & row, int x)
+{
+    int x0 = x - row.halfSize - 1;
+    int x1 = std::min(x + row.halfSize, row.width - 1);
+    if (x0 < 0)
+        return row.squaredB[x1] - row.squaredA[x1];
+    return (row.squaredB[x1] - row.squaredB[x0]) - (row.squaredA[x1] - row.squaredA[x0]);
+}
+
+static void _thresholdMeanRow_scalar(const ThresholdRow & row, float delta, int beginX, int endX)
+{
+    for (int x = beginX; x < endX; ++x)
+    {
+        int area;
+        int sum = _windowSum(row, x, area);
+        float invArea = 1.0f / static_cast<float>(area);
+        float threshold = static_cast<float>(sum) * invArea - delta;
+        row.out[x] = static_cast<uchar>(((static_cast<float>(row.in[x]) > threshold) ? 255 : 0) ^ row.mask);
+    }
+}
+
+static inline uchar _sauvola(uchar value, int sum, std::int64_t squaredSum, double invArea,
+                             const SauvolaParameters & parameters, uchar mask)
+{
+    double mean = static_cast<double>(sum) * invArea;
+    double variance = static_cast<double>(squaredSum) * invArea - mean * mean;
+    double deviation = std::sqrt(std::max(variance, 0.0));
+    double threshold = mean * (1.0 + parameters.k * (deviation * parameters.invR - 1.0));
+    return static_cast<uchar>(((static_cast<double>(value) > threshold) ? 255 : 0) ^ mask);
+}
+
+static void _thresholdSauvolaRow_scalar(const ThresholdRow & row, const SauvolaParameters & parameters,
+                                        int beginX, int endX)
+{
+    for (int x = beginX; x < endX; ++x)
+    {
+        int area;
+        int sum = _windowSum(row, x, area);
+        row.out[x] = _sauvola(row.in[x], sum, _windowSquaredSum(row, x), 1.0 / static_cast<double>(area),
+                              parameters, row.mask);
+    }
+}
+
+#if defined(SONAR_SIMD_X86)
+
+/// Sums of windows of 4 pixels from x
+SONAR_TARGET_SSE2
+static inline __m128i _windowSum4_sse2(const ThresholdRow & row, int x)
+{
+    const int x0 = x - row.halfSize - 1, x1 = x + row.halfSize;
+    __m128i b = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&row.b[x1])),
+                              _mm_loadu_si128(reinterpret_cast<const __m128i*>(&row.b[x0])));
+    __m128i a = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&row.a[x1])),
+                              _mm_loadu_si128(reinterpret_cast<const __m128i*>(&row.a[x0])));
+    return _mm_sub_epi32(b, a);
+}
+
+/// Sums of squares of windows of 2 pixels from x
+SONAR_TARGET_SSE2
+static inline __m128i _windowSquaredSum2_sse2(const ThresholdRow & row, int x)
+{
+    const int x0 = x - row.halfSize - 1, x1 = x + row.halfSize;
+    __m128i b = _mm_sub_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&row.squaredB[x1])),
+                              _mm_loadu_si128(reinterpret_cast<const __m128i*>(&row.squaredB[x0])));
+    __m128i a = _mm_sub_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&row.squaredA[x1])),
+                              _mm_loadu_si128(reinterpret_cast<const __m128i*>(&row.squaredA[x0])));
+    return _mm_sub_epi64(b, a);
+}
+
+/// Exact conversion of integers from 0 to 2^52 to double: they are put into mantissa of 2^52
+SONAR_TARGET_SSE2
+static inline __m128d _int64ToDouble_sse2(__m128i v)
+{
+    const __m128i exponent = _mm_set1_epi64x(0x4330000000000000LL);
+    return _mm_sub_pd(_mm_castsi128_pd(_mm_or_si128(v, exponent)), _mm_set1_pd(4503599627370496.0));
+}
+
+SONAR_TARGET_SSE2
+static inline __m128i _sauvola2_sse2(__m128d value, __m128d sum, __m128d squaredSum, __m128d invArea,
+                                     __m128d k, __m128d invR)
+{
+    const __m128d one = _mm_set1_pd(1.0);
+    __m128d mean = _mm_mul_pd(sum, invArea);
+    __m128d variance = _mm_sub_pd(_mm_mul_pd(squaredSum, invArea), _mm_mul_pd(mean, mean));
+    __m128d deviation = _mm_sqrt_pd(_mm_max_pd(variance, _mm_setzero_pd()));
+    __m128d threshold = _mm_mul_pd(mean, _mm_add_pd(one, _mm_mul_pd(k, _mm_sub_pd(_mm_mul_pd(deviation, invR), one))));
+    // Masks of 64 bits are reduced to 32 bits in the lower half
+    return _mm_shuffle_epi32(_mm_castpd_si128(_mm_cmpgt_pd(value, threshold)), _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+SONAR_TARGET_SSE2
+static void _thresholdMeanRow_sse2(const ThresholdRow & row, float delta, int beginX, int endX)
+{
+    const __m128 invArea = _mm_set1_ps(1.0f / static_cast<float>((row.halfSize * 2 + 1) * row.numberRows));
+    const __m128 vDelta = _mm_set1_ps(delta);
+    const __m128i mask = _mm_set1_epi8(static_cast<char>(row.mask));
+    const __m128i zero = _mm_setzero_si128();
+    int x = beginX;
+    for (; x + 8 <= endX; x += 8)
+    {
+        __m128i values = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&row.in[x])), zero);
+        __m128 threshold0 = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_windowSum4_sse2(row, x)), invArea), vDelta);
+        __m128 threshold1 = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_windowSum4_sse2(row, x + 4)), invArea), vDelta);
+        __m128 r0 = _mm_cmpgt_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(values, zero)), threshold0);
+        __m128 r1 = _mm_cmpgt_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(values, zero)), threshold1);
+        __m128i r = _mm_packs_epi32(_mm_castps_si128(r0), _mm_castps_si128(r1));
+        r = _mm_xor_si128(_mm_packs_epi16(r, r), mask);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&row.out[x]), r);
+    }
+    _thresholdMeanRow_scalar(row, delta, x, endX);
+}
+
+SONAR_TARGET_SSE2
+static void _thresholdSauvolaRow_sse2(const ThresholdRow & row, const SauvolaParameters & parameters,
+                                      int beginX, int endX)
+{
+    const __m128d invArea = _mm_set1_pd(1.0 / static_cast<double>((row.halfSize * 2 + 1) * row.numberRows));
+    const __m128d k = _mm_set1_pd(parameters.k);
+    const __m128d invR = _mm_set1_pd(parameters.invR);
+    const __m128i mask = _mm_set1_epi8(static_cast<char>(row.mask));
+    const __m128i zero = _mm_setzero_si128();
+    int x = beginX;
+    for (; x + 4 <= endX; x += 4)
+    {
+        int packedValues;
+        std::memcpy(&packedValues, &row.in[x], 4);
+        __m128i values = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packedValues), zero), zero);
+        __m128i sum = _windowSum4_sse2(row, x);
+        __m128i r0 = _sauvola2_sse2(_mm_cvtepi32_pd(values), _mm_cvtepi32_pd(sum),
+                                    _int64ToDouble_sse2(_windowSquaredSum2_sse2(row, x)), invArea, k, invR);
+        __m128i r1 = _sauvola2_sse2(_mm_cvtepi32_pd(_mm_srli_si128(values, 8)), _mm_cvtepi32_pd(_mm_srli_si128(sum, 8)),
+                                    _int64ToDouble_sse2(_windowSquaredSum2_sse2(row, x + 2)), invArea, k, invR);
+        __m128i r = _mm_unpacklo_epi64(r0, r1);
+        r = _mm_packs_epi32(r, r);
+        r = _mm_xor_si128(_mm_packs_epi16(r, r), mask);
+        int packedResult = _mm_cvtsi128_si32(r);
+        std::memcpy(&row.out[x], &packedResult, 4);
+    }
+    _thresholdSauvolaRow_scalar(row, parameters, x, endX);
+}
+
+/// Sums of windows of 8 pixels from x
+SONAR_TARGET_AVX2
+static inline __m256i _windowSum8_avx2(const ThresholdRow & row, int x)
+{
+    const int x0 = x - row.halfSize - 1, x1 = x + row.halfSize;
+    __m256i b = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&row.b[x1])),
+                                 _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&row.b[x0])));
+    __m256i a = _mm256_sub_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&row.a[x1])),
+                                 _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&row.a[x0])));
+    return _mm256_sub_epi32(b, a);
+}
+
+/// 8 masks of 32 bits to 8 bytes
+SONAR_TARGET_AVX2
+static inline __m128i _packMask8_avx2(__m256i m)
+{
+    __m128i r = _mm_packs_epi32(_mm256_castsi256_si128(m), _mm256_extracti128_si256(m, 1));
+    return _mm_packs_epi16(r, r);
+}
+
+SONAR_TARGET_AVX2
+static void _thresholdMeanRow_avx2(const ThresholdRow & row, float delta, int beginX, int endX)
+{
+    const __m256 invArea = _mm256_set1_ps(1.0f / static_cast<float>((row.halfSize * 2 + 1) * row.numberRows));
+    const __m256 vDelta = _mm256_set1_ps(delta);
+    const __m128i mask = _mm_set1_epi8(static_cast<char>(row.mask));
+    int x = beginX;
+    for (; x + 8 <= endX; x += 8)
+    {
+        __m256 values = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(
+                                               _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&row.in[x]))));
+        __m256 threshold = _mm256_sub_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_windowSum8_avx2(row, x)), invArea), vDelta);
+        __m128i r = _packMask8_avx2(_mm256_castps_si256(_mm256_cmp_ps(values, threshold, _CMP_GT_OQ)));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&row.out[x]), _mm_xor_si128(r, mask));
+    }
+    _thresholdMeanRow_scalar(row, delta, x, endX);
+}
+
+SONAR_TARGET_AVX2
+static inline __m256d _int64ToDouble_avx2(__m256i v)
+{
+    const __m256i exponent = _mm256_set1_epi64x(0x4330000000000000LL);
+    return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(v, exponent)), _mm256_set1_pd(4503599627370496.0));
+}
+
+SONAR_TARGET_AVX2
+static void _thresholdSauvolaRow_avx2(const ThresholdRow & row, const SauvolaParameters & parameters,
+                                      int beginX, int endX)
+{
+    const __m256d invArea = _mm256_set1_pd(1.0 / static_cast<double>((row.halfSize * 2 + 1) * row.numberRows));
+    const __m256d k = _mm256_set1_pd(parameters.k);
+    const __m256d invR = _mm256_set1_pd(parameters.invR);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256i lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    const __m128i mask = _mm_set1_epi8(static_cast<char>(row.mask));
+    int x = beginX;
+    for (; x + 4 <= endX; x += 4)
+    {
+        const int x0 = x - row.halfSize - 1, x1 = x + row.halfSize;
+        int packedValues;
+        std::memcpy(&packedValues, &row.in[x], 4);
+        __m256d values = _mm256_cvtepi32_pd(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(packedValues)));
+        __m256d sum = _mm256_cvtepi32_pd(_windowSum4_sse2(row, x));
+        __m256i squaredB = _mm256_sub_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&row.squaredB[x1])),
+                                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&row.squaredB[x0])));
+        __m256i squaredA = _mm256_sub_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&row.squaredA[x1])),
+                                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&row.squaredA[x0])));
+        __m256d squaredSum = _int64ToDouble_avx2(_mm256_sub_epi64(squaredB, squaredA));
+        __m256d mean = _mm256_mul_pd(sum, invArea);
+        __m256d variance = _mm256_sub_pd(_mm256_mul_pd(squaredSum, invArea), _mm256_mul_pd(mean, mean));
+        __m256d deviation = _mm256_sqrt_pd(_mm256_max_pd(variance, _mm256_setzero_pd()));
+        __m256d threshold = _mm256_mul_pd(mean, _mm256_add_pd(one, _mm256_mul_pd(
+                                              k, _mm256_sub_pd(_mm256_mul_pd(deviation, invR), one))));
+        __m256i m = _mm256_permutevar8x32_epi32(_mm256_castpd_si256(_mm256_cmp_pd(values, threshold, _CMP_GT_OQ)),
+                                                lowHalves);
+        __m128i r = _mm_packs_epi32(_mm256_castsi256_si128(m), _mm256_castsi256_si128(m));
+        r = _mm_xor_si128(_mm_packs_epi16(r, r), mask);
+        int packedResult = _mm_cvtsi128_si32(r);
+        std::memcpy(&row.out[x], &packedResult, 4);
+    }
+    _thresholdSauvolaRow_scalar(row, parameters, x, endX);
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+static inline int32x4_t _windowSum4_neon(const ThresholdRow & row, int x)
+{
+    const int x0 = x - row.halfSize - 1, x1 = x + row.halfSize;
+    int32x4_t b = vsubq_s32(vld1q_s32(&row.b[x1]), vld1q_s32(&row.b[x0]));
+    int32x4_t a = vsubq_s32(vld1q_s32(&row.a[x1]), vld1q_s32(&row.a[x0]));
+    return vsubq_s32(b, a);
+}
+
+static void _thresholdMeanRow_neon(const ThresholdRow & row, float delta, int beginX, int endX)
+{
+    const float invArea = 1.0f / static_cast<float>((row.halfSize * 2 + 1) * row.numberRows);
+    const float32x4_t vDelta = vdupq_n_f32(delta);
+    const uint8x8_t mask = vdup_n_u8(row.mask);
+    int x = beginX;
+    for (; x + 8 <= endX; x += 8)
+    {
+        uint16x8_t values = vmovl_u8(vld1_u8(&row.in[x]));
+        float32x4_t threshold0 = vsubq_f32(vmulq_n_f32(vcvtq_f32_s32(_windowSum4_neon(row, x)), invArea), vDelta);
+        float32x4_t threshold1 = vsubq_f32(vmulq_n_f32(vcvtq_f32_s32(_windowSum4_neon(row, x + 4)), invArea), vDelta);
+        uint32x4_t r0 = vcgtq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(values))), threshold0);
+        uint32x4_t r1 = vcgtq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(values))), threshold1);
+        uint8x8_t r = vmovn_u16(vcombine_u16(vmovn_u32(r0), vmovn_u32(r1)));
+        vst1_u8(&row.out[x], veor_u8(r, mask));
+    }
+    _thresholdMeanRow_scalar(row, delta, x, endX);
+}
+
+#if defined(__aarch64__)
+
+static inline uint32x2_t _sauvola2_neon(float64x2_t value, float64x2_t sum, float64x2_t squaredSum,
+                                        float64x2_t invArea, float64x2_t k, float64x2_t invR)
+{
+    const float64x2_t one = vdupq_n_f64(1.0);
+    float64x2_t mean = vmulq_f64(sum, invArea);
+    float64x2_t variance = vsubq_f64(vmulq_f64(squaredSum, invArea), vmulq_f64(mean, mean));
+    float64x2_t deviation = vsqrtq_f64(vmaxq_f64(variance, vdupq_n_f64(0.0)));
+    float64x2_t threshold = vmulq_f64(mean, vaddq_f64(one, vmulq_f64(k, vsubq_f64(vmulq_f64(deviation, invR), one))));
+    return vmovn_u64(vcgtq_f64(value, threshold));
+}
+
+static void _thresholdSauvolaRow_neon(const ThresholdRow & row, const SauvolaParameters & parameters,
+                                      int beginX, int endX)
+{
+    const float64x2_t invArea = vdupq_n_f64(1.0 / static_cast<double>((row.halfSize * 2 + 1) * row.numberRows));
+    const float64x2_t k = vdupq_n_f64(parameters.k);
+    const float64x2_t invR = vdupq_n_f64(parameters.invR);
+    int x = beginX;
+    for (; x + 4 <= endX; x += 4)
+    {
+        const int x0 = x - row.halfSize - 1, x1 = x + row.halfSize;
+        uint8_t packedValues[8] = { row.in[x], row.in[x + 1], row.in[x + 2], row.in[x + 3], 0, 0, 0, 0 };
+        uint32x4_t values = vmovl_u16(vget_low_u16(vmovl_u8(vld1_u8(packedValues))));
+        int32x4_t sum = _windowSum4_neon(row, x);
+        int64x2_t squaredSums[2];
+        for (int i = 0; i < 2; ++i)
+        {
+            int64x2_t b = vsubq_s64(vld1q_s64(&row.squaredB[x1 + i * 2]), vld1q_s64(&row.squaredB[x0 + i * 2]));
+            int64x2_t a = vsubq_s64(vld1q_s64(&row.squaredA[x1 + i * 2]), vld1q_s64(&row.squaredA[x0 + i * 2]));
+            squaredSums[i] = vsubq_s64(b, a);
+        }
+        uint32x2_t r0 = _sauvola2_neon(vcvtq_f64_u64(vmovl_u32(vget_low_u32(values))),
+                                       vcvtq_f64_s64(vmovl_s32(vget_low_s32(sum))),
+                                       vcvtq_f64_s64(squaredSums[0]), invArea, k, invR);
+        uint32x2_t r1 = _sauvola2_neon(vcvtq_f64_u64(vmovl_u32(vget_high_u32(values))),
+                                       vcvtq_f64_s64(vmovl_s32(vget_high_s32(sum))),
+                                       vcvtq_f64_s64(squaredSums[1]), invArea, k, invR);
+        uint16x4_t r = vmovn_u32(vcombine_u32(r0, r1));
+        uint8x8_t bytes = veor_u8(vmovn_u16(vcombine_u16(r, r)), vdup_n_u8(row.mask));
+        uint32_t packedResult = vget_lane_u32(vreinterpret_u32_u8(bytes), 0);
+        std::memcpy(&row.out[x], &packedResult, 4);
+    }
+    _thresholdSauvolaRow_scalar(row, parameters, x, endX);
+}
+
+#endif
+
+#endif
+
+static ThresholdMeanRowFunction _selectThresholdMeanRow()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _thresholdMeanRow_avx2;
+    if (features.sse2)
+        return _thresholdMeanRow_sse2;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _thresholdMeanRow_neon;
+#endif
+    (void)features;
+    return _thresholdMeanRow_scalar;
+}
+
+static ThresholdSauvolaRowFunction _selectThresholdSauvolaRow()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _thresholdSauvolaRow_avx2;
+    if (features.sse2)
+        return _thresholdSauvolaRow_sse2;
+#elif defined(SONAR_SIMD_NEON) && defined(__aarch64__)
+    if (features.neon)
+        return _thresholdSauvolaRow_neon;
+#endif
+    (void)features;
+    return _thresholdSauvolaRow_scalar;
+}
+
+/// Calls function for rows with windows, which are clamped by top and bottom of image
+template <typename RowFunction>
+static void _forEachThresholdRow(uchar * out, int outWidthStep, const uchar * in, int inWidthStep,
+                                 const int * integral, int integralWidthStep,
+                                 const std::int64_t * squaredIntegral, int squaredIntegralWidthStep,
+                                 int width, int height, int halfSize, bool inverse, int beginRow, int endRow,
+                                 const RowFunction & rowFunction)
+{
+    assert((width > 0) && (halfSize >= 0));
+    assert((beginRow >= 0) && (endRow <= height));
+    if (beginRow >= endRow)
+        return;
+    std::vector<int> zeros;
+    std::vector<std::int64_t> squaredZeros;
+    if ((beginRow - halfSize - 1) < 0)
+    {
+        zeros.assign(static_cast<std::size_t>(width), 0);
+        if (squaredIntegral != nullptr)
+            squaredZeros.assign(static_cast<std::size_t>(width), 0);
+    }
+    ThresholdRow row;
+    row.width = width;
+    row.halfSize = halfSize;
+    row.mask = inverse ? 255 : 0;
+    row.squaredA = row.squaredB = nullptr;
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        int y0 = y - halfSize - 1;
+        int y1 = std::min(y + halfSize, height - 1);
+        row.out = &out[y * outWidthStep];
+        row.in = &in[y * inWidthStep];
+        row.b = &integral[y1 * integralWidthStep];
+        row.a = (y0 >= 0) ? &integral[y0 * integralWidthStep] : zeros.data();
+        if (squaredIntegral != nullptr)
+        {
+            row.squaredB = &squaredIntegral[y1 * squaredIntegralWidthStep];
+            row.squaredA = (y0 >= 0) ? &squaredIntegral[y0 * squaredIntegralWidthStep] : squaredZeros.data();
+        }
+        row.numberRows = y1 - std::max(y0, -1);
+        rowFunction(row);
+    }
+}
+
+void thresholdMean_u(uchar * out, int outWidthStep, const uchar * in, int inWidthStep,
+                     const int * integral, int integralWidthStep, int width, int height,
+                     int halfSize, float delta, bool inverse, int beginRow, int endRow)
+{
+    static const KernelDispatch<ThresholdMeanRowFunction> function(_selectThresholdMeanRow);
+    const int beginInner = std::min(halfSize + 1, width);
+    const int endInner = std::max(width - halfSize, beginInner);
+    _forEachThresholdRow(out, outWidthStep, in, inWidthStep, integral, integralWidthStep, nullptr, 0,
+                         width, height, halfSize, inverse, beginRow, endRow,
+                         [&] (const ThresholdRow & row) {
+        _thresholdMeanRow_scalar(row, delta, 0, beginInner);
+        function(row, delta, beginInner, endInner);
+        _thresholdMeanRow_scalar(row, delta, endInner, width);
+    });
+}
+
+void thresholdSauvola_u(uchar * out, int outWidthStep, const uchar * in, int inWidthStep,
+                        const int * integral, int integralWidthStep,
+                        const std::int64_t * squaredIntegral, int squaredIntegralWidthStep,
+                        int width, int height, int halfSize, float k, float r, bool inverse,
+                        int beginRow, int endRow)
+{
+    static const KernelDispatch<ThresholdSauvolaRowFunction> function(_selectThresholdSauvolaRow);
+    assert(squaredIntegral != nullptr);
+    assert(r > 0.0f);
+    const int beginInner = std::min(halfSize + 1, width);
+    const int endInner = std::max(width - halfSize, beginInner);
+    SauvolaParameters parameters;
+    parameters.k = static_cast<double>(k);
+    parameters.invR = 1.0 / static_cast<double>(r);
+    _forEachThresholdRow(out, outWidthStep, in, inWidthStep, integral, integralWidthStep,
+                         squaredIntegral, squaredIntegralWidthStep,
+                         width, height, halfSize, inverse, beginRow, endRow,
+                         [&] (const ThresholdRow & row) {
+        _thresholdSauvolaRow_scalar(row, parameters, 0, beginInner);
+        function(row, parameters, beginInner, endInner);
+        _thresholdSauvolaRow_scalar(row, parameters, endInner, width);
+    });
+}
+
+} // namespace simd
+
+} // namespace sonar
@@ -0,0 +1,40 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_THRESHOLD_H
+#define SONAR_SIMD_THRESHOLD_H
+
+#include <cstdint>
+
+namespace sonar {
+
+namespace simd {
+
+// Adaptive binarization of 8 bits image by statistics of window (2 * halfSize + 1) x (2 * halfSize + 1)
+// around pixel. Window is clamped by borders of image. Sums of window are taken from integral images
+// (see integralBand_u, out(x, y) is sum of pixels in(i, j) for i <= x and j <= y), so cost doesn't depend
+// on size of window. Pixels above threshold become 255 and others 0, inverse swaps 0 and 255.
+// Only rows from beginRow to endRow are computed, so image can be split between threads.
+// Implementation (SSE2, AVX2, NEON or scalar) is selected on first call by features of processor.
+
+/// Threshold by local mean: in(x, y) > mean - delta
+void thresholdMean_u(unsigned char * out, int outWidthStep, const unsigned char * in, int inWidthStep,
+                     const int * integral, int integralWidthStep, int width, int height,
+                     int halfSize, float delta, bool inverse, int beginRow, int endRow);
+
+/// Threshold of Sauvola: in(x, y) > mean * (1 + k * (deviation / r - 1)), where deviation is standard
+/// deviation of window and r is dynamic range of deviation. It is computed in double precision.
+void thresholdSauvola_u(unsigned char * out, int outWidthStep, const unsigned char * in, int inWidthStep,
+                        const int * integral, int integralWidthStep,
+                        const std::int64_t * squaredIntegral, int squaredIntegralWidthStep,
+                        int width, int height, int halfSize, float k, float r, bool inverse,
+                        int beginRow, int endRow);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_THRESHOLD_H
@@ -0,0 +1,368 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#include "Warp.h"
+#include "CpuFeatures.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#if defined(SONAR_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#elif defined(SONAR_SIMD_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace sonar {
+
+namespace simd {
+
+using uchar = unsigned char;
+
+// Row of out image is described by coefficients of linear functions of x:
+// sx = a[0] * x + b[0], sy = a[1] * x + b[1], w = a[2] * x + b[2] (w is used only by perspective warp).
+// All implementations compute with the same order of operations in floats (without fma),
+// so results are equal to results of scalar code.
+
+struct WarpRow
+{
+    float a[3];
+    float b[3];
+    int inWidthStep;
+    int inWidth;
+    int inHeight;
+    uchar borderValue;
+};
+
+using WarpRowFunction = void (*)(uchar * out, int width, const uchar * in, const WarpRow & row);
+
+static inline uchar _bilinear(const uchar * in, int inWidthStep, float x, float y)
+{
+    int ix = static_cast<int>(x), iy = static_cast<int>(y);
+    float dx = x - static_cast<float>(ix), dy = y - static_cast<float>(iy);
+    float idx = 1.0f - dx, idy = 1.0f - dy;
+    const uchar * top = &in[iy * inWidthStep + ix];
+    const uchar * bottom = &top[inWidthStep];
+    float value = static_cast<float>(top[0]) * (idx * idy) + static_cast<float>(top[1]) * (dx * idy) +
+                  static_cast<float>(bottom[0]) * (idx * dy) + static_cast<float>(bottom[1]) * (dx * dy);
+    return static_cast<uchar>(static_cast<int>(value + 0.5f));
+}
+
+static inline bool _inside(float x, float y, const WarpRow & row)
+{
+    return (x >= 0.0f) && (y >= 0.0f) &&
+           (x < static_cast<float>(row.inWidth - 1)) && (y < static_cast<float>(row.inHeight - 1));
+}
+
+template <bool Perspective>
+static void _warpRow_scalar(uchar * out, int beginX, int endX, const uchar * in, const WarpRow & row)
+{
+    for (int x = beginX; x < endX; ++x)
+    {
+        float fx = static_cast<float>(x);
+        float sx = row.a[0] * fx + row.b[0];
+        float sy = row.a[1] * fx + row.b[1];
+        if (Perspective)
+        {
+            float w = row.a[2] * fx + row.b[2];
+            if (!(w > 0.0f))
+            {
+                out[x] = row.borderValue;
+                continue;
+            }
+            sx = sx / w;
+            sy = sy / w;
+        }
+        out[x] = _inside(sx, sy, row) ? _bilinear(in, row.inWidthStep, sx, sy) : row.borderValue;
+    }
+}
+
+template <bool Perspective>
+static void _warpRow_scalar(uchar * out, int width, const uchar * in, const WarpRow & row)
+{
+    _warpRow_scalar<Perspective>(out, 0, width, in, row);
+}
+
+#if defined(SONAR_SIMD_X86)
+
+template <bool Perspective>
+SONAR_TARGET_SSE2
+static void _warpRow_sse2(uchar * out, int width, const uchar * in, const WarpRow & row)
+{
+    const __m128 one = _mm_set1_ps(1.0f), half = _mm_set1_ps(0.5f), zero = _mm_setzero_ps();
+    const __m128 maxX = _mm_set1_ps(static_cast<float>(row.inWidth - 1));
+    const __m128 maxY = _mm_set1_ps(static_cast<float>(row.inHeight - 1));
+    const __m128i mask8 = _mm_set1_epi32(0xFF);
+    const __m128i border = _mm_set1_epi32(row.borderValue);
+    alignas(16) int ixs[4], iys[4];
+    int x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128 fx = _mm_cvtepi32_ps(_mm_setr_epi32(x, x + 1, x + 2, x + 3));
+        __m128 sx = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row.a[0]), fx), _mm_set1_ps(row.b[0]));
+        __m128 sy = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row.a[1]), fx), _mm_set1_ps(row.b[1]));
+        __m128 inside;
+        if (Perspective)
+        {
+            __m128 w = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row.a[2]), fx), _mm_set1_ps(row.b[2]));
+            inside = _mm_cmpgt_ps(w, zero);
+            sx = _mm_div_ps(sx, w);
+            sy = _mm_div_ps(sy, w);
+            inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmpge_ps(sx, zero), _mm_cmpge_ps(sy, zero)));
+        }
+        else
+        {
+            inside = _mm_and_ps(_mm_cmpge_ps(sx, zero), _mm_cmpge_ps(sy, zero));
+        }
+        inside = _mm_and_ps(inside, _mm_and_ps(_mm_cmplt_ps(sx, maxX), _mm_cmplt_ps(sy, maxY)));
+        int insideMask = _mm_movemask_ps(inside);
+        if (insideMask == 0)
+        {
+            std::memset(&out[x], row.borderValue, 4);
+            continue;
+        }
+        // Coordinates of outside pixels are replaced by zero to read inside image
+        sx = _mm_and_ps(sx, inside);
+        sy = _mm_and_ps(sy, inside);
+        __m128i ix = _mm_cvttps_epi32(sx), iy = _mm_cvttps_epi32(sy);
+        __m128 dx = _mm_sub_ps(sx, _mm_cvtepi32_ps(ix)), dy = _mm_sub_ps(sy, _mm_cvtepi32_ps(iy));
+        __m128 idx = _mm_sub_ps(one, dx), idy = _mm_sub_ps(one, dy);
+        _mm_store_si128(reinterpret_cast<__m128i*>(ixs), ix);
+        _mm_store_si128(reinterpret_cast<__m128i*>(iys), iy);
+        std::uint16_t top[4], bottom[4];
+        for (int k = 0; k < 4; ++k)
+        {
+            const uchar * str = &in[iys[k] * row.inWidthStep + ixs[k]];
+            std::memcpy(&top[k], str, 2);
+            std::memcpy(&bottom[k], &str[row.inWidthStep], 2);
+        }
+        __m128i t = _mm_set_epi32(top[3], top[2], top[1], top[0]);
+        __m128i b = _mm_set_epi32(bottom[3], bottom[2], bottom[1], bottom[0]);
+        __m128 value = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                            _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(t, mask8)), _mm_mul_ps(idx, idy)),
+                            _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(t, 8)), _mm_mul_ps(dx, idy))),
+                            _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(b, mask8)), _mm_mul_ps(idx, dy))),
+                            _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(b, 8)), _mm_mul_ps(dx, dy)));
+        __m128i v = _mm_cvttps_epi32(_mm_add_ps(value, half));
+        __m128i insideI = _mm_castps_si128(inside);
+        v = _mm_or_si128(_mm_and_si128(insideI, v), _mm_andnot_si128(insideI, border));
+        v = _mm_packs_epi32(v, v);
+        int packed = _mm_cvtsi128_si32(_mm_packus_epi16(v, v));
+        std::memcpy(&out[x], &packed, 4);
+    }
+    _warpRow_scalar<Perspective>(out, x, width, in, row);
+}
+
+template <bool Perspective>
+SONAR_TARGET_AVX2
+static void _warpRow_avx2(uchar * out, int width, const uchar * in, const WarpRow & row)
+{
+    const __m256 one = _mm256_set1_ps(1.0f), half = _mm256_set1_ps(0.5f), zero = _mm256_setzero_ps();
+    const __m256 maxX = _mm256_set1_ps(static_cast<float>(row.inWidth - 1));
+    const __m256 maxY = _mm256_set1_ps(static_cast<float>(row.inHeight - 1));
+    const __m256i mask8 = _mm256_set1_epi32(0xFF);
+    const __m256i border = _mm256_set1_epi32(row.borderValue);
+    const __m256i step = _mm256_set1_epi32(row.inWidthStep);
+    // Gathers read 4 bytes from every offset, so the last of them must be inside image
+    const __m256i endOffset = _mm256_set1_epi32((row.inHeight - 1) * row.inWidthStep + row.inWidth - 4);
+    const __m256i offsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m256 fx = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(x), offsets));
+        __m256 sx = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(row.a[0]), fx), _mm256_set1_ps(row.b[0]));
+        __m256 sy = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(row.a[1]), fx), _mm256_set1_ps(row.b[1]));
+        __m256 inside;
+        if (Perspective)
+        {
+            __m256 w = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(row.a[2]), fx), _mm256_set1_ps(row.b[2]));
+            inside = _mm256_cmp_ps(w, zero, _CMP_GT_OQ);
+            sx = _mm256_div_ps(sx, w);
+            sy = _mm256_div_ps(sy, w);
+            inside = _mm256_and_ps(inside, _mm256_and_ps(_mm256_cmp_ps(sx, zero, _CMP_GE_OQ),
+                                                         _mm256_cmp_ps(sy, zero, _CMP_GE_OQ)));
+        }
+        else
+        {
+            inside = _mm256_and_ps(_mm256_cmp_ps(sx, zero, _CMP_GE_OQ), _mm256_cmp_ps(sy, zero, _CMP_GE_OQ));
+        }
+        inside = _mm256_and_ps(inside, _mm256_and_ps(_mm256_cmp_ps(sx, maxX, _CMP_LT_OQ),
+                                                     _mm256_cmp_ps(sy, maxY, _CMP_LT_OQ)));
+        int insideMask = _mm256_movemask_ps(inside);
+        if (insideMask == 0)
+        {
+            std::memset(&out[x], row.borderValue, 8);
+            continue;
+        }
+        sx = _mm256_and_ps(sx, inside);
+        sy = _mm256_and_ps(sy, inside);
+        __m256i ix = _mm256_cvttps_epi32(sx), iy = _mm256_cvttps_epi32(sy);
+        __m256i topOffset = _mm256_add_epi32(_mm256_mullo_epi32(iy, step), ix);
+        __m256i bottomOffset = _mm256_add_epi32(topOffset, step);
+        if (_mm256_movemask_epi8(_mm256_cmpgt_epi32(bottomOffset, endOffset)) != 0)
+        {
+            _warpRow_scalar<Perspective>(out, x, x + 8, in, row);
+            continue;
+        }
+        __m256 dx = _mm256_sub_ps(sx, _mm256_cvtepi32_ps(ix)), dy = _mm256_sub_ps(sy, _mm256_cvtepi32_ps(iy));
+        __m256 idx = _mm256_sub_ps(one, dx), idy = _mm256_sub_ps(one, dy);
+        __m256i t = _mm256_i32gather_epi32(reinterpret_cast<const int*>(in), topOffset, 1);
+        __m256i b = _mm256_i32gather_epi32(reinterpret_cast<const int*>(in), bottomOffset, 1);
+        __m256 value = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(t, mask8)), _mm256_mul_ps(idx, idy)),
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(t, 8), mask8)), _mm256_mul_ps(dx, idy))),
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(b, mask8)), _mm256_mul_ps(idx, dy))),
+            _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(b, 8), mask8)), _mm256_mul_ps(dx, dy)));
+        __m256i v = _mm256_cvttps_epi32(_mm256_add_ps(value, half));
+        v = _mm256_blendv_epi8(border, v, _mm256_castps_si256(inside));
+        __m128i v16 = _mm_packs_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&out[x]), _mm_packus_epi16(v16, v16));
+    }
+    _warpRow_scalar<Perspective>(out, x, width, in, row);
+}
+
+#elif defined(SONAR_SIMD_NEON)
+
+template <bool Perspective>
+static void _warpRow_neon(uchar * out, int width, const uchar * in, const WarpRow & row)
+{
+    const float32x4_t one = vdupq_n_f32(1.0f), half = vdupq_n_f32(0.5f), zero = vdupq_n_f32(0.0f);
+    const float32x4_t maxX = vdupq_n_f32(static_cast<float>(row.inWidth - 1));
+    const float32x4_t maxY = vdupq_n_f32(static_cast<float>(row.inHeight - 1));
+    const uint32x4_t border = vdupq_n_u32(row.borderValue);
+    const int32_t offsets[4] = { 0, 1, 2, 3 };
+    int32_t ixs[4], iys[4];
+    int x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        float32x4_t fx = vcvtq_f32_s32(vaddq_s32(vdupq_n_s32(x), vld1q_s32(offsets)));
+        float32x4_t sx = vaddq_f32(vmulq_n_f32(fx, row.a[0]), vdupq_n_f32(row.b[0]));
+        float32x4_t sy = vaddq_f32(vmulq_n_f32(fx, row.a[1]), vdupq_n_f32(row.b[1]));
+        uint32x4_t inside = vdupq_n_u32(0xFFFFFFFF);
+        if (Perspective)
+        {
+            float32x4_t w = vaddq_f32(vmulq_n_f32(fx, row.a[2]), vdupq_n_f32(row.b[2]));
+            inside = vcgtq_f32(w, zero);
+            // Division by reciprocal estimation differs from scalar division, so lanes are divided separately
+            float sxs[4], sys[4], ws[4];
+            vst1q_f32(sxs, sx);
+            vst1q_f32(sys, sy);
+            vst1q_f32(ws, w);
+            for (int k = 0; k < 4; ++k)
+            {
+                sxs[k] = sxs[k] / ws[k];
+                sys[k] = sys[k] / ws[k];
+            }
+            sx = vld1q_f32(sxs);
+            sy = vld1q_f32(sys);
+        }
+        inside = vandq_u32(inside, vandq_u32(vcgeq_f32(sx, zero), vcgeq_f32(sy, zero)));
+        inside = vandq_u32(inside, vandq_u32(vcltq_f32(sx, maxX), vcltq_f32(sy, maxY)));
+        sx = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(sx), inside));
+        sy = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(sy), inside));
+        int32x4_t ix = vcvtq_s32_f32(sx), iy = vcvtq_s32_f32(sy);
+        float32x4_t dx = vsubq_f32(sx, vcvtq_f32_s32(ix)), dy = vsubq_f32(sy, vcvtq_f32_s32(iy));
+        float32x4_t idx = vsubq_f32(one, dx), idy = vsubq_f32(one, dy);
+        vst1q_s32(ixs, ix);
+        vst1q_s32(iys, iy);
+        uint32_t tl[4], tr[4], bl[4], br[4];
+        for (int k = 0; k < 4; ++k)
+        {
+            const uchar * str = &in[iys[k] * row.inWidthStep + ixs[k]];
+            tl[k] = str[0];
+            tr[k] = str[1];
+            bl[k] = str[row.inWidthStep];
+            br[k] = str[row.inWidthStep + 1];
+        }
+        float32x4_t value = vaddq_f32(vaddq_f32(vaddq_f32(
+                                vmulq_f32(vcvtq_f32_u32(vld1q_u32(tl)), vmulq_f32(idx, idy)),
+                                vmulq_f32(vcvtq_f32_u32(vld1q_u32(tr)), vmulq_f32(dx, idy))),
+                                vmulq_f32(vcvtq_f32_u32(vld1q_u32(bl)), vmulq_f32(idx, dy))),
+                                vmulq_f32(vcvtq_f32_u32(vld1q_u32(br)), vmulq_f32(dx, dy)));
+        uint32x4_t v = vbslq_u32(inside, vcvtq_u32_f32(vaddq_f32(value, half)), border);
+        uint16x4_t v16 = vmovn_u32(v);
+        uint8x8_t v8 = vmovn_u16(vcombine_u16(v16, v16));
+        vst1_lane_u32(reinterpret_cast<uint32_t*>(&out[x]), vreinterpret_u32_u8(v8), 0);
+    }
+    _warpRow_scalar<Perspective>(out, x, width, in, row);
+}
+
+#endif
+
+template <bool Perspective>
+static WarpRowFunction _selectWarpRow()
+{
+    const CpuFeatures & features = cpuFeatures();
+#if defined(SONAR_SIMD_X86)
+    if (features.avx2)
+        return _warpRow_avx2<Perspective>;
+    if (features.sse2)
+        return _warpRow_sse2<Perspective>;
+#elif defined(SONAR_SIMD_NEON)
+    if (features.neon)
+        return _warpRow_neon<Perspective>;
+#endif
+    (void)features;
+    return _warpRow_scalar<Perspective>;
+}
+
+template <bool Perspective>
+static void _warp(WarpRowFunction function, uchar * out, int outWidthStep, int outWidth,
+                  const uchar * in, int inWidthStep, int inWidth, int inHeight,
+                  const float * matrix, uchar borderValue, int beginRow, int endRow)
+{
+    if ((inWidth < 2) || (inHeight < 2))
+    {
+        // No one point can be sampled
+        for (int y = beginRow; y < endRow; ++y)
+            std::fill(&out[y * outWidthStep], &out[y * outWidthStep + outWidth], borderValue);
+        return;
+    }
+    WarpRow row;
+    row.inWidthStep = inWidthStep;
+    row.inWidth = inWidth;
+    row.inHeight = inHeight;
+    row.borderValue = borderValue;
+    for (int i = 0; i < (Perspective ? 3 : 2); ++i)
+        row.a[i] = matrix[i * 3];
+    if (!Perspective)
+    {
+        row.a[2] = 0.0f;
+        row.b[2] = 1.0f;
+    }
+    for (int y = beginRow; y < endRow; ++y)
+    {
+        float fy = static_cast<float>(y);
+        for (int i = 0; i < (Perspective ? 3 : 2); ++i)
+            row.b[i] = matrix[i * 3 + 1] * fy + matrix[i * 3 + 2];
+        function(&out[y * outWidthStep], outWidth, in, row);
+    }
+}
+
+void warpAffine_u(uchar * out, int outWidthStep, int outWidth,
+                  const uchar * in, int inWidthStep, int inWidth, int inHeight,
+                  const float * matrix, uchar borderValue, int beginRow, int endRow)
+{
+    static const KernelDispatch<WarpRowFunction> function(_selectWarpRow<false>);
+    _warp<false>(function.get(), out, outWidthStep, outWidth, in, inWidthStep, inWidth, inHeight,
+                 matrix, borderValue, beginRow, endRow);
+}
+
+void warpPerspective_u(uchar * out, int outWidthStep, int outWidth,
+                       const uchar * in, int inWidthStep, int inWidth, int inHeight,
+                       const float * matrix, uchar borderValue, int beginRow, int endRow)
+{
+    static const KernelDispatch<WarpRowFunction> function(_selectWarpRow<true>);
+    _warp<true>(function.get(), out, outWidthStep, outWidth, in, inWidthStep, inWidth, inHeight,
+                matrix, borderValue, beginRow, endRow);
+}
+
+} // namespace simd
+
+} // namespace sonar
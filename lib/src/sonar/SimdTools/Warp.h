@@ -0,0 +1,34 @@
+/**
+* This file is part of sonar library
+* Copyright (C) 2019 Vlasov Aleksey ijonsilent53@gmail.com
+* For more information see <https://github.com/DistinctVision/sonar>
+**/
+
+#ifndef SONAR_SIMD_WARP_H
+#define SONAR_SIMD_WARP_H
+
+namespace sonar {
+
+namespace simd {
+
+/// Affine warp of 8 bits image with bilinear sampling, matrix is 2x3 by rows:
+/// out(x, y) = in(m[0] * x + m[1] * y + m[2], m[3] * x + m[4] * y + m[5]).
+/// Pixels, which are mapped outside of [0, inWidth - 1) x [0, inHeight - 1), are set to borderValue.
+/// Values are rounded. Only rows of out image from beginRow to endRow are computed.
+/// Implementation (SSE2, AVX2 with gathers, NEON or scalar) is selected on first call by features of processor.
+void warpAffine_u(unsigned char * out, int outWidthStep, int outWidth,
+                  const unsigned char * in, int inWidthStep, int inWidth, int inHeight,
+                  const float * matrix, unsigned char borderValue, int beginRow, int endRow);
+
+/// Perspective warp of 8 bits image with bilinear sampling, matrix is 3x3 by rows:
+/// out(x, y) = in((m[0] * x + m[1] * y + m[2]) / w, (m[3] * x + m[4] * y + m[5]) / w),
+/// w = m[6] * x + m[7] * y + m[8]. Pixels with w <= 0 are outside too.
+void warpPerspective_u(unsigned char * out, int outWidthStep, int outWidth,
+                       const unsigned char * in, int inWidthStep, int inWidth, int inHeight,
+                       const float * matrix, unsigned char borderValue, int beginRow, int endRow);
+
+} // namespace simd
+
+} // namespace sonar
+
+#endif // SONAR_SIMD_WARP_H
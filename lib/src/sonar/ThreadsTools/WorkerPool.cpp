@@ -5,6 +5,7 @@
 #include <string>
 
 #include "sonar/General/cast.h"
+#include "Semaphore.h"
 
 using namespace std;
 
@@ -76,6 +77,54 @@ void WorkerPool::waitTasksFinish() const
         m_notifer.wait(workerLocker);
 }
 
+void WorkerPool::parallelFor(int begin, int end, const function<void(int, int)> & task)
+{
+    int count = end - begin;
+    if (count <= 0)
+        return;
+    int numberParts = min(size() + 1, count);
+    if (numberParts <= 1)
+    {
+        task(begin, end);
+        return;
+    }
+
+    // Worker catches exceptions of tasks, so release of semaphore is in destructor
+    struct PartFinisher
+    {
+        Semaphore * semaphore;
+        ~PartFinisher() { semaphore->release(); }
+    };
+
+    // Parts of workers reference task and semaphore on this stack, so they are waited for in destructor,
+    // even if part of the calling thread throws
+    struct PartsWaiter
+    {
+        Semaphore * semaphore;
+        int numberStartedParts;
+        ~PartsWaiter() { semaphore->acquire(numberStartedParts); }
+    };
+
+    Semaphore semaphore(0);
+    PartsWaiter waiter { &semaphore, 0 };
+    int partSize = count / numberParts;
+    int remainder = count % numberParts;
+    int firstEnd = begin + partSize + ((remainder > 0) ? 1 : 0);
+    int partBegin = firstEnd;
+    for (int i = 1; i < numberParts; ++i)
+    {
+        int partEnd = partBegin + partSize + ((i < remainder) ? 1 : 0);
+        doTask([&task, &semaphore, partBegin, partEnd] () {
+            PartFinisher finisher { &semaphore }; (void)finisher;
+            task(partBegin, partEnd);
+        });
+        ++waiter.numberStartedParts;
+        partBegin = partEnd;
+    }
+    assert(partBegin == end);
+    task(begin, firstEnd);
+}
+
 void WorkerPool::_release()
 {
     cout << "start releasing worker pool[" << m_workers.size() << "]" << endl;
@@ -34,6 +34,11 @@ public:
 
     void waitTasksFinish() const;
 
+    /// Split range [begin, end) into parts and process them on the calling thread and on workers of pool.
+    /// Returns when all parts are processed. Don't call it from tasks of the same pool.
+    /// @param task - function with arguments (beginOfPart, endOfPart)
+    void parallelFor(int begin, int end, const std::function<void(int, int)> & task);
+
 private:
     friend class Worker;
 
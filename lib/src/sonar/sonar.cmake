@@ -4,6 +4,7 @@ include(${CMAKE_CURRENT_LIST_DIR}/General/General.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/ImageTools/ImageTools.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/CameraTools/CameraTools.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/ThreadsTools/ThreadsTools.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/SimdTools/SimdTools.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/DebugTools/DebugTools.cmake)
 
 set(SONAR_SOURCES_FILES
@@ -3,6 +3,7 @@ include (DebugTools/DebugTools.pri)
 include (ImageTools/ImageTools.pri)
 include (CameraTools/CameraTools.pri)
 include (ThreadsTools/ThreadsTools.pri)
+include (SimdTools/SimdTools.pri)
 
 HEADERS += \
     $$PWD/AbstractTrackingSystem.h \
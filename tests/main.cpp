@@ -2,6 +2,7 @@
 
 #include "test_marker_transform.h"
 #include "test_marker_pose_tracking.h"
+#include "test_tiled_patch_sampling.h"
 
 int main(int argc, char ** argv)
 {
@@ -11,6 +12,7 @@ int main(int argc, char ** argv)
     test_marker_transform(true);
     //test_marker_transform(false);
     //test_marker_pose_tracking();
+    //test_tiled_patch_sampling();
 
     return 0;
 }
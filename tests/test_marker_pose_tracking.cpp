@@ -100,7 +100,8 @@ bool test_marker_pose_tracking()
             break;
         }
         frame_bgr = image_utils::convertCvMat_rgb_u(cvFrameImage);
-        frame_bw = image_utils::convertToGrayscale(frame_bgr);
+        frame_bw = Image<uchar>(frame_bgr.size());
+        image_utils::convertToGrayscale(frame_bw, frame_bgr, simd::LumaStandard::Bt601, simd::ChannelOrder::Bgr);
 
         TrackingState trackingState = trackingSystem->process(frame_bw);
 
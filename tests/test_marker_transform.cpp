@@ -71,7 +71,8 @@ bool test_marker_transform(bool useAffineFlag)
             break;
         }
         frame_bgr = image_utils::convertCvMat_rgb_u(cvFrameImage);
-        frame_bw = image_utils::convertToGrayscale(frame_bgr);
+        frame_bw = Image<uchar>(frame_bgr.size());
+        image_utils::convertToGrayscale(frame_bw, frame_bgr, simd::LumaStandard::Bt601, simd::ChannelOrder::Bgr);
 
         vector<Point2f> markerCorners = markersFinder.findMarker(frame_bw);
         if (!markerCorners.empty())
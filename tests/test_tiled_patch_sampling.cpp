@@ -0,0 +1,183 @@
+#include "test_tiled_patch_sampling.h"
+
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <set>
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "sonar/General/Image.h"
+#include "sonar/General/TiledImage.h"
+#include "sonar/ImageTools/OpticalFlowCalculator.h"
+#include "sonar/ImageTools/OpticalFlow.h"
+
+using namespace std;
+using namespace sonar;
+
+namespace {
+
+const int cacheLineSize = 64;
+
+/// Number of cache lines, which are read for window of linear image
+int numberCacheLines(const ImageView<uchar> & image, const Point2i & begin, const Size2i & size)
+{
+    set<uintptr_t> lines;
+    for (int y = begin.y; y < (begin.y + size.y); ++y)
+    {
+        uintptr_t first = reinterpret_cast<uintptr_t>(image.pointer(begin.x, y)) / cacheLineSize;
+        uintptr_t last = reinterpret_cast<uintptr_t>(image.pointer(begin.x + size.x - 1, y)) / cacheLineSize;
+        for (uintptr_t line = first; line <= last; ++line)
+            lines.insert(line);
+    }
+    return static_cast<int>(lines.size());
+}
+
+/// Number of cache lines, which are read for window of tiled image
+int numberCacheLines(const TiledImage_u & image, const Point2i & begin, const Size2i & size)
+{
+    set<uintptr_t> lines;
+    for (int y = begin.y; y < (begin.y + size.y); ++y)
+        for (int x = begin.x; x < (begin.x + size.x); ++x)
+            lines.insert(reinterpret_cast<uintptr_t>(&image(x, y)) / cacheLineSize);
+    return static_cast<int>(lines.size());
+}
+
+/// Minimal time of runs of function, it's less sensitive to noise of other processes than mean time
+template <typename Function>
+double measure(int numberRepeats, Function && function)
+{
+    function();
+    double time = numeric_limits<double>::max();
+    for (int i = 0; i < numberRepeats; ++i)
+    {
+        auto begin = chrono::steady_clock::now();
+        function();
+        time = std::min(time, chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count());
+    }
+    return time;
+}
+
+/// Minimal time of function, caches are flushed before every run by writing of buffer bigger than last level cache
+template <typename Function>
+double measureCold(int numberRepeats, vector<uchar> & evictionBuffer, Function && function)
+{
+    double time = numeric_limits<double>::max();
+    for (int i = 0; i < numberRepeats; ++i)
+    {
+        for (size_t k = 0; k < evictionBuffer.size(); k += cacheLineSize)
+            ++evictionBuffer[k];
+        auto begin = chrono::steady_clock::now();
+        function();
+        time = std::min(time, chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count());
+    }
+    return time;
+}
+
+} // anonymous namespace
+
+bool test_tiled_patch_sampling()
+{
+    const Size2i frameSize(1920, 1080);
+    const Point2i cursorSize(20, 20);
+    const int numberPoints = 2000;
+
+    mt19937 generator(7);
+    Image<uchar> frame(frameSize);
+    uniform_int_distribution<int> noise(0, 31);
+    frame.for_each([&] (const Point2i & p, uchar & value) {
+        value = static_cast<uchar>(((p.x / 16 + p.y / 16) % 2) * 160 + noise(generator));
+    });
+    TiledImage_u tiledFrame(frame);
+
+    OpticalFlowCalculator calculator;
+    calculator.setCursorSize(cursorSize);
+    // Window of first patch, see OpticalFlowCalculator::tracking2d
+    const Size2i patchSize = cursorSize * 2 + Point2i(3, 3);
+    Image<uchar> linearPatch(patchSize), tiledPatch(patchSize);
+
+    uniform_real_distribution<float> positionX(32.0f, frameSize.x - 32.0f);
+    uniform_real_distribution<float> positionY(32.0f, frameSize.y - 32.0f);
+    vector<Point2f> points(numberPoints);
+    for (Point2f & point : points)
+        point.set(positionX(generator), positionY(generator));
+
+    bool success = true;
+    long long linearLines = 0, tiledLines = 0;
+    for (const Point2f & point : points)
+    {
+        Point2f begin = point - Point2f(cursorSize.x + 1.5f, cursorSize.y + 1.5f);
+        Point2i begin_i(cast<int>(floor(begin.x)), cast<int>(floor(begin.y)));
+        OpticalFlowCalculator::getSubPixelImage(linearPatch, frame, begin);
+        calculator.getSubPixelImage(tiledPatch, tiledFrame, begin);
+        for (int y = 0; y < patchSize.y; ++y)
+            for (int x = 0; x < patchSize.x; ++x)
+                success = success && (linearPatch(x, y) == tiledPatch(x, y));
+        linearLines += numberCacheLines(frame, begin_i, patchSize + Point2i(1, 1));
+        tiledLines += numberCacheLines(tiledFrame, begin_i, patchSize + Point2i(1, 1));
+    }
+
+    double linearTime = measure(20, [&] () {
+        for (const Point2f & point : points)
+            OpticalFlowCalculator::getSubPixelImage(linearPatch, frame,
+                                                    point - Point2f(cursorSize.x + 1.5f, cursorSize.y + 1.5f));
+    });
+    double tiledTime = measure(20, [&] () {
+        for (const Point2f & point : points)
+            calculator.getSubPixelImage(tiledPatch, tiledFrame,
+                                        point - Point2f(cursorSize.x + 1.5f, cursorSize.y + 1.5f));
+    });
+
+    // Last level caches of server processors are up to about hundred megabytes
+    vector<uchar> evictionBuffer(256 * 1024 * 1024);
+    double linearColdTime = measureCold(10, evictionBuffer, [&] () {
+        for (const Point2f & point : points)
+            OpticalFlowCalculator::getSubPixelImage(linearPatch, frame,
+                                                    point - Point2f(cursorSize.x + 1.5f, cursorSize.y + 1.5f));
+    });
+    double tiledColdTime = measureCold(10, evictionBuffer, [&] () {
+        for (const Point2f & point : points)
+            calculator.getSubPixelImage(tiledPatch, tiledFrame,
+                                        point - Point2f(cursorSize.x + 1.5f, cursorSize.y + 1.5f));
+    });
+
+    cout << "patch sampling of " << numberPoints << " points, frame " << frameSize.x << "x" << frameSize.y << endl;
+    cout << "  linear: " << linearTime << " us (cold caches " << linearColdTime << " us), cache lines per patch " <<
+            (linearLines / static_cast<double>(numberPoints)) << endl;
+    cout << "  tiled:  " << tiledTime << " us (cold caches " << tiledColdTime << " us), cache lines per patch " <<
+            (tiledLines / static_cast<double>(numberPoints)) << endl;
+
+    // The whole tracker with both layouts
+    Image<uchar> secondFrame(frameSize);
+    secondFrame.for_each([&] (const Point2i & p, uchar & value) {
+        value = frame(std::max(p.x - 2, 0), std::max(p.y - 1, 0));
+    });
+    OpticalFlow opticalFlow;
+    opticalFlow.setCursorSize(Point2i(8, 8));
+    vector<Point2f> secondPoints[2];
+    vector<TrackingResult> status[2];
+    double trackingTime[2];
+    for (int tiled = 0; tiled < 2; ++tiled)
+    {
+        opticalFlow.setTiledLayout(tiled != 0);
+        trackingTime[tiled] = measure(5, [&] () {
+            opticalFlow.setFirstImage(frame);
+            opticalFlow.setSecondImage(secondFrame);
+            secondPoints[tiled] = points;
+            opticalFlow.tracking2d(status[tiled], secondPoints[tiled], points);
+        });
+    }
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        success = success && (status[0][i] == status[1][i]);
+        success = success && (secondPoints[0][i] == secondPoints[1][i]);
+    }
+    cout << "  tracking: linear " << trackingTime[0] << " us, tiled " << trackingTime[1] << " us" << endl;
+
+    if (!success)
+        cerr << "results of linear and tiled layouts are different" << endl;
+    return success;
+}
@@ -0,0 +1,9 @@
+#ifndef TEST_TILED_PATCH_SAMPLING_H
+#define TEST_TILED_PATCH_SAMPLING_H
+
+/// Benchmark of sampling of optical flow patches from linear and tiled images of big frame.
+/// Prints time with warm and cold caches and number of touched cache lines per patch,
+/// returns false if results of layouts differ.
+bool test_tiled_patch_sampling();
+
+#endif // TEST_TILED_PATCH_SAMPLING_H
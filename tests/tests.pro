@@ -53,10 +53,12 @@ INCLUDEPATH += $$PWD/../lib/src
 SOURCES += \
     main.cpp \
     test_marker_pose_tracking.cpp \
-    test_marker_transform.cpp
+    test_marker_transform.cpp \
+    test_tiled_patch_sampling.cpp
 
 HEADERS += \
     test_marker_pose_tracking.h \
-    test_marker_transform.h
+    test_marker_transform.h \
+    test_tiled_patch_sampling.h
 
 DEFINES += _USE_MATH_DEFINES